@@ -0,0 +1,281 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+
+/**
+ * Host benchmark of the BVH frustum query, using the BVH of the Bunker scene ('filesystem/scene.t3dm').
+ * Views are placed randomly inside the model bounds with the camera settings of 'SceneBunker'.
+ * Compares the recursive query (as it was before the iterative version) against
+ * 't3d_model_bvh_query_frustum_list' and checks that both return the same objects.
+ *
+ * Usage: bench_bvh [path=filesystem/scene.t3dm] [views=4096] [seed=1]
+ */
+#include <libdragon.h>
+#include <t3d/t3dmath.h>
+#include <t3d/t3dmodel.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace
+{
+  // same as 'SceneBunker'
+  constexpr float MODEL_SCALE = 0.15f;
+  constexpr float CAM_FOV = T3D_DEG_TO_RAD(80.0f);
+  constexpr float CAM_NEAR = 5.0f;
+  constexpr float CAM_FAR = 295.0f;
+
+  constexpr uint32_t REPEATS = 32;
+  constexpr uint32_t MAX_OBJECTS = 512;
+
+  // model files are big-endian, and pointers are 32-bit on the N64
+  constexpr uint32_t OFFSET_CHUNK_COUNT = 4;
+  constexpr uint32_t OFFSET_AABB = 32;
+  constexpr uint32_t OFFSET_CHUNKS = 44;
+  constexpr uint32_t OFFSET_OBJ_AABB = 20;
+
+  uint16_t readU16(const uint8_t *p) { return (uint16_t)((p[0] << 8) | p[1]); }
+  uint32_t readU32(const uint8_t *p) { return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]; }
+
+  /**
+   * Host copy of a BVH with its objects, laid out like after 't3d_model_load':
+   * all objects come first, followed by the BVH which references them by a relative offset.
+   */
+  struct BvhScene {
+    std::vector<uint32_t> memory{};
+    T3DBvh *bvh{};
+    uint32_t objectCount{};
+    int16_t aabbMin[3]{};
+    int16_t aabbMax[3]{};
+  };
+
+  bool loadScene(const char *path, BvhScene &scene)
+  {
+    FILE *file = fopen(path, "rb");
+    if(!file)return false;
+    std::vector<uint8_t> data{};
+    uint8_t buff[4096];
+    size_t readSize;
+    while((readSize = fread(buff, 1, sizeof(buff), file)) > 0) {
+      data.insert(data.end(), buff, buff + readSize);
+    }
+    fclose(file);
+    if(data.size() < OFFSET_CHUNKS || memcmp(data.data(), "T3M", 3) != 0)return false;
+
+    uint32_t chunkCount = readU32(&data[OFFSET_CHUNK_COUNT]);
+    for(int i=0; i<3; ++i) {
+      scene.aabbMin[i] = (int16_t)readU16(&data[OFFSET_AABB + i*2]);
+      scene.aabbMax[i] = (int16_t)readU16(&data[OFFSET_AABB + 6 + i*2]);
+    }
+
+    std::vector<uint32_t> objChunks{};
+    uint32_t bvhOffset = 0;
+    uint32_t lastObjIdx = 0;
+    for(uint32_t c=0; c<chunkCount; ++c) {
+      uint32_t chunk = readU32(&data[OFFSET_CHUNKS + c*4]);
+      char type = (char)(chunk >> 24);
+      if(type == T3D_CHUNK_TYPE_OBJECT) {
+        objChunks.push_back(chunk & 0xFFFFFF);
+        lastObjIdx = c;
+      }
+      if(type == T3D_CHUNK_TYPE_BVH)bvhOffset = chunk & 0xFFFFFF;
+    }
+    // BVH data references objects by chunk index, objects are expected to be the first chunks
+    if(bvhOffset == 0 || lastObjIdx + 1 != objChunks.size())return false;
+
+    const uint8_t *bvhData = &data[bvhOffset];
+    uint16_t nodeCount = readU16(bvhData);
+    uint16_t dataCount = readU16(bvhData + 2);
+
+    uint32_t objSize = (sizeof(T3DObject) + 3) & ~3;
+    uint32_t bvhSize = sizeof(T3DBvh) + nodeCount * sizeof(T3DBvhNode) + dataCount * sizeof(T3DBvhData);
+    uint32_t objTotalSize = objSize * objChunks.size();
+    scene.memory.resize((objTotalSize + bvhSize + 3) / 4);
+    scene.objectCount = objChunks.size();
+
+    char *basePtr = (char*)scene.memory.data();
+    for(uint32_t i=0; i<objChunks.size(); ++i) {
+      auto obj = (T3DObject*)(basePtr + objSize * i);
+      for(int a=0; a<3; ++a) {
+        obj->aabbMin[a] = (int16_t)readU16(&data[objChunks[i] + OFFSET_OBJ_AABB + a*2]);
+        obj->aabbMax[a] = (int16_t)readU16(&data[objChunks[i] + OFFSET_OBJ_AABB + 6 + a*2]);
+      }
+    }
+
+    scene.bvh = (T3DBvh*)(basePtr + objTotalSize);
+    scene.bvh->nodeCount = nodeCount;
+    scene.bvh->dataCount = dataCount;
+    const uint8_t *nodePtr = bvhData + 4;
+    for(uint32_t n=0; n<nodeCount; ++n, nodePtr += 14) {
+      T3DBvhNode &node = scene.bvh->nodes[n];
+      for(int a=0; a<3; ++a) {
+        node.aabbMin[a] = (int16_t)readU16(nodePtr + a*2);
+        node.aabbMax[a] = (int16_t)readU16(nodePtr + 6 + a*2);
+      }
+      node.value = readU16(nodePtr + 12);
+    }
+
+    auto bvhObjData = (T3DBvhData*)&scene.bvh->nodes[nodeCount];
+    for(uint32_t d=0; d<dataCount; ++d, nodePtr += 2) {
+      uint32_t objIdx = readU16(nodePtr);
+      if(objIdx >= scene.objectCount)return false;
+      bvhObjData[d].objectPtr = (uint16_t)((objTotalSize - objIdx * objSize) >> 2);
+    }
+    return true;
+  }
+
+  // Recursive query with file-static context, as 't3d_model_bvh_query_frustum' used to be implemented
+  const T3DFrustum *ctxFrustum;
+  const T3DBvhData *ctxData;
+  const char *ctxBasePtr;
+
+  void refQueryNode(const T3DBvhNode *node) {
+    int dataCount = node->value & 0b1111;
+    int offset = (int16_t)node->value >> 4;
+
+    if(dataCount == 0) {
+      if(t3d_frustum_vs_aabb_s16(ctxFrustum, node->aabbMin, node->aabbMax)) {
+        refQueryNode(&node[offset]);
+        refQueryNode(&node[offset + 1]);
+      }
+      return;
+    }
+
+    int offsetEnd = offset + dataCount;
+    while(offset < offsetEnd) {
+      T3DObject* obj = (T3DObject*)(ctxBasePtr - (ctxData[offset++].objectPtr << 2));
+      if(t3d_frustum_vs_aabb_s16(ctxFrustum, obj->aabbMin, obj->aabbMax)) {
+        obj->isVisible = true;
+      }
+    }
+  }
+
+  void refQuery(const T3DBvh *bvh, const T3DFrustum *frustum) {
+    ctxFrustum = frustum;
+    ctxData = (T3DBvhData*)&bvh->nodes[bvh->nodeCount];
+    ctxBasePtr = (const char*)bvh;
+    refQueryNode(bvh->nodes);
+  }
+
+  uint32_t collectVisible(const BvhScene &scene, T3DObject **out) {
+    uint32_t objSize = (sizeof(T3DObject) + 3) & ~3;
+    uint32_t count = 0;
+    for(uint32_t i=0; i<scene.objectCount; ++i) {
+      auto obj = (T3DObject*)((char*)scene.memory.data() + objSize * i);
+      if(obj->isVisible)out[count++] = obj;
+      obj->isVisible = false;
+    }
+    return count;
+  }
+
+  uint32_t rngState = 1;
+  float randomFloat() {
+    rngState = rngState * 1664525u + 1013904223u;
+    return (float)(rngState >> 8) / (float)(1 << 24);
+  }
+
+  T3DFrustum createFrustum(const BvhScene &scene)
+  {
+    T3DVec3 pos;
+    for(int a=0; a<3; ++a) {
+      float min = scene.aabbMin[a] * MODEL_SCALE;
+      float max = scene.aabbMax[a] * MODEL_SCALE;
+      pos.v[a] = min + (max - min) * randomFloat();
+    }
+
+    float rotY = randomFloat() * T3D_PI * 2.0f;
+    float rotX = (randomFloat() - 0.5f) * T3D_PI * 0.5f;
+    T3DVec3 target{{
+      pos.x + cosf(rotY) * cosf(rotX),
+      pos.y + sinf(rotX),
+      pos.z + sinf(rotY) * cosf(rotX)
+    }};
+    T3DVec3 up{{0, 1, 0}};
+
+    T3DMat4 matProj, matCam, matCamProj;
+    t3d_mat4_perspective(&matProj, CAM_FOV, 320.0f / 240.0f, CAM_NEAR, CAM_FAR);
+    t3d_mat4_look_at(&matCam, &pos, &target, &up);
+    t3d_mat4_mul(&matCamProj, &matProj, &matCam);
+
+    T3DFrustum frustum;
+    t3d_mat4_to_frustum(&frustum, &matCamProj);
+    t3d_frustum_scale(&frustum, MODEL_SCALE);
+    return frustum;
+  }
+
+  template<typename F>
+  double measureNs(uint32_t queries, F &&fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / queries;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  const char *path = argc > 1 ? argv[1] : "filesystem/scene.t3dm";
+  uint32_t viewCount = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 10) : 4096;
+  rngState = argc > 3 ? (uint32_t)strtoul(argv[3], nullptr, 10) : 1;
+
+  BvhScene scene{};
+  if(!loadScene(path, scene)) {
+    printf("Failed to load BVH from '%s' (build it with 'make' first)\n", path);
+    return 1;
+  }
+  printf("BVH: %d nodes, %d objects | %u views, seed %u\n",
+    scene.bvh->nodeCount, scene.bvh->dataCount, viewCount, rngState);
+
+  std::vector<T3DFrustum> frustums{};
+  for(uint32_t v=0; v<viewCount; ++v)frustums.push_back(createFrustum(scene));
+
+  // check that both return the same set of objects
+  T3DObject *visRef[MAX_OBJECTS];
+  T3DObject *visList[MAX_OBJECTS];
+  uint64_t totalVisible = 0;
+  for(auto &frustum : frustums) {
+    refQuery(scene.bvh, &frustum);
+    uint32_t countRef = collectVisible(scene, visRef);
+    uint32_t count = t3d_model_bvh_query_frustum_list(scene.bvh, &frustum, visList, MAX_OBJECTS);
+
+    std::sort(visList, visList + count);
+    if(count != countRef || !std::equal(visRef, visRef + countRef, visList)) {
+      printf("Mismatch: %u objects vs. %u (reference)\n", count, countRef);
+      return 1;
+    }
+    totalVisible += count;
+  }
+
+  uint32_t queries = viewCount * REPEATS;
+  volatile uint32_t sink = 0;
+
+  double nsRef = measureNs(queries, [&]{
+    for(uint32_t r=0; r<REPEATS; ++r) {
+      for(auto &frustum : frustums)refQuery(scene.bvh, &frustum);
+    }
+  });
+  collectVisible(scene, visRef); // reset flags
+
+  double nsFlag = measureNs(queries, [&]{
+    for(uint32_t r=0; r<REPEATS; ++r) {
+      for(auto &frustum : frustums)t3d_model_bvh_query_frustum(scene.bvh, &frustum);
+    }
+  });
+  collectVisible(scene, visRef);
+
+  double nsList = measureNs(queries, [&]{
+    for(uint32_t r=0; r<REPEATS; ++r) {
+      for(auto &frustum : frustums) {
+        sink = sink + t3d_model_bvh_query_frustum_list(scene.bvh, &frustum, visList, MAX_OBJECTS);
+      }
+    }
+  });
+
+  printf("avg. visible: %.1f / %u\n\n", (double)totalVisible / viewCount, scene.objectCount);
+  printf("%-20s %12s\n", "query", "ns/query");
+  printf("%-20s %12.1f\n", "recursive", nsRef);
+  printf("%-20s %12.1f\n", "iterative (flags)", nsFlag);
+  printf("%-20s %12.1f\n", "iterative (list)", nsList);
+  return 0;
+}
@@ -0,0 +1,211 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+
+/**
+ * Headless benchmark of the Last64 simulation.
+ * Runs a fixed amount of game-time with 1-4 scripted bots and reports the CPU time per subsystem.
+ * Everything is seeded, so two runs with the same arguments simulate exactly the same game,
+ * the final checksum can be used to verify that an optimization did not change behavior.
+ *
+ * Usage: bench_sim [minutes=5] [bots=4] [seed=1]
+ */
+#include "host/platform_host.h"
+#include "../src/main.h"
+#include "../src/actors/player.h"
+#include "../src/actors/enemy.h"
+#include "../src/actors/projectile.h"
+#include "../src/systems/experience.h"
+#include "../src/systems/spawn_manager.h"
+#include "../src/systems/simulation.h"
+#include "../src/systems/random.h"
+#include "../src/memory/matrixManager.h"
+#include "../src/profiler.h"
+
+namespace
+{
+  constexpr float DELTA_TIME = 1.0f / 30.0f;
+  constexpr float FLEE_DISTANCE = 40.0f;
+
+  Actor::Player* players[Simulation::MAX_PLAYERS]{};
+
+  struct RunResult {
+    double frameNs;
+    uint32_t rounds;
+    int level;
+    uint32_t maxEnemies;
+    uint32_t maxProjectiles;
+    uint32_t checksum;
+  };
+
+  void startRound(int botCount)
+  {
+    Actor::Enemy::initialize();
+    Actor::Projectile::initialize();
+    SpawnManager::initialize();
+    Experience::initialize();
+
+    for(int i=0; i<botCount; ++i) {
+      players[i] = Simulation::getRoundArena().create<Actor::Player>(T3DVec3{{120.0f + i * 20.0f, 100.0f, 0.0f}}, (joypad_port_t)(JOYPAD_PORT_1 + i));
+      Experience::addPlayer(players[i]);
+    }
+  }
+
+  void endRound()
+  {
+    Simulation::getRoundArena().reset();
+    for(auto &p : players)p = nullptr;
+    Actor::Enemy::cleanup();
+    Actor::Projectile::cleanup();
+    Experience::shutdown();
+    SpawnManager::deinitialize();
+  }
+
+  /**
+   * Bots run away from the closest enemy, otherwise they circle around the center.
+   * Each bot fires manually every two seconds, offset by its port.
+   */
+  joypad_inputs_t getBotInput(int port, uint32_t frame)
+  {
+    joypad_inputs_t input{};
+    const Actor::Player *player = players[port];
+    if(!player || player->getIsDead())return input;
+
+    T3DVec3 pos = player->getPosition();
+    float closestDistSq = FLEE_DISTANCE * FLEE_DISTANCE;
+    T3DVec3 away{};
+    for(uint32_t n=0; n<Actor::Enemy::getActiveCount(); ++n) {
+      const T3DVec3 &enemyPos = Actor::Enemy::getPosition(Actor::Enemy::getLiveIndex(n));
+      float dx = pos.x - enemyPos.x;
+      float dy = pos.y - enemyPos.y;
+      float distSq = dx * dx + dy * dy;
+      if(distSq < closestDistSq) {
+        closestDistSq = distSq;
+        away = {{dx, dy, 0.0f}};
+      }
+    }
+
+    if(away.x == 0.0f && away.y == 0.0f) {
+      // tangent of a circle around the center, with a pull towards the radius
+      float radius = 40.0f + port * 15.0f;
+      float cx = pos.x - SCREEN_WIDTH / 2.0f;
+      float cy = pos.y - SCREEN_HEIGHT / 2.0f;
+      float dist = sqrtf(cx * cx + cy * cy) + 0.001f;
+      float pull = (radius - dist) / radius;
+      away = {{-cy / dist + cx / dist * pull, cx / dist + cy / dist * pull, 0.0f}};
+    }
+
+    float len = sqrtf(away.x * away.x + away.y * away.y);
+    input.stick_x = (int8_t)(away.x / len * 64.0f);
+    input.stick_y = (int8_t)(away.y / len * 64.0f);
+    input.btn.z = ((frame + port * 15) % 60) == 0;
+    return input;
+  }
+
+  uint32_t hashFloat(uint32_t hash, float value)
+  {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (hash ^ bits) * 16777619u;
+  }
+
+  uint32_t getChecksum()
+  {
+    uint32_t hash = 2166136261u;
+    for(uint32_t n=0; n<Actor::Enemy::getActiveCount(); ++n) {
+      const T3DVec3 &pos = Actor::Enemy::getPosition(Actor::Enemy::getLiveIndex(n));
+      hash = hashFloat(hashFloat(hash, pos.x), pos.y);
+    }
+    for(uint32_t n=0; n<Actor::Projectile::getActiveCount(); ++n) {
+      const T3DVec3 &pos = Actor::Projectile::getPosition(Actor::Projectile::getLiveIndex(n));
+      hash = hashFloat(hashFloat(hash, pos.x), pos.y);
+    }
+    for(auto p : players) {
+      if(!p)continue;
+      T3DVec3 pos = p->getPosition();
+      hash = hashFloat(hashFloat(hash, pos.x), pos.y);
+    }
+    return hash;
+  }
+
+  double ticksToNs(uint64_t ticks, uint32_t frames)
+  {
+    return (double)ticks * (1e9 / (double)TICKS_PER_SECOND) / (double)frames;
+  }
+
+  RunResult run(uint32_t frameCount, int botCount, uint32_t seed)
+  {
+    Random::seed(seed);
+    startRound(botCount);
+    Profiler::resetTotals();
+
+    float roundTimer = 0.0f;
+    RunResult res{};
+    res.rounds = 1;
+
+    for(uint32_t frame=0; frame<frameCount; ++frame)
+    {
+      Profiler::beginFrame();
+      for(int p=0; p<botCount; ++p) {
+        HostPlatform::setInputs((joypad_port_t)p, getBotInput(p, frame));
+      }
+
+      roundTimer += DELTA_TIME;
+      {
+        PROFILE_SCOPE("update");
+        Simulation::update(players, DELTA_TIME, roundTimer);
+      }
+
+      if(Actor::Enemy::getActiveCount() > res.maxEnemies)res.maxEnemies = Actor::Enemy::getActiveCount();
+      if(Actor::Projectile::getActiveCount() > res.maxProjectiles)res.maxProjectiles = Actor::Projectile::getActiveCount();
+
+      // same as the game: once everyone is dead, a new round starts
+      if(Experience::getAlivePlayerCount() == 0) {
+        endRound();
+        startRound(botCount);
+        roundTimer = 0.0f;
+        ++res.rounds;
+      }
+
+      Profiler::endFrame();
+      HostPlatform::endFrame();
+    }
+
+    uint32_t frames = Profiler::getTotalFrames();
+    uint32_t zoneCount = 0;
+    const Profiler::ZoneTotal* totals = Profiler::getTotals(zoneCount);
+
+    printf("\n%-20s %12s\n", "zone", "ns/frame");
+    for(uint32_t z=0; z<zoneCount; ++z) {
+      printf("%*s%-*s %12.0f\n", totals[z].depth * 2, "", 20 - totals[z].depth * 2, totals[z].name, ticksToNs(totals[z].ticks, frames));
+    }
+    res.frameNs = ticksToNs(Profiler::getTotalFrameTicks(), frames);
+    printf("%-20s %12.0f\n", "frame", res.frameNs);
+
+    res.level = Experience::getLevel();
+    res.checksum = getChecksum();
+    endRound();
+    return res;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  float minutes = argc > 1 ? (float)atof(argv[1]) : 5.0f;
+  int botCount = argc > 2 ? atoi(argv[2]) : 4;
+  uint32_t seed = argc > 3 ? (uint32_t)strtoul(argv[3], nullptr, 10) : 1;
+  if(botCount < 1)botCount = 1;
+  if(botCount > Simulation::MAX_PLAYERS)botCount = Simulation::MAX_PLAYERS;
+
+  uint32_t frameCount = (uint32_t)(minutes * 60.0f / DELTA_TIME);
+  printf("Simulating %.1f min (%u frames), %d bot(s), seed %u\n", minutes, frameCount, botCount, seed);
+
+  MatrixManager::reset(); // players allocate their matrices from here
+
+  RunResult res = run(frameCount, botCount, seed);
+  printf("\nrounds: %u, level: %d, max. enemies: %u, max. projectiles: %u\n",
+    res.rounds, res.level, res.maxEnemies, res.maxProjectiles);
+  printf("checksum: %08X\n", res.checksum);
+  return 0;
+}
@@ -0,0 +1,128 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#pragma once
+/**
+ * Host replacement for <libdragon.h>, used by the headless simulation build ('make bench_sim').
+ * It only covers what the gameplay code and the Tiny3D headers need to compile natively.
+ * Rendering and audio become no-ops, joypads are driven by the benchmark script (see 'platform_host.cpp').
+ * ROM files and PI DMAs are emulated with a configurable latency (see 'rom_host.cpp').
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ---- Math ---- //
+typedef union { float v[3]; struct { float x, y, z; }; } fm_vec3_t;
+typedef union { float v[4]; struct { float x, y, z, w; }; } fm_vec4_t;
+typedef union { float v[4]; struct { float x, y, z, w; }; } fm_quat_t;
+typedef struct { float m[4][4]; } fm_mat4_t;
+
+static inline float fm_sinf(float x) { return sinf(x); }
+static inline float fm_cosf(float x) { return cosf(x); }
+static inline float fm_atan2f(float y, float x) { return atan2f(y, x); }
+static inline float fm_floorf(float x) { return floorf(x); }
+
+// ---- System ---- //
+uint32_t host_ticks_read(void);
+
+#define TICKS_PER_SECOND 1000000000u
+#define TICKS_READ() host_ticks_read()
+#define TICKS_DISTANCE(from, to) ((int32_t)((uint32_t)(to) - (uint32_t)(from)))
+#define TICKS_TO_US(val) ((val) / 1000u)
+#define RCP_FREQUENCY 62500000
+
+#define debugf(...) ((void)0)
+#define assertf(expr, ...) assert(expr)
+
+#define UncachedAddr(addr) ((void*)(addr))
+#define CachedAddr(addr) ((void*)(addr))
+#define PhysicalAddr(addr) ((uint32_t)(uintptr_t)(addr))
+#define MEMORY_BARRIER() ((void)0)
+
+void* malloc_uncached(size_t size);
+void* malloc_uncached_aligned(int align, size_t size);
+void free_uncached(void *buf);
+static inline void data_cache_hit_writeback(const volatile void *addr, unsigned long length) {}
+static inline void data_cache_hit_writeback_invalidate(volatile void *addr, unsigned long length) {}
+
+// ---- ROM / DMA, see 'rom_host.cpp' ---- //
+FILE *asset_fopen(const char *fn, int *sz);
+uint32_t dfs_rom_addr(const char *path);
+int dfs_open(const char *path);
+int dfs_size(uint32_t handle);
+int dfs_close(uint32_t handle);
+void dma_read(void *ram_address, unsigned long pi_address, unsigned long len);
+void dma_read_async(void *ram_address, unsigned long pi_address, unsigned long len);
+int dma_busy(void);
+void dma_wait(void);
+
+// ---- Graphics ---- //
+#define rspq_write(...) ((void)0)
+
+// ucodes are run by 'rsp_host.h' instead, registering them does nothing
+typedef struct { const char *name; } rsp_ucode_t;
+#define DEFINE_RSP_UCODE(ucode) rsp_ucode_t ucode = {#ucode}
+static inline uint32_t rspq_overlay_register(rsp_ucode_t *ucode) { (void)ucode; return 0; }
+static inline void rspq_overlay_unregister(uint32_t id) { (void)id; }
+
+static inline int display_get_width(void) { return 320; }
+static inline int display_get_height(void) { return 240; }
+
+typedef struct { uint8_t r, g, b, a; } color_t;
+#define RGBA32(rx, gx, bx, ax) ((color_t){(uint8_t)(rx), (uint8_t)(gx), (uint8_t)(bx), (uint8_t)(ax)})
+
+typedef enum { FMT_NONE = 0, FMT_RGBA16, FMT_RGBA32, FMT_I8 } tex_format_t;
+typedef struct {
+  uint16_t flags, width, height, stride;
+  void *buffer;
+} surface_t;
+typedef struct sprite_s sprite_t;
+typedef struct rspq_block_s rspq_block_t;
+typedef enum { TILE0 = 0, TILE1, TILE2, TILE3, TILE4, TILE5, TILE6, TILE7 } rdpq_tile_t;
+typedef struct rdpq_texparms_s rdpq_texparms_t;
+
+// ---- Input ---- //
+typedef enum { JOYPAD_PORT_1 = 0, JOYPAD_PORT_2, JOYPAD_PORT_3, JOYPAD_PORT_4 } joypad_port_t;
+#define JOYPAD_PORT_COUNT 4
+
+typedef union {
+  uint16_t raw;
+  struct {
+    unsigned a : 1, b : 1, z : 1, start : 1;
+    unsigned d_up : 1, d_down : 1, d_left : 1, d_right : 1;
+    unsigned y : 1, x : 1, l : 1, r : 1;
+    unsigned c_up : 1, c_down : 1, c_left : 1, c_right : 1;
+  };
+} joypad_buttons_t;
+
+typedef struct {
+  joypad_buttons_t btn;
+  int8_t stick_x, stick_y;
+  int8_t cstick_x, cstick_y;
+  uint8_t analog_l, analog_r;
+} joypad_inputs_t;
+
+joypad_inputs_t joypad_get_inputs(joypad_port_t port);
+joypad_buttons_t joypad_get_buttons_pressed(joypad_port_t port);
+joypad_buttons_t joypad_get_buttons_held(joypad_port_t port);
+
+// ---- Audio ---- //
+typedef struct { int channels; } waveform_t;
+typedef struct { waveform_t wave; } wav64_t;
+
+#ifdef __cplusplus
+}
+// libdragon is C, the Tiny3D headers use the C keyword
+#define _Static_assert static_assert
+#endif
@@ -0,0 +1,197 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#include "model_host.h"
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+  constexpr uint32_t OFFSET_CHUNK_COUNT = 4;
+  constexpr uint32_t OFFSET_STRING_TABLE = 24;
+  constexpr uint32_t OFFSET_CHUNKS = 44;
+  constexpr uint32_t BONE_SIZE = 48;
+  constexpr uint32_t ANIM_SIZE = 20;
+  constexpr uint32_t CHANNEL_SIZE = 12;
+  constexpr uint32_t OBJECT_SIZE = 32; // without the parts
+  constexpr uint32_t CELL_SIZE = 20;
+  constexpr uint32_t PORTAL_SIZE = 28;
+
+  struct FileReader {
+    std::vector<uint8_t> data{};
+    uint32_t stringTable{};
+
+    uint8_t u8(uint32_t offset) const { return data[offset]; }
+    uint16_t u16(uint32_t offset) const { return (uint16_t)((data[offset] << 8) | data[offset+1]); }
+    uint32_t u32(uint32_t offset) const {
+      return ((uint32_t)data[offset] << 24) | (data[offset+1] << 16) | (data[offset+2] << 8) | data[offset+3];
+    }
+    float f32(uint32_t offset) const {
+      uint32_t val = u32(offset);
+      float res;
+      memcpy(&res, &val, sizeof(res));
+      return res;
+    }
+    const char* str(uint32_t offset) const { return (const char*)&data[stringTable + offset]; }
+  };
+
+  // Appends data to the model memory, returns its offset
+  uint32_t alloc(std::vector<uint8_t> &mem, uint32_t size) {
+    uint32_t offset = (mem.size() + 15) & ~15;
+    mem.resize(offset + size);
+    return offset;
+  }
+
+  char* strCopy(const char *str) {
+    char *res = (char*)malloc(strlen(str) + 1);
+    strcpy(res, str);
+    return res;
+  }
+}
+
+T3DModel* HostModel::load(const char *path)
+{
+  FileReader file{};
+  FILE *fp = fopen(path, "rb");
+  if(!fp)return nullptr;
+  uint8_t buff[4096];
+  size_t readSize;
+  while((readSize = fread(buff, 1, sizeof(buff), fp)) > 0) {
+    file.data.insert(file.data.end(), buff, buff + readSize);
+  }
+  fclose(fp);
+  if(file.data.size() < OFFSET_CHUNKS || memcmp(file.data.data(), "T3M", 3) != 0)return nullptr;
+
+  file.stringTable = file.u32(OFFSET_STRING_TABLE);
+  uint32_t chunkCount = file.u32(OFFSET_CHUNK_COUNT);
+
+  // chunks are referenced by a 24-bit offset from the model, so everything goes into one block
+  std::vector<uint8_t> mem{};
+  alloc(mem, sizeof(T3DModel) + sizeof(T3DChunkOffset) * chunkCount);
+  // objects and cells reference chunks by index, so unsupported chunks keep an empty entry
+  std::vector<T3DChunkOffset> chunks{};
+
+  for(uint32_t c=0; c<chunkCount; ++c) {
+    uint32_t chunk = file.u32(OFFSET_CHUNKS + c*4);
+    char type = (char)(chunk >> 24);
+    uint32_t src = chunk & 0xFFFFFF;
+    uint32_t dst = 0;
+
+    if(type == T3D_CHUNK_TYPE_SKELETON) {
+      uint16_t boneCount = file.u16(src);
+      dst = alloc(mem, sizeof(T3DChunkSkeleton) + sizeof(T3DChunkBone) * boneCount);
+      auto skel = (T3DChunkSkeleton*)&mem[dst];
+      skel->boneCount = boneCount;
+      for(uint32_t b=0; b<boneCount; ++b) {
+        uint32_t srcBone = src + 4 + b * BONE_SIZE;
+        T3DChunkBone &bone = skel->bones[b];
+        bone.name = strCopy(file.str(file.u32(srcBone)));
+        bone.parentIdx = file.u16(srcBone + 4);
+        bone.depth = file.u16(srcBone + 6);
+        for(int i=0; i<3; ++i)bone.scale.v[i] = file.f32(srcBone + 8 + i*4);
+        for(int i=0; i<4; ++i)bone.rotation.v[i] = file.f32(srcBone + 20 + i*4);
+        for(int i=0; i<3; ++i)bone.position.v[i] = file.f32(srcBone + 36 + i*4);
+      }
+    } else if(type == T3D_CHUNK_TYPE_ANIM) {
+      uint32_t channelCount = file.u16(src + 12) + file.u16(src + 14);
+      dst = alloc(mem, sizeof(T3DChunkAnim) + sizeof(T3DAnimChannelMapping) * channelCount);
+      auto anim = (T3DChunkAnim*)&mem[dst];
+      anim->name = strCopy(file.str(file.u32(src)));
+      anim->duration = file.f32(src + 4);
+      anim->keyframeCount = file.u32(src + 8);
+      anim->channelsQuat = file.u16(src + 12);
+      anim->channelsScalar = file.u16(src + 14);
+      anim->filePath = strCopy(file.str(file.u32(src + 16)));
+      for(uint32_t i=0; i<channelCount; ++i) {
+        uint32_t srcMap = src + ANIM_SIZE + i * CHANNEL_SIZE;
+        T3DAnimChannelMapping &map = anim->channelMappings[i];
+        map.targetIdx = file.u16(srcMap);
+        map.targetType = file.u8(srcMap + 2);
+        map.attributeIdx = file.u8(srcMap + 3);
+        map.quantScale = file.f32(srcMap + 4);
+        map.quantOffset = file.f32(srcMap + 8);
+      }
+    } else if(type == T3D_CHUNK_TYPE_OBJECT) {
+      // only what culling needs, no parts or materials
+      dst = alloc(mem, sizeof(T3DObject));
+      auto obj = (T3DObject*)&mem[dst];
+      obj->name = strCopy(file.str(file.u32(src)));
+      obj->triCount = file.u16(src + 6);
+      obj->isVisible = file.u8(src + 16);
+      obj->userValue0 = file.u8(src + 18);
+      obj->userValue1 = file.u8(src + 19);
+      for(int i=0; i<3; ++i) {
+        obj->aabbMin[i] = (int16_t)file.u16(src + 20 + i*2);
+        obj->aabbMax[i] = (int16_t)file.u16(src + 26 + i*2);
+      }
+    } else if(type == T3D_CHUNK_TYPE_PORTAL) {
+      // all 16-bit values, the size of the object list follows from the cells
+      uint32_t cellCount = file.u16(src);
+      uint32_t portalCount = file.u16(src + 2);
+      uint32_t objEnd = file.u16(src + 4) + file.u16(src + 6);
+      for(uint32_t i=0; i<cellCount; ++i) {
+        uint32_t srcCell = src + 8 + i * CELL_SIZE;
+        objEnd = std::max(objEnd, (uint32_t)file.u16(srcCell + 16) + file.u16(srcCell + 18));
+      }
+      uint32_t size = 8 + cellCount * CELL_SIZE + portalCount * PORTAL_SIZE + objEnd * 2;
+      dst = alloc(mem, size);
+      auto data = (uint16_t*)&mem[dst];
+      for(uint32_t i=0; i<size/2; ++i)data[i] = file.u16(src + i*2);
+    }
+
+    assertf(dst <= 0xFFFFFF, "Model too large");
+    T3DChunkOffset entry{};
+    entry.offset = dst;
+    entry.type = type;
+    chunks.push_back(entry);
+  }
+
+  auto model = (T3DModel*)malloc(mem.size());
+  memcpy(model, mem.data(), mem.size());
+  memcpy(model->magic, file.data.data(), 4);
+  model->chunkCount = chunks.size();
+  memcpy(model->chunkOffsets, chunks.data(), sizeof(T3DChunkOffset) * chunks.size());
+  return model;
+}
+
+void HostModel::free(T3DModel *model)
+{
+  for(uint32_t i=0; i<model->chunkCount; ++i) {
+    void *chunk = (uint8_t*)model + (model->chunkOffsets[i].offset & 0xFFFFFF);
+    if(model->chunkOffsets[i].type == T3D_CHUNK_TYPE_OBJECT) {
+      ::free(((T3DObject*)chunk)->name);
+    } else if(model->chunkOffsets[i].type == T3D_CHUNK_TYPE_SKELETON) {
+      auto skel = (T3DChunkSkeleton*)chunk;
+      for(uint32_t b=0; b<skel->boneCount; ++b)::free(skel->bones[b].name);
+    } else if(model->chunkOffsets[i].type == T3D_CHUNK_TYPE_ANIM) {
+      auto anim = (T3DChunkAnim*)chunk;
+      ::free(anim->name);
+      ::free(anim->filePath);
+    }
+  }
+  ::free(model);
+}
+
+// ---- t3dmodel.c ---- //
+
+T3DChunkAnim* t3d_model_get_animation(const T3DModel *model, const char *name) {
+  for(uint32_t i = 0; i < model->chunkCount; i++) {
+    if(model->chunkOffsets[i].type == T3D_CHUNK_TYPE_ANIM) {
+      uint32_t offset = model->chunkOffsets[i].offset & 0x00FFFFFF;
+      T3DChunkAnim *anim = (T3DChunkAnim*)((char*)model + offset);
+      if(strcmp(anim->name, name) == 0)return anim;
+    }
+  }
+  return NULL;
+}
+
+void t3d_model_get_animations(const T3DModel *model, T3DChunkAnim **anims) {
+  uint32_t count = 0;
+  for(uint32_t i = 0; i < model->chunkCount; i++) {
+    if(model->chunkOffsets[i].type == T3D_CHUNK_TYPE_ANIM) {
+      uint32_t offset = model->chunkOffsets[i].offset & 0x00FFFFFF;
+      anims[count++] = (T3DChunkAnim*)((char*)model + offset);
+    }
+  }
+}
@@ -0,0 +1,20 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <libdragon.h>
+#include <t3d/t3dmodel.h>
+
+/**
+ * Loads '.t3dm' files on the host.
+ * Model files are big-endian with 32-bit pointers, so the chunks are converted into the host layout.
+ * Only the skeleton, animation, portal and object chunks are converted, which is all the animation and culling code needs.
+ * Objects have no parts or materials, other chunks keep their index in the chunk table but point to no data.
+ * This also provides 't3d_model_get_animation', 't3dmodel.c' itself can't be built for the host.
+ */
+namespace HostModel
+{
+  T3DModel* load(const char *path);
+  void free(T3DModel *model);
+}
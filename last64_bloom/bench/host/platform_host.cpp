@@ -0,0 +1,70 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#include "platform_host.h"
+#include <t3d/t3d.h>
+#include <t3d/tpx.h>
+#include <time.h>
+#include "../../src/audio.h"
+#include "../../src/render/debugDraw.h"
+
+namespace
+{
+  joypad_inputs_t inputs[JOYPAD_PORT_COUNT]{};
+  joypad_buttons_t heldLast[JOYPAD_PORT_COUNT]{};
+}
+
+void HostPlatform::setInputs(joypad_port_t port, const joypad_inputs_t &newInputs) {
+  inputs[port] = newInputs;
+}
+
+void HostPlatform::endFrame() {
+  for(int i=0; i<JOYPAD_PORT_COUNT; ++i) {
+    heldLast[i] = inputs[i].btn;
+  }
+}
+
+// ---- libdragon ---- //
+
+uint32_t host_ticks_read(void) {
+  timespec ts{};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)(ts.tv_sec * 1000000000ull + ts.tv_nsec);
+}
+
+void* malloc_uncached(size_t size) { return malloc_uncached_aligned(16, size); }
+void* malloc_uncached_aligned(int align, size_t size) {
+  return aligned_alloc(align, (size + align - 1) & ~(size_t)(align - 1));
+}
+void free_uncached(void *buf) { free(buf); }
+
+joypad_inputs_t joypad_get_inputs(joypad_port_t port) { return inputs[port]; }
+joypad_buttons_t joypad_get_buttons_held(joypad_port_t port) { return inputs[port].btn; }
+joypad_buttons_t joypad_get_buttons_pressed(joypad_port_t port) {
+  return (joypad_buttons_t){.raw = (uint16_t)(inputs[port].btn.raw & ~heldLast[port].raw)};
+}
+
+// ---- Rendering, no-ops ---- //
+
+void t3d_matrix_push(const T3DMat4FP *mat) {}
+void t3d_matrix_pop(int count) {}
+void t3d_vert_load(const T3DVertPacked *vertices, uint32_t offset, uint32_t count) {}
+void t3d_tri_draw(uint32_t v0, uint32_t v1, uint32_t v2) {}
+void t3d_quad_draw_unindexed(uint32_t baseIndex, uint32_t quadCount) {}
+void t3d_state_set_drawflags(enum T3DDrawFlags drawFlags) {}
+uint16_t t3d_vert_pack_normal(const T3DVec3 *normal) { return 0; }
+
+void tpx_matrix_push(const T3DMat4FP *mat) {}
+void tpx_matrix_pop(int count) {}
+void tpx_particle_draw(TPXParticle *particles, uint32_t count) {}
+
+void Debug::printStart() {}
+float Debug::print(float x, float y, const char *str) { return x; }
+float Debug::printf(float x, float y, const char *fmt, ...) { return x; }
+
+// ---- Audio, no-ops ---- //
+
+SFXManager gSFXManager{};
+void SFXManager::init() {}
+void SFXManager::play(SfxId id) {}
@@ -0,0 +1,18 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <libdragon.h>
+
+/**
+ * Host side of the platform layer.
+ * Joypads are fed by the benchmark instead of real controllers,
+ * pressed-buttons are derived from the held state of the previous frame like on hardware.
+ */
+namespace HostPlatform
+{
+  void setInputs(joypad_port_t port, const joypad_inputs_t &inputs);
+  // Latches the current inputs, call once at the end of each simulated frame
+  void endFrame();
+}
@@ -0,0 +1,162 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#include "rom_host.h"
+#include <string>
+#include <vector>
+
+namespace
+{
+  constexpr uint32_t ROM_BASE = 0x10100000;
+  constexpr uint8_t FILL_PATTERN = 0xCD;
+
+  struct RomFile {
+    std::string path{};
+    std::vector<uint8_t> data{};
+    std::vector<uint8_t> dataSwapped{}; // what 'asset_fopen' reads with 16-bit swap
+    uint32_t romAddr{};
+  };
+
+  struct DmaReq {
+    uint8_t *dst{};
+    uint32_t romAddr{};
+    uint32_t size{};
+    uint32_t pollsLeft{};
+    bool isRunning{};
+  };
+
+  std::string mountDir{"."};
+  std::vector<RomFile> files{};
+  uint32_t nextRomAddr = ROM_BASE;
+  uint32_t latency = 0;
+  bool swap16 = false;
+  bool compressed = false;
+  DmaReq dmaReq{};
+  HostRom::Stats stats{};
+
+  std::string toHostPath(const char *path) {
+    if(strncmp(path, "rom:/", 5) == 0)path += 5;
+    if(path[0] == '/')++path;
+    return mountDir + "/" + path;
+  }
+
+  const RomFile* getFile(const char *path) {
+    std::string hostPath = toHostPath(path);
+    for(auto &file : files) {
+      if(file.path == hostPath)return &file;
+    }
+
+    FILE *fp = fopen(hostPath.c_str(), "rb");
+    if(!fp)return nullptr;
+    RomFile &file = files.emplace_back();
+    file.path = hostPath;
+    uint8_t buff[4096];
+    size_t readSize;
+    while((readSize = fread(buff, 1, sizeof(buff), fp)) > 0) {
+      file.data.insert(file.data.end(), buff, buff + readSize);
+    }
+    fclose(fp);
+
+    file.dataSwapped = file.data;
+    for(size_t i=0; i+1<file.dataSwapped.size(); i+=2)std::swap(file.dataSwapped[i], file.dataSwapped[i+1]);
+
+    file.romAddr = nextRomAddr;
+    nextRomAddr += (file.data.size() + 0xFFFF) & ~0xFFFF;
+    return &file;
+  }
+
+  void romRead(uint8_t *dst, uint32_t romAddr, uint32_t size) {
+    const RomFile *file = nullptr;
+    for(auto &f : files) {
+      if(romAddr >= f.romAddr && romAddr < f.romAddr + f.data.size()) {
+        file = &f;
+        break;
+      }
+    }
+    assertf(file, "DMA from unmapped ROM address %08lx", romAddr);
+    assertf(!compressed, "DMA from compressed file %s", file->path.c_str());
+    uint32_t offset = romAddr - file->romAddr;
+    assertf(offset + size <= file->data.size(), "DMA past the end of %s", file->path.c_str());
+
+    memcpy(dst, &file->data[offset], size);
+    if(swap16) {
+      assertf((offset & 1) == 0 && (size & 1) == 0, "Unaligned DMA with 16-bit swap");
+      for(uint32_t i=0; i<size; i+=2)std::swap(dst[i], dst[i+1]);
+    }
+    ++stats.dmaCount;
+    stats.dmaBytes += size;
+  }
+
+  void dmaFinish() {
+    romRead(dmaReq.dst, dmaReq.romAddr, dmaReq.size);
+    dmaReq.isRunning = false;
+  }
+}
+
+void HostRom::mount(const char *dir) {
+  mountDir = dir;
+  files.clear();
+  nextRomAddr = ROM_BASE;
+}
+
+void HostRom::setLatency(uint32_t polls) { latency = polls; }
+void HostRom::setSwap16(bool swap) { swap16 = swap; }
+void HostRom::setCompressed(bool isCompressed) { compressed = isCompressed; }
+HostRom::Stats& HostRom::getStats() { return stats; }
+
+// ---- libdragon ---- //
+
+FILE *asset_fopen(const char *fn, int *sz) {
+  const RomFile *file = getFile(fn);
+  assertf(file, "File not found: %s", fn);
+  if(sz)*sz = (int)file->data.size();
+  if(!swap16)return fopen(file->path.c_str(), "rb");
+  return fmemopen((void*)file->dataSwapped.data(), file->dataSwapped.size(), "rb");
+}
+
+uint32_t dfs_rom_addr(const char *path) {
+  const RomFile *file = getFile(path);
+  return file ? file->romAddr : 0;
+}
+
+int dfs_open(const char *path) {
+  const RomFile *file = getFile(path);
+  return file ? (int)(file - files.data()) : -1;
+}
+
+int dfs_size(uint32_t handle) {
+  assertf(handle < files.size(), "Invalid DFS handle %lu", handle);
+  int size = (int)files[handle].data.size();
+  return compressed ? size / 2 : size; // any size that isn't the asset one
+}
+
+int dfs_close(uint32_t handle) { return 0; }
+
+void dma_read(void *ram_address, unsigned long pi_address, unsigned long len) {
+  dma_wait();
+  romRead((uint8_t*)ram_address, pi_address, len);
+}
+
+void dma_read_async(void *ram_address, unsigned long pi_address, unsigned long len) {
+  assertf(!dmaReq.isRunning, "DMA started while another one is running");
+  memset(ram_address, FILL_PATTERN, len);
+  dmaReq = {(uint8_t*)ram_address, (uint32_t)pi_address, (uint32_t)len, latency, true};
+  if(latency == 0)dmaFinish();
+}
+
+int dma_busy(void) {
+  if(!dmaReq.isRunning)return 0;
+  if(dmaReq.pollsLeft > 0) {
+    --dmaReq.pollsLeft;
+    return 1;
+  }
+  dmaFinish();
+  return 0;
+}
+
+void dma_wait(void) {
+  if(!dmaReq.isRunning)return;
+  if(dmaReq.pollsLeft > 0)++stats.waitCount;
+  dmaFinish();
+}
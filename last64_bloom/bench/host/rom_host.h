@@ -0,0 +1,32 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <libdragon.h>
+
+/**
+ * Host emulation of the cartridge ROM and the PI DMA.
+ * 'rom:/' paths map to a directory, each file gets a fake ROM address on first use.
+ * Async DMAs only land after 'latency' polls of 'dma_busy', until then the target keeps a fill pattern,
+ * so reading a buffer before the DMA is done shows up as wrong data.
+ * 'asset_fopen' reads the data like the N64 would see it (see 'setSwap16').
+ */
+namespace HostRom
+{
+  struct Stats {
+    uint32_t dmaCount{};
+    uint32_t dmaBytes{};
+    uint32_t waitCount{}; // blocking waits on a DMA that was still running
+  };
+
+  void mount(const char *dir);
+  // Number of 'dma_busy' polls until an async DMA is done, 0 for instant
+  void setLatency(uint32_t polls);
+  // The stream data is made of 16-bit values, swapping them lets it be read like on the big-endian N64
+  void setSwap16(bool swap);
+  // Treats all files as compressed by mkasset: the raw size differs from the asset size, and DMAs fail
+  void setCompressed(bool compressed);
+
+  Stats& getStats();
+}
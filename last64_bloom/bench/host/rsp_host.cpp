@@ -0,0 +1,1183 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#include "rsp_host.h"
+#include <cassert>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Pipeline model used for the cycle estimate:
+ * - one instruction per cycle, a scalar and a vector instruction next to each other issue together,
+ *   unless the second one depends on the first or the first one is a branch
+ * - results are ready for the next instruction after: 1 cycle for scalar ALU ops,
+ *   3 for scalar loads and moves from COP0/COP2, 4 for anything writing a vector register
+ * - accumulator chains and VCC/VCO don't stall, branches cost nothing besides their delay slot
+ * - a DMA takes 24 cycles plus 1 per 8 bytes, queued DMAs run one after the other
+ */
+namespace
+{
+  constexpr uint32_t RSPQ_SCRATCH_ADDR = 0x100;
+  constexpr uint32_t OVERLAY_DATA_START = 0x200;
+  constexpr uint32_t EXIT_TARGET = 0xFFFFFFFF;
+
+  constexpr uint32_t LATENCY_LOAD = 3;
+  constexpr uint32_t LATENCY_COP = 3;
+  constexpr uint32_t LATENCY_VECTOR = 4;
+  constexpr uint32_t DMA_SETUP_CYCLES = 24;
+
+  enum class Fmt {
+    None, R3, Shift, ShiftV, Imm, Lui, Mem, Br2, Br1, Jump, Jr,
+    Mfc0, Mtc0, Mtc2, Mfc2, Cfc2, Ctc2, VOp, VMov, VMem
+  };
+
+  struct OpInfo {
+    const char *name;
+    Fmt fmt;
+    uint32_t memScale; // vector loads/stores: offset unit in bytes
+  };
+
+  const OpInfo OPS[] = {
+    {"nop", Fmt::None}, {"break", Fmt::None},
+    {"addu", Fmt::R3}, {"add", Fmt::R3}, {"subu", Fmt::R3}, {"sub", Fmt::R3},
+    {"and", Fmt::R3}, {"or", Fmt::R3}, {"xor", Fmt::R3}, {"nor", Fmt::R3},
+    {"slt", Fmt::R3}, {"sltu", Fmt::R3},
+    {"sll", Fmt::Shift}, {"srl", Fmt::Shift}, {"sra", Fmt::Shift},
+    {"sllv", Fmt::ShiftV}, {"srlv", Fmt::ShiftV}, {"srav", Fmt::ShiftV},
+    {"addiu", Fmt::Imm}, {"addi", Fmt::Imm}, {"andi", Fmt::Imm}, {"ori", Fmt::Imm}, {"xori", Fmt::Imm},
+    {"slti", Fmt::Imm}, {"sltiu", Fmt::Imm}, {"lui", Fmt::Lui},
+    {"lw", Fmt::Mem}, {"lh", Fmt::Mem}, {"lhu", Fmt::Mem}, {"lb", Fmt::Mem}, {"lbu", Fmt::Mem},
+    {"sw", Fmt::Mem}, {"sh", Fmt::Mem}, {"sb", Fmt::Mem},
+    {"beq", Fmt::Br2}, {"bne", Fmt::Br2},
+    {"blez", Fmt::Br1}, {"bgtz", Fmt::Br1}, {"bltz", Fmt::Br1}, {"bgez", Fmt::Br1},
+    {"j", Fmt::Jump}, {"jal", Fmt::Jump}, {"jr", Fmt::Jr},
+    {"mfc0", Fmt::Mfc0}, {"mtc0", Fmt::Mtc0},
+    {"mtc2", Fmt::Mtc2}, {"mfc2", Fmt::Mfc2}, {"cfc2", Fmt::Cfc2}, {"ctc2", Fmt::Ctc2},
+    {"vmulf", Fmt::VOp}, {"vmulu", Fmt::VOp}, {"vmudl", Fmt::VOp}, {"vmudm", Fmt::VOp},
+    {"vmudn", Fmt::VOp}, {"vmudh", Fmt::VOp}, {"vmacf", Fmt::VOp}, {"vmacu", Fmt::VOp},
+    {"vmadl", Fmt::VOp}, {"vmadm", Fmt::VOp}, {"vmadn", Fmt::VOp}, {"vmadh", Fmt::VOp},
+    {"vadd", Fmt::VOp}, {"vsub", Fmt::VOp}, {"vaddc", Fmt::VOp}, {"vsubc", Fmt::VOp}, {"vabs", Fmt::VOp},
+    {"vand", Fmt::VOp}, {"vnand", Fmt::VOp}, {"vor", Fmt::VOp}, {"vnor", Fmt::VOp},
+    {"vxor", Fmt::VOp}, {"vnxor", Fmt::VOp},
+    {"vlt", Fmt::VOp}, {"veq", Fmt::VOp}, {"vne", Fmt::VOp}, {"vge", Fmt::VOp}, {"vmrg", Fmt::VOp},
+    {"vmov", Fmt::VMov},
+    {"lbv", Fmt::VMem, 1}, {"lsv", Fmt::VMem, 2}, {"llv", Fmt::VMem, 4}, {"ldv", Fmt::VMem, 8},
+    {"lqv", Fmt::VMem, 16}, {"lrv", Fmt::VMem, 16}, {"lpv", Fmt::VMem, 8}, {"luv", Fmt::VMem, 8},
+    {"lhv", Fmt::VMem, 16}, {"lfv", Fmt::VMem, 16},
+    {"sbv", Fmt::VMem, 1}, {"ssv", Fmt::VMem, 2}, {"slv", Fmt::VMem, 4}, {"sdv", Fmt::VMem, 8},
+    {"sqv", Fmt::VMem, 16}, {"srv", Fmt::VMem, 16}, {"spv", Fmt::VMem, 8}, {"suv", Fmt::VMem, 8},
+    {"shv", Fmt::VMem, 16},
+  };
+
+  struct Instr {
+    const OpInfo *op{};
+    std::string name{};
+    uint8_t rd{}, rs{}, rt{}; // GPRs, or vd/vs/vt for vector ops
+    uint8_t e{}; // element of vt, or byte element of vector loads/stores
+    uint8_t de{}; // destination element of 'vmov'
+    int32_t imm{};
+    std::string target{};
+    uint32_t targetIdx{};
+    int line{};
+    bool isVU{};
+  };
+
+  struct Dma {
+    uint32_t dmem, rdram, len, count, skip;
+    bool toDmem;
+    uint64_t end;
+  };
+
+  // assembler state
+  std::map<std::string, uint32_t> symbols{};
+  std::map<std::string, uint32_t> labels{};
+  std::map<std::string, std::string> defines{};
+  std::vector<Instr> code{};
+  std::vector<uint32_t> commands{};
+  std::vector<uint8_t> dmemInit{};
+  uint32_t dmemEnd{};
+
+  // machine state
+  uint8_t dmem[HostRsp::DMEM_SIZE]{};
+  std::vector<uint8_t> rdram(HostRsp::RDRAM_SIZE);
+  uint32_t gpr[32]{};
+  uint16_t vpr[32][8]{};
+  uint16_t accH[8]{}, accM[8]{}, accL[8]{};
+  uint16_t vco{}, vcc{};
+  uint8_t vce{};
+  uint32_t dmaSpAddr{}, dmaRamAddr{};
+  std::vector<Dma> dmas{};
+
+  // timing
+  HostRsp::Stats stats{};
+  std::vector<uint64_t> cyclesPerInstr{};
+  uint64_t cycle{};
+  uint64_t gprReady[32]{}, vprReady[32]{};
+  const Instr *lastInstr{};
+  bool lastPaired{};
+  int runLine{};
+
+  [[noreturn]] void fatal(const char *msg, const std::string &arg) {
+    fprintf(stderr, "RSP: %s '%s' (line %d)\n", msg, arg.c_str(), runLine);
+    exit(1);
+  }
+
+  /* ---------------- Assembler ---------------- */
+
+  std::string trim(const std::string &s) {
+    size_t a = s.find_first_not_of(" \t\r\n");
+    if(a == std::string::npos)return "";
+    size_t b = s.find_last_not_of(" \t\r\n");
+    return s.substr(a, b - a + 1);
+  }
+
+  std::vector<std::string> splitArgs(const std::string &s) {
+    std::vector<std::string> res{};
+    int depth = 0;
+    std::string cur{};
+    for(char c : s) {
+      if(c == '(')++depth;
+      if(c == ')')--depth;
+      if(c == ',' && depth == 0) {
+        res.push_back(trim(cur));
+        cur.clear();
+      } else {
+        cur += c;
+      }
+    }
+    if(!trim(cur).empty())res.push_back(trim(cur));
+    return res;
+  }
+
+  struct ExprParser {
+    const std::string &s;
+    size_t pos{0};
+    bool ok{true};
+    bool allowUndefined{false};
+
+    void skip() { while(pos < s.size() && isspace((unsigned char)s[pos]))++pos; }
+
+    int64_t primary() {
+      skip();
+      if(pos >= s.size()) { ok = false; return 0; }
+      char c = s[pos];
+      if(c == '(') {
+        ++pos;
+        int64_t v = expr();
+        skip();
+        if(pos < s.size() && s[pos] == ')')++pos; else ok = false;
+        return v;
+      }
+      if(c == '-') { ++pos; return -primary(); }
+      if(c == '~') { ++pos; return ~primary(); }
+      if(c == '%') {
+        size_t start = ++pos;
+        while(pos < s.size() && isalpha((unsigned char)s[pos]))++pos;
+        std::string fn = s.substr(start, pos - start);
+        int64_t v = primary();
+        if(fn == "lo")return v & 0xFFFF;
+        if(fn == "hi")return (v >> 16) & 0xFFFF;
+        ok = false;
+        return 0;
+      }
+      if(isdigit((unsigned char)c)) {
+        size_t start = pos;
+        while(pos < s.size() && (isalnum((unsigned char)s[pos]) || s[pos] == '\''))++pos;
+        std::string num{};
+        for(char n : s.substr(start, pos - start))if(n != '\'')num += n;
+        if(num.size() > 2 && (num[1] == 'b' || num[1] == 'B'))return strtoll(num.c_str() + 2, nullptr, 2);
+        return strtoll(num.c_str(), nullptr, 0);
+      }
+      if(isalpha((unsigned char)c) || c == '_' || c == '.') {
+        size_t start = pos;
+        while(pos < s.size() && (isalnum((unsigned char)s[pos]) || s[pos] == '_' || s[pos] == '.'))++pos;
+        std::string name = s.substr(start, pos - start);
+        auto def = defines.find(name);
+        if(def != defines.end()) {
+          ExprParser sub{def->second};
+          int64_t v = sub.expr();
+          ok = ok && sub.ok;
+          return v;
+        }
+        auto sym = symbols.find(name);
+        if(sym != symbols.end())return sym->second;
+        if(!allowUndefined)ok = false;
+        return 0;
+      }
+      ok = false;
+      return 0;
+    }
+
+    int64_t mul() {
+      int64_t v = primary();
+      for(;;) {
+        skip();
+        if(pos >= s.size())return v;
+        if(s[pos] == '*') { ++pos; v *= primary(); }
+        else if(s[pos] == '/') { ++pos; int64_t d = primary(); v = d ? v / d : 0; }
+        else return v;
+      }
+    }
+
+    int64_t add() {
+      int64_t v = mul();
+      for(;;) {
+        skip();
+        if(pos >= s.size())return v;
+        if(s[pos] == '+') { ++pos; v += mul(); }
+        else if(s[pos] == '-') { ++pos; v -= mul(); }
+        else return v;
+      }
+    }
+
+    int64_t shift() {
+      int64_t v = add();
+      for(;;) {
+        skip();
+        if(s.compare(pos, 2, "<<") == 0) { pos += 2; v <<= add(); }
+        else if(s.compare(pos, 2, ">>") == 0) { pos += 2; v >>= add(); }
+        else return v;
+      }
+    }
+
+    int64_t expr() {
+      int64_t v = shift();
+      for(;;) {
+        skip();
+        if(pos >= s.size())return v;
+        if(s[pos] == '&') { ++pos; v &= shift(); }
+        else if(s[pos] == '|') { ++pos; v |= shift(); }
+        else return v;
+      }
+    }
+  };
+
+  bool evalExpr(const std::string &s, int64_t &res, bool allowUndefined = false) {
+    ExprParser p{s};
+    p.allowUndefined = allowUndefined;
+    res = p.expr();
+    p.skip();
+    return p.ok && p.pos == s.size();
+  }
+
+  const char* const GPR_NAMES[32] = {
+    "zero", "at", "v0", "v1", "a0", "a1", "a2", "a3", "t0", "t1", "t2", "t3", "t4", "t5", "t6", "t7",
+    "s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7", "t8", "t9", "k0", "k1", "gp", "sp", "fp", "ra"
+  };
+
+  bool parseGpr(const std::string &s, uint8_t &reg) {
+    if(s.size() < 2 || s[0] != '$')return false;
+    std::string name = s.substr(1);
+    for(int i=0; i<32; ++i) {
+      if(name == GPR_NAMES[i]) { reg = i; return true; }
+    }
+    if(isdigit((unsigned char)name[0])) {
+      int idx = atoi(name.c_str());
+      if(idx >= 0 && idx < 32) { reg = idx; return true; }
+    }
+    return false;
+  }
+
+  // '$v12', '$v12.v', '$v12.e3', '$v12.q1', '$v12.h2'
+  bool parseVpr(const std::string &s, uint8_t &reg, uint8_t &elem, bool &hasElem) {
+    if(s.size() < 3 || s.compare(0, 2, "$v") != 0 || !isdigit((unsigned char)s[2]))return false;
+    size_t dot = s.find('.');
+    reg = atoi(s.substr(2, dot - 2).c_str());
+    if(reg > 31)return false;
+    elem = 0;
+    hasElem = false;
+    if(dot == std::string::npos)return true;
+
+    std::string e = s.substr(dot + 1);
+    hasElem = true;
+    if(e == "v") { elem = 0; hasElem = false; return true; }
+    if(e.size() == 2 && isdigit((unsigned char)e[1])) {
+      int n = e[1] - '0';
+      if(e[0] == 'e' && n < 8) { elem = 8 + n; return true; }
+      if(e[0] == 'q' && n < 2) { elem = 2 + n; return true; }
+      if(e[0] == 'h' && n < 4) { elem = 4 + n; return true; }
+    }
+    return false;
+  }
+
+  struct PendingLine {
+    std::string text;
+    int line;
+  };
+
+  bool assemble(const std::vector<PendingLine> &lines) {
+    enum class Section { Data, Bss, Text } section = Section::Text;
+    uint32_t dataPos = OVERLAY_DATA_START;
+    std::vector<PendingLine> textLines{};
+    std::vector<std::string> textLabels{};
+    std::vector<std::string> pendingCommands{};
+    dmemInit.assign(HostRsp::DMEM_SIZE, 0);
+
+    auto fail = [](const PendingLine &l, const char *msg) {
+      fprintf(stderr, "RSP asm: %s, line %d: %s\n", msg, l.line, l.text.c_str());
+      return false;
+    };
+
+    // first pass: data layout and labels
+    for(auto &l : lines) {
+      std::string t = l.text;
+      while(!t.empty()) {
+        size_t colon = t.find(':');
+        bool isLabel = colon != std::string::npos;
+        for(size_t i=0; isLabel && i<colon; ++i) {
+          if(!(isalnum((unsigned char)t[i]) || t[i] == '_' || t[i] == '.'))isLabel = false;
+        }
+        if(!isLabel)break;
+        std::string name = t.substr(0, colon);
+        if(section == Section::Text) {
+          labels[name] = (uint32_t)textLines.size();
+        } else {
+          symbols[name] = dataPos;
+        }
+        t = trim(t.substr(colon + 1));
+      }
+      if(t.empty())continue;
+
+      size_t sp = t.find_first_of(" \t");
+      std::string cmd = sp == std::string::npos ? t : t.substr(0, sp);
+      std::string rest = sp == std::string::npos ? "" : trim(t.substr(sp));
+      auto args = splitArgs(rest);
+
+      if(cmd == ".data") { section = Section::Data; continue; }
+      if(cmd == ".bss") { section = Section::Bss; continue; }
+      if(cmd == ".text") { section = Section::Text; continue; }
+      if(cmd == ".set" || cmd == ".equ" || cmd == ".global" || cmd == ".globl")continue;
+      if(cmd == "RSPQ_BeginOverlayHeader" || cmd == "RSPQ_EndOverlayHeader")continue;
+      if(cmd == "RSPQ_EmptySavedState" || cmd == "RSPQ_BeginSavedState" || cmd == "RSPQ_EndSavedState")continue;
+      if(cmd == "RSPQ_DefineCommand") {
+        if(args.size() != 2)return fail(l, "bad command definition");
+        pendingCommands.push_back(args[0]);
+        continue;
+      }
+
+      if(section == Section::Text) {
+        if(cmd == ".align")continue;
+        textLines.push_back({t, l.line});
+        continue;
+      }
+
+      int64_t val;
+      if(cmd == ".align") {
+        if(args.size() != 1 || !evalExpr(args[0], val))return fail(l, "bad align");
+        uint32_t align = 1u << val;
+        dataPos = (dataPos + align - 1) & ~(align - 1);
+        continue;
+      }
+      uint32_t size = 0;
+      if(cmd == ".byte")size = 1;
+      else if(cmd == ".half" || cmd == ".short")size = 2;
+      else if(cmd == ".word" || cmd == ".long")size = 4;
+      else if(cmd == ".quad")size = 8;
+      if(size) {
+        for(auto &a : args) {
+          if(!evalExpr(a, val, true))return fail(l, "bad data value");
+          for(uint32_t b=0; b<size; ++b) {
+            dmemInit[(dataPos + b) % HostRsp::DMEM_SIZE] = (uint8_t)(val >> ((size - 1 - b) * 8));
+          }
+          dataPos += size;
+        }
+        continue;
+      }
+      if(cmd == ".ds.b" || cmd == ".space" || cmd == ".skip") {
+        if(args.empty() || !evalExpr(args[0], val))return fail(l, "bad size");
+        dataPos += (uint32_t)val;
+        continue;
+      }
+      return fail(l, "unknown directive");
+    }
+    dmemEnd = dataPos;
+    if(dmemEnd > HostRsp::DMEM_SIZE) {
+      fprintf(stderr, "RSP asm: data does not fit into DMEM (%u bytes)\n", dmemEnd);
+      return false;
+    }
+
+    // second pass: instructions
+    code.clear();
+    for(auto &l : textLines) {
+      size_t sp = l.text.find_first_of(" \t");
+      std::string name = sp == std::string::npos ? l.text : l.text.substr(0, sp);
+      std::string rest = sp == std::string::npos ? "" : trim(l.text.substr(sp));
+      auto args = splitArgs(rest);
+
+      Instr in{};
+      in.name = name;
+      in.line = l.line;
+      for(auto &op : OPS)if(name == op.name)in.op = &op;
+      if(!in.op)return fail(l, "unknown instruction");
+
+      auto expectArgs = [&](size_t n) { return args.size() == n; };
+      auto gpr = [&](size_t i, uint8_t &reg) { return i < args.size() && parseGpr(args[i], reg); };
+      auto imm = [&](size_t i, int32_t &v) {
+        int64_t val;
+        if(i >= args.size() || !evalExpr(args[i], val))return false;
+        v = (int32_t)val;
+        return true;
+      };
+      bool hasElem;
+      bool ok = true;
+
+      switch(in.op->fmt) {
+        case Fmt::None: ok = args.empty(); break;
+        case Fmt::R3: ok = expectArgs(3) && gpr(0, in.rd) && gpr(1, in.rs) && gpr(2, in.rt); break;
+        case Fmt::Shift: ok = expectArgs(3) && gpr(0, in.rd) && gpr(1, in.rt) && imm(2, in.imm) && in.imm >= 0 && in.imm < 32; break;
+        case Fmt::ShiftV: ok = expectArgs(3) && gpr(0, in.rd) && gpr(1, in.rt) && gpr(2, in.rs); break;
+        case Fmt::Imm:
+          ok = expectArgs(3) && gpr(0, in.rt) && gpr(1, in.rs) && imm(2, in.imm);
+          // the assembler takes both signed and unsigned 16-bit values
+          ok = ok && in.imm >= -0x8000 && in.imm <= 0xFFFF;
+          if(ok && (name == "andi" || name == "ori" || name == "xori"))ok = in.imm >= 0;
+          break;
+        case Fmt::Lui: ok = expectArgs(2) && gpr(0, in.rt) && imm(1, in.imm) && in.imm >= 0 && in.imm <= 0xFFFF; break;
+        case Fmt::Mem: {
+          ok = expectArgs(2) && gpr(0, in.rt);
+          if(!ok)break;
+          std::string addr = args[1];
+          in.rs = 0;
+          if(!addr.empty() && addr.back() == ')') {
+            size_t open = addr.rfind('(');
+            std::string base = addr.substr(open + 1, addr.size() - open - 2);
+            if(parseGpr(base, in.rs)) {
+              addr = trim(addr.substr(0, open));
+            }
+          }
+          int64_t val = 0;
+          ok = addr.empty() || evalExpr(addr, val);
+          in.imm = (int32_t)val;
+          ok = ok && in.imm >= -0x8000 && in.imm <= 0xFFFF;
+          break;
+        }
+        case Fmt::Br2: ok = expectArgs(3) && gpr(0, in.rs) && gpr(1, in.rt); if(ok)in.target = args[2]; break;
+        case Fmt::Br1: ok = expectArgs(2) && gpr(0, in.rs); if(ok)in.target = args[1]; break;
+        case Fmt::Jump: ok = expectArgs(1); if(ok)in.target = args[0]; break;
+        case Fmt::Jr: ok = expectArgs(1) && gpr(0, in.rs); break;
+        case Fmt::Mfc0: case Fmt::Mtc0: ok = expectArgs(2) && gpr(0, in.rt) && imm(1, in.imm); break;
+        case Fmt::Mtc2: case Fmt::Mfc2:
+          ok = expectArgs(2) && gpr(0, in.rt) && parseVpr(args[1], in.rd, in.e, hasElem);
+          // 'vN.eM' selects element M, the instruction takes its byte offset
+          if(ok)in.e = hasElem ? (in.e - 8) * 2 : 0;
+          break;
+        case Fmt::Cfc2: case Fmt::Ctc2: ok = expectArgs(2) && gpr(0, in.rt) && imm(1, in.imm) && in.imm >= 0 && in.imm <= 2; break;
+        case Fmt::VOp: {
+          uint8_t e0, e1;
+          ok = expectArgs(3) && parseVpr(args[0], in.rd, e0, hasElem) && !hasElem
+            && parseVpr(args[1], in.rs, e1, hasElem) && !hasElem
+            && parseVpr(args[2], in.rt, in.e, hasElem);
+          in.isVU = true;
+          break;
+        }
+        case Fmt::VMov: {
+          uint8_t de = 0;
+          bool hasDe;
+          ok = expectArgs(2) && parseVpr(args[0], in.rd, de, hasDe) && hasDe && de >= 8
+            && parseVpr(args[1], in.rt, in.e, hasElem);
+          in.de = de - 8;
+          in.isVU = true;
+          break;
+        }
+        case Fmt::VMem: {
+          uint8_t e;
+          int32_t elem = 0;
+          ok = expectArgs(4) && parseVpr(args[0], in.rt, e, hasElem) && !hasElem
+            && imm(1, elem) && imm(2, in.imm) && gpr(3, in.rs);
+          ok = ok && elem >= 0 && elem < 16;
+          in.e = (uint8_t)elem;
+          uint32_t scale = in.op->memScale;
+          // the offset is encoded as a signed 7-bit multiple of the access size
+          if(ok && (in.imm % (int32_t)scale != 0 || in.imm / (int32_t)scale < -64 || in.imm / (int32_t)scale > 63)) {
+            return fail(l, "vector offset can't be encoded");
+          }
+          break;
+        }
+      }
+      if(!ok)return fail(l, "bad operands");
+      code.push_back(in);
+    }
+
+    for(auto &in : code) {
+      if(in.target.empty())continue;
+      if(in.target == "RSPQ_Loop") {
+        in.targetIdx = EXIT_TARGET;
+        continue;
+      }
+      auto it = labels.find(in.target);
+      if(it == labels.end()) {
+        fprintf(stderr, "RSP asm: unknown label '%s', line %d\n", in.target.c_str(), in.line);
+        return false;
+      }
+      in.targetIdx = it->second;
+    }
+
+    commands.clear();
+    for(auto &name : pendingCommands) {
+      auto it = labels.find(name);
+      if(it == labels.end()) {
+        fprintf(stderr, "RSP asm: unknown command '%s'\n", name.c_str());
+        return false;
+      }
+      commands.push_back(it->second);
+    }
+    return true;
+  }
+
+  /* ---------------- Memory & DMA ---------------- */
+
+  bool rangesOverlap(uint32_t a, uint32_t aSize, uint32_t b, uint32_t bSize) {
+    return a < b + bSize && b < a + aSize;
+  }
+
+  void dmemAccess(uint32_t addr, uint32_t size, bool isWrite) {
+    for(auto &dma : dmas) {
+      if(dma.end <= cycle)continue;
+      if(!isWrite && !dma.toDmem)continue; // reading what is being written out is fine
+      if(rangesOverlap(addr & 0xFFF, size, dma.dmem, dma.len * dma.count)) {
+        if(stats.dmaHazards < 8) {
+          fprintf(stderr, "RSP: DMEM %s at 0x%03X while a DMA is running (line %d)\n",
+            isWrite ? "write" : "read", addr & 0xFFF, runLine);
+        }
+        ++stats.dmaHazards;
+        return;
+      }
+    }
+  }
+
+  uint8_t readByte(uint32_t addr) { return dmem[addr & 0xFFF]; }
+  void writeByte(uint32_t addr, uint8_t v) { dmem[addr & 0xFFF] = v; }
+
+  uint32_t read(uint32_t addr, uint32_t size) {
+    dmemAccess(addr, size, false);
+    uint32_t v = 0;
+    for(uint32_t i=0; i<size; ++i)v = (v << 8) | readByte(addr + i);
+    return v;
+  }
+
+  void write(uint32_t addr, uint32_t size, uint32_t v) {
+    dmemAccess(addr, size, true);
+    for(uint32_t i=0; i<size; ++i)writeByte(addr + i, (uint8_t)(v >> ((size - 1 - i) * 8)));
+  }
+
+  void finishDmas(uint64_t untilCycle) {
+    while(!dmas.empty() && dmas.front().end <= untilCycle) {
+      Dma &dma = dmas.front();
+      uint32_t dmemAddr = dma.dmem;
+      uint32_t ramAddr = dma.rdram;
+      for(uint32_t r=0; r<dma.count; ++r) {
+        for(uint32_t i=0; i<dma.len; ++i) {
+          uint32_t ramIdx = (ramAddr + i) & (HostRsp::RDRAM_SIZE - 1);
+          if(dma.toDmem) {
+            dmem[(dmemAddr + i) & 0xFFF] = rdram[ramIdx];
+          } else {
+            rdram[ramIdx] = dmem[(dmemAddr + i) & 0xFFF];
+          }
+        }
+        dmemAddr += dma.len;
+        ramAddr += dma.len + dma.skip;
+      }
+      dmas.erase(dmas.begin());
+    }
+  }
+
+  void startDma(uint32_t lenReg, bool toDmem) {
+    uint32_t pending = 0;
+    for(auto &dma : dmas)if(dma.end > cycle)++pending;
+    if(pending >= 2)fatal("DMA queue overflow", toDmem ? "read" : "write");
+    if(dmaSpAddr & 0x1000)fatal("DMA into IMEM", "");
+
+    Dma dma{};
+    dma.dmem = dmaSpAddr & 0xFF8;
+    dma.rdram = dmaRamAddr & 0xFFFFF8;
+    dma.len = ((lenReg & 0xFFF) | 7) + 1;
+    dma.count = ((lenReg >> 12) & 0xFF) + 1;
+    dma.skip = (lenReg >> 20) & 0xFFF;
+    dma.toDmem = toDmem;
+    if(dma.dmem + dma.len * dma.count > HostRsp::DMEM_SIZE)fatal("DMA past the end of DMEM", "");
+
+    uint64_t start = dmas.empty() ? cycle : std::max(cycle, dmas.back().end);
+    dma.end = start + DMA_SETUP_CYCLES + (dma.len * dma.count) / 8;
+    dmas.push_back(dma);
+    ++stats.dmaCount;
+  }
+
+  /* ---------------- Vector unit ---------------- */
+
+  uint8_t vbyte(uint8_t reg, uint32_t i) {
+    uint16_t v = vpr[reg][(i & 15) >> 1];
+    return (i & 1) ? (uint8_t)v : (uint8_t)(v >> 8);
+  }
+
+  void setVbyte(uint16_t *v, uint32_t i, uint8_t val) {
+    i &= 15;
+    if(i & 1) {
+      v[i >> 1] = (v[i >> 1] & 0xFF00) | val;
+    } else {
+      v[i >> 1] = (v[i >> 1] & 0x00FF) | (uint16_t)(val << 8);
+    }
+  }
+
+  uint32_t broadcast(uint8_t e, uint32_t lane) {
+    if(e < 2)return lane;
+    if(e < 4)return (lane & ~1u) | (e - 2);
+    if(e < 8)return (lane & ~3u) | (e - 4);
+    return e - 8;
+  }
+
+  int64_t accGet(int i) {
+    int64_t v = ((int64_t)accH[i] << 32) | ((int64_t)accM[i] << 16) | accL[i];
+    return (v << 16) >> 16; // sign-extend from 48 bits
+  }
+
+  void accSet(int i, int64_t v) {
+    accH[i] = (uint16_t)(v >> 32);
+    accM[i] = (uint16_t)(v >> 16);
+    accL[i] = (uint16_t)v;
+  }
+
+  // clamps the upper 32 bits of the accumulator to s16, returns the middle or lower 16 bits if they fit
+  uint16_t accSaturate(int i, bool mid, uint16_t negative, uint16_t positive) {
+    int64_t hiMid = accGet(i) >> 16;
+    if(hiMid < -32768)return negative;
+    if(hiMid > 32767)return positive;
+    return mid ? accM[i] : accL[i];
+  }
+
+  uint16_t accUnsigned(int i) {
+    int64_t hiMid = accGet(i) >> 16;
+    if(hiMid < 0)return 0;
+    if(hiMid > 0x7FFF)return 0xFFFF;
+    return accM[i];
+  }
+
+  uint16_t clampS16(int32_t v) {
+    if(v < -32768)return 0x8000;
+    if(v > 32767)return 0x7FFF;
+    return (uint16_t)v;
+  }
+
+  void execVector(const Instr &in) {
+    uint16_t res[8];
+    uint16_t vs[8], vt[8];
+    for(int i=0; i<8; ++i) {
+      vs[i] = vpr[in.rs][i];
+      vt[i] = vpr[in.rt][broadcast(in.e, i)];
+    }
+    const std::string &n = in.name;
+
+    for(int i=0; i<8; ++i) {
+      int32_t s = (int16_t)vs[i], t = (int16_t)vt[i];
+      uint32_t su = vs[i], tu = vt[i];
+      bool carry = (vco >> i) & 1;
+      bool notEqual = (vco >> (i + 8)) & 1;
+
+      if(n == "vmulf" || n == "vmulu") {
+        accSet(i, (int64_t)s * t * 2 + 0x8000);
+        res[i] = n == "vmulf" ? accSaturate(i, true, 0x8000, 0x7FFF) : accUnsigned(i);
+      } else if(n == "vmacf" || n == "vmacu") {
+        accSet(i, accGet(i) + (int64_t)s * t * 2);
+        res[i] = n == "vmacf" ? accSaturate(i, true, 0x8000, 0x7FFF) : accUnsigned(i);
+      } else if(n == "vmudl" || n == "vmadl") {
+        int64_t prod = ((int64_t)su * tu) >> 16;
+        accSet(i, n == "vmudl" ? prod : accGet(i) + prod);
+        res[i] = accSaturate(i, false, 0x0000, 0xFFFF);
+      } else if(n == "vmudm" || n == "vmadm") {
+        int64_t prod = (int64_t)s * (int64_t)tu;
+        accSet(i, n == "vmudm" ? prod : accGet(i) + prod);
+        res[i] = accSaturate(i, true, 0x8000, 0x7FFF);
+      } else if(n == "vmudn" || n == "vmadn") {
+        int64_t prod = (int64_t)su * (int64_t)t;
+        accSet(i, n == "vmudn" ? prod : accGet(i) + prod);
+        res[i] = accSaturate(i, false, 0x0000, 0xFFFF);
+      } else if(n == "vmudh" || n == "vmadh") {
+        int64_t prod = ((int64_t)s * t) * 65536;
+        accSet(i, n == "vmudh" ? prod : accGet(i) + prod);
+        res[i] = accSaturate(i, true, 0x8000, 0x7FFF);
+      } else if(n == "vadd" || n == "vsub") {
+        int32_t r = n == "vadd" ? s + t + carry : s - t - carry;
+        accL[i] = (uint16_t)r;
+        res[i] = clampS16(r);
+      } else if(n == "vaddc") {
+        uint32_t r = su + tu;
+        accL[i] = res[i] = (uint16_t)r;
+      } else if(n == "vsubc") {
+        int32_t r = (int32_t)su - (int32_t)tu;
+        accL[i] = res[i] = (uint16_t)r;
+      } else if(n == "vabs") {
+        if(s < 0) {
+          accL[i] = (uint16_t)-t;
+          res[i] = t == -32768 ? 0x7FFF : (uint16_t)-t;
+        } else {
+          accL[i] = res[i] = s == 0 ? 0 : vt[i];
+        }
+      } else if(n == "vand")  { accL[i] = res[i] = su & tu; }
+      else if(n == "vnand") { accL[i] = res[i] = ~(su & tu); }
+      else if(n == "vor")   { accL[i] = res[i] = su | tu; }
+      else if(n == "vnor")  { accL[i] = res[i] = ~(su | tu); }
+      else if(n == "vxor")  { accL[i] = res[i] = su ^ tu; }
+      else if(n == "vnxor") { accL[i] = res[i] = ~(su ^ tu); }
+      else if(n == "vlt" || n == "vge" || n == "veq" || n == "vne") {
+        bool eq = s == t;
+        bool cond;
+        if(n == "vlt")cond = s < t || (eq && carry && notEqual);
+        else if(n == "vge")cond = s > t || (eq && !(carry && notEqual));
+        else if(n == "veq")cond = eq && !notEqual;
+        else cond = !eq || notEqual;
+        vcc = (vcc & ~(1u << i)) | (cond << i);
+        accL[i] = res[i] = cond ? vs[i] : vt[i];
+      } else if(n == "vmrg") {
+        accL[i] = res[i] = ((vcc >> i) & 1) ? vs[i] : vt[i];
+      } else {
+        fatal("unsupported vector op", n);
+      }
+    }
+
+    // flags are written after all lanes read them
+    if(n == "vaddc" || n == "vsubc") {
+      uint16_t flags = 0;
+      for(int i=0; i<8; ++i) {
+        uint32_t su = vs[i], tu = vt[i];
+        if(n == "vaddc") {
+          if(su + tu > 0xFFFF)flags |= 1 << i;
+        } else {
+          if(su < tu)flags |= 1 << i;
+          if(su != tu)flags |= 1 << (i + 8);
+        }
+      }
+      vco = flags;
+    } else if(n == "vadd" || n == "vsub" || n == "vmrg") {
+      vco = 0;
+    } else if(n == "vlt" || n == "vge" || n == "veq" || n == "vne") {
+      vco = 0;
+      vcc &= 0xFF;
+    }
+
+    memcpy(vpr[in.rd], res, sizeof(res));
+  }
+
+  void execVectorMem(const Instr &in) {
+    const std::string &n = in.name;
+    uint32_t scale = in.op->memScale;
+    uint32_t addr = gpr[in.rs] + in.imm;
+    uint32_t e = in.e;
+    uint16_t *vt = vpr[in.rt];
+
+    bool isLoad = n[0] == 'l';
+    if(isLoad) {
+      if(n == "lbv" || n == "lsv" || n == "llv" || n == "ldv") {
+        dmemAccess(addr, scale, false);
+        uint32_t end = std::min(e + scale, 16u);
+        for(uint32_t i=e; i<end; ++i)setVbyte(vt, i, readByte(addr++));
+      } else if(n == "lqv") {
+        uint32_t end = std::min(16 + e - (addr & 15), 16u);
+        dmemAccess(addr, end - e, false);
+        for(uint32_t i=e; i<end; ++i)setVbyte(vt, i, readByte(addr++));
+      } else if(n == "lrv") {
+        uint32_t start = 16 - ((addr & 15) - e);
+        addr &= ~15u;
+        dmemAccess(addr, 16, false);
+        for(uint32_t i=start; i<16; ++i)setVbyte(vt, i, readByte(addr++));
+      } else if(n == "lpv" || n == "luv") {
+        uint32_t shift = n == "lpv" ? 8 : 7;
+        uint32_t index = (addr & 7) - e;
+        addr &= ~7u;
+        dmemAccess(addr, 16, false);
+        for(uint32_t i=0; i<8; ++i)vt[i] = (uint16_t)(readByte(addr + ((index + i) & 15)) << shift);
+      } else if(n == "lhv") {
+        uint32_t index = (addr & 7) - e;
+        addr &= ~7u;
+        dmemAccess(addr, 16, false);
+        for(uint32_t i=0; i<8; ++i)vt[i] = (uint16_t)(readByte(addr + ((index + i * 2) & 15)) << 7);
+      } else if(n == "lfv") {
+        uint32_t index = (addr & 7) - e;
+        addr &= ~7u;
+        dmemAccess(addr, 16, false);
+        uint16_t tmp[8];
+        for(uint32_t i=0; i<4; ++i) {
+          tmp[i + 0] = (uint16_t)(readByte(addr + ((index + i * 4 + 0) & 15)) << 7);
+          tmp[i + 4] = (uint16_t)(readByte(addr + ((index + i * 4 + 8) & 15)) << 7);
+        }
+        uint32_t end = std::min(e + 8, 16u);
+        for(uint32_t i=e; i<end; ++i) {
+          uint16_t v = tmp[i >> 1];
+          setVbyte(vt, i, (i & 1) ? (uint8_t)v : (uint8_t)(v >> 8));
+        }
+      } else {
+        fatal("unsupported vector load", n);
+      }
+      return;
+    }
+
+    if(n == "sbv" || n == "ssv" || n == "slv" || n == "sdv") {
+      dmemAccess(addr, scale, true);
+      for(uint32_t i=0; i<scale; ++i)writeByte(addr + i, vbyte(in.rt, e + i));
+    } else if(n == "sqv") {
+      uint32_t end = e + (16 - (addr & 15));
+      dmemAccess(addr, end - e, true);
+      for(uint32_t i=e; i<end; ++i)writeByte(addr++, vbyte(in.rt, i));
+    } else if(n == "srv") {
+      uint32_t end = e + (addr & 15);
+      uint32_t base = 16 - (addr & 15);
+      addr &= ~15u;
+      dmemAccess(addr, end - e, true);
+      for(uint32_t i=e; i<end; ++i)writeByte(addr++, vbyte(in.rt, i + base));
+    } else if(n == "spv" || n == "suv") {
+      dmemAccess(addr, 8, true);
+      bool packed = n == "spv";
+      for(uint32_t i=e; i<e+8; ++i) {
+        bool upper = (i & 15) < 8;
+        if(upper == packed) {
+          writeByte(addr++, vbyte(in.rt, (i & 7) << 1));
+        } else {
+          writeByte(addr++, (uint8_t)(vt[i & 7] >> 7));
+        }
+      }
+    } else if(n == "shv") {
+      uint32_t index = addr & 7;
+      addr &= ~7u;
+      dmemAccess(addr, 16, true);
+      for(uint32_t i=0; i<8; ++i) {
+        uint32_t b = e + i * 2;
+        uint8_t val = (uint8_t)((vbyte(in.rt, b) << 1) | (vbyte(in.rt, b + 1) >> 7));
+        writeByte(addr + ((index + i * 2) & 15), val);
+      }
+    } else {
+      fatal("unsupported vector store", n);
+    }
+  }
+
+  /* ---------------- Timing ---------------- */
+
+  bool isBranch(const Instr &in) {
+    Fmt f = in.op->fmt;
+    return f == Fmt::Br1 || f == Fmt::Br2 || f == Fmt::Jump || f == Fmt::Jr;
+  }
+
+  void issue(uint32_t idx) {
+    const Instr &in = code[idx];
+    Fmt f = in.op->fmt;
+    uint64_t ready = 0;
+    auto needG = [&](uint8_t r) { if(r)ready = std::max(ready, gprReady[r]); };
+    auto needV = [&](uint8_t r) { ready = std::max(ready, vprReady[r]); };
+
+    int writeG = -1, writeV = -1;
+    uint32_t latency = 1;
+    switch(f) {
+      case Fmt::R3: needG(in.rs); needG(in.rt); writeG = in.rd; break;
+      case Fmt::Shift: needG(in.rt); writeG = in.rd; break;
+      case Fmt::ShiftV: needG(in.rt); needG(in.rs); writeG = in.rd; break;
+      case Fmt::Imm: needG(in.rs); writeG = in.rt; break;
+      case Fmt::Lui: writeG = in.rt; break;
+      case Fmt::Mem:
+        needG(in.rs);
+        if(in.name[0] == 'l') { writeG = in.rt; latency = LATENCY_LOAD; } else { needG(in.rt); }
+        break;
+      case Fmt::Br2: needG(in.rs); needG(in.rt); break;
+      case Fmt::Br1: case Fmt::Jr: needG(in.rs); break;
+      case Fmt::Jump: if(in.name == "jal")writeG = 31; break;
+      case Fmt::Mfc0: writeG = in.rt; latency = LATENCY_COP; break;
+      case Fmt::Mtc0: needG(in.rt); break;
+      case Fmt::Mtc2: needG(in.rt); writeV = in.rd; latency = LATENCY_VECTOR; break;
+      case Fmt::Mfc2: needV(in.rd); writeG = in.rt; latency = LATENCY_COP; break;
+      case Fmt::Cfc2: writeG = in.rt; latency = LATENCY_COP; break;
+      case Fmt::Ctc2: needG(in.rt); break;
+      case Fmt::VOp: needV(in.rs); needV(in.rt); writeV = in.rd; latency = LATENCY_VECTOR; break;
+      case Fmt::VMov: needV(in.rt); writeV = in.rd; latency = LATENCY_VECTOR; break;
+      case Fmt::VMem:
+        needG(in.rs);
+        if(in.name[0] == 'l') { writeV = in.rt; latency = LATENCY_VECTOR; } else { needV(in.rt); }
+        break;
+      case Fmt::None: break;
+    }
+
+    uint64_t t;
+    bool canPair = lastInstr && !lastPaired && lastInstr->isVU != in.isVU
+      && !isBranch(*lastInstr) && ready <= cycle && stats.instructions > 0;
+    if(canPair) {
+      t = cycle;
+      lastPaired = true;
+      ++stats.dualIssued;
+    } else {
+      uint64_t next = stats.instructions > 0 ? cycle + 1 : cycle;
+      t = std::max(next, ready);
+      stats.stallCycles += t - next;
+      lastPaired = false;
+    }
+
+    cyclesPerInstr[idx] += t - cycle + (stats.instructions == 0 ? 1 : 0);
+    stats.cycles += t - cycle + (stats.instructions == 0 ? 1 : 0);
+    cycle = t;
+    lastInstr = &in;
+    ++stats.instructions;
+
+    if(writeG > 0)gprReady[writeG] = t + latency;
+    if(writeV >= 0)vprReady[writeV] = t + latency;
+  }
+
+  /* ---------------- Scalar unit ---------------- */
+
+  void execute(uint32_t &pc, uint32_t &npc) {
+    const Instr &in = code[pc];
+    runLine = in.line;
+    issue(pc);
+    finishDmas(cycle);
+
+    uint32_t nextNpc = npc + 1;
+    uint32_t rs = gpr[in.rs], rt = gpr[in.rt];
+    int32_t imm = (int32_t)(int16_t)in.imm;
+    uint32_t immU = (uint32_t)in.imm & 0xFFFF;
+    const std::string &n = in.name;
+    auto setG = [](uint8_t r, uint32_t v) { if(r)gpr[r] = v; };
+    auto branch = [&](bool cond) { if(cond)nextNpc = in.targetIdx; };
+
+    switch(in.op->fmt) {
+      case Fmt::None:
+        if(n == "break")fatal("break reached", "");
+        break;
+      case Fmt::R3:
+        if(n == "addu" || n == "add")setG(in.rd, rs + rt);
+        else if(n == "subu" || n == "sub")setG(in.rd, rs - rt);
+        else if(n == "and")setG(in.rd, rs & rt);
+        else if(n == "or")setG(in.rd, rs | rt);
+        else if(n == "xor")setG(in.rd, rs ^ rt);
+        else if(n == "nor")setG(in.rd, ~(rs | rt));
+        else if(n == "slt")setG(in.rd, (int32_t)rs < (int32_t)rt);
+        else setG(in.rd, rs < rt);
+        break;
+      case Fmt::Shift:
+        if(n == "sll")setG(in.rd, rt << in.imm);
+        else if(n == "srl")setG(in.rd, rt >> in.imm);
+        else setG(in.rd, (uint32_t)((int32_t)rt >> in.imm));
+        break;
+      case Fmt::ShiftV:
+        if(n == "sllv")setG(in.rd, rt << (rs & 31));
+        else if(n == "srlv")setG(in.rd, rt >> (rs & 31));
+        else setG(in.rd, (uint32_t)((int32_t)rt >> (rs & 31)));
+        break;
+      case Fmt::Imm:
+        if(n == "addiu" || n == "addi")setG(in.rt, rs + imm);
+        else if(n == "andi")setG(in.rt, rs & immU);
+        else if(n == "ori")setG(in.rt, rs | immU);
+        else if(n == "xori")setG(in.rt, rs ^ immU);
+        else if(n == "slti")setG(in.rt, (int32_t)rs < imm);
+        else setG(in.rt, rs < (uint32_t)imm);
+        break;
+      case Fmt::Lui: setG(in.rt, immU << 16); break;
+      case Fmt::Mem: {
+        uint32_t addr = rs + imm;
+        if(n == "lw")setG(in.rt, read(addr, 4));
+        else if(n == "lh")setG(in.rt, (uint32_t)(int16_t)read(addr, 2));
+        else if(n == "lhu")setG(in.rt, read(addr, 2));
+        else if(n == "lb")setG(in.rt, (uint32_t)(int8_t)read(addr, 1));
+        else if(n == "lbu")setG(in.rt, read(addr, 1));
+        else if(n == "sw")write(addr, 4, rt);
+        else if(n == "sh")write(addr, 2, rt);
+        else write(addr, 1, rt);
+        break;
+      }
+      case Fmt::Br2: branch(n == "beq" ? rs == rt : rs != rt); break;
+      case Fmt::Br1:
+        if(n == "blez")branch((int32_t)rs <= 0);
+        else if(n == "bgtz")branch((int32_t)rs > 0);
+        else if(n == "bltz")branch((int32_t)rs < 0);
+        else branch((int32_t)rs >= 0);
+        break;
+      case Fmt::Jump:
+        if(n == "jal")gpr[31] = (npc + 1) * 4;
+        nextNpc = in.targetIdx;
+        break;
+      case Fmt::Jr: nextNpc = rs / 4; break;
+      case Fmt::Mfc0:
+        if(in.imm == 5)setG(in.rt, dmas.size() >= 2); // DMA_FULL
+        else if(in.imm == 6)setG(in.rt, !dmas.empty()); // DMA_BUSY
+        else fatal("unsupported COP0 read", std::to_string(in.imm));
+        break;
+      case Fmt::Mtc0:
+        if(in.imm == 0)dmaSpAddr = rt;
+        else if(in.imm == 1)dmaRamAddr = rt;
+        else if(in.imm == 2 || in.imm == 3)startDma(rt, in.imm == 2);
+        else fatal("unsupported COP0 write", std::to_string(in.imm));
+        break;
+      case Fmt::Mtc2:
+        setVbyte(vpr[in.rd], in.e, (uint8_t)(rt >> 8));
+        if(in.e != 15)setVbyte(vpr[in.rd], in.e + 1, (uint8_t)rt);
+        break;
+      case Fmt::Mfc2:
+        setG(in.rt, (uint32_t)(int16_t)((vbyte(in.rd, in.e) << 8) | vbyte(in.rd, in.e + 1)));
+        break;
+      case Fmt::Cfc2:
+        if(in.imm == 0)setG(in.rt, (uint32_t)(int16_t)vco);
+        else if(in.imm == 1)setG(in.rt, (uint32_t)(int16_t)vcc);
+        else setG(in.rt, vce);
+        break;
+      case Fmt::Ctc2:
+        if(in.imm == 0)vco = (uint16_t)rt;
+        else if(in.imm == 1)vcc = (uint16_t)rt;
+        else vce = (uint8_t)rt;
+        break;
+      case Fmt::VOp: execVector(in); break;
+      case Fmt::VMov: {
+        uint16_t val = vpr[in.rt][broadcast(in.e, in.de)];
+        for(int i=0; i<8; ++i)accL[i] = vpr[in.rt][broadcast(in.e, i)];
+        vpr[in.rd][in.de] = val;
+        break;
+      }
+      case Fmt::VMem: execVectorMem(in); break;
+    }
+
+    pc = npc;
+    npc = nextNpc;
+  }
+
+  void initVectorConstants() {
+    // VSHIFT and VSHIFT8, set up by rspq
+    for(int i=0; i<8; ++i) {
+      vpr[30][i] = (uint16_t)(0x80 >> i);
+      vpr[31][i] = (uint16_t)(0x8000 >> i);
+    }
+  }
+}
+
+bool HostRsp::load(const char *path)
+{
+  FILE *fp = fopen(path, "r");
+  if(!fp) {
+    fprintf(stderr, "RSP: can't open '%s'\n", path);
+    return false;
+  }
+
+  symbols.clear();
+  labels.clear();
+  defines.clear();
+  symbols["RSPQ_SCRATCH_MEM"] = RSPQ_SCRATCH_ADDR;
+  symbols["COP0_DMA_SPADDR"] = 0;
+  symbols["COP0_DMA_RAMADDR"] = 1;
+  symbols["COP0_DMA_READ"] = 2;
+  symbols["COP0_DMA_WRITE"] = 3;
+  symbols["COP0_DMA_FULL"] = 5;
+  symbols["COP0_DMA_BUSY"] = 6;
+
+  std::vector<PendingLine> lines{};
+  std::vector<bool> skipStack{};
+  char buff[1024];
+  int lineNum = 0;
+  while(fgets(buff, sizeof(buff), fp)) {
+    ++lineNum;
+    std::string l = buff;
+    size_t comment = l.find("##");
+    if(comment != std::string::npos)l = l.substr(0, comment);
+    l = trim(l);
+    if(l.empty())continue;
+
+    // preprocessor, only what the ucode files use
+    if(l[0] == '#') {
+      std::string dir = l.substr(1, l.find_first_of(" \t") - 1);
+      std::string rest = l.find_first_of(" \t") == std::string::npos ? "" : trim(l.substr(l.find_first_of(" \t")));
+      bool skipping = !skipStack.empty() && skipStack.back();
+      if(dir == "if" || dir == "ifdef" || dir == "ifndef") {
+        int64_t val = 0;
+        bool isDefined = defines.count(rest) > 0;
+        bool cond = dir == "ifdef" ? isDefined : dir == "ifndef" ? !isDefined : (evalExpr(rest, val, true) && val != 0);
+        skipStack.push_back(skipping || !cond);
+      } else if(dir == "else") {
+        bool parentSkip = skipStack.size() > 1 && skipStack[skipStack.size() - 2];
+        skipStack.back() = parentSkip || !skipStack.back();
+      } else if(dir == "endif") {
+        if(!skipStack.empty())skipStack.pop_back();
+      } else if(dir == "define" && !skipping) {
+        size_t sp = rest.find_first_of(" \t");
+        std::string name = rest.substr(0, sp);
+        std::string value = sp == std::string::npos ? "1" : trim(rest.substr(sp));
+        if(value[0] != '$')defines[name] = value; // register aliases are not needed
+      }
+      continue;
+    }
+    if(!skipStack.empty() && skipStack.back())continue;
+    lines.push_back({l, lineNum});
+  }
+  fclose(fp);
+
+  if(!assemble(lines))return false;
+
+  memcpy(dmem, dmemInit.data(), DMEM_SIZE);
+  memset(gpr, 0, sizeof(gpr));
+  memset(vpr, 0, sizeof(vpr));
+  initVectorConstants();
+  dmas.clear();
+  cycle = 0;
+  memset(gprReady, 0, sizeof(gprReady));
+  memset(vprReady, 0, sizeof(vprReady));
+  cyclesPerInstr.assign(code.size(), 0);
+  resetStats();
+  return true;
+}
+
+uint32_t HostRsp::getSymbol(const char *name)
+{
+  auto sym = symbols.find(name);
+  if(sym != symbols.end())return sym->second;
+  auto label = labels.find(name);
+  if(label != labels.end())return label->second;
+  fatal("unknown symbol", name);
+}
+
+uint32_t HostRsp::getDmemEnd() { return dmemEnd; }
+uint8_t* HostRsp::getRdram() { return rdram.data(); }
+uint8_t* HostRsp::getDmem() { return dmem; }
+
+void HostRsp::run(uint32_t cmd, std::initializer_list<uint32_t> args)
+{
+  if(cmd >= commands.size())fatal("unknown command", std::to_string(cmd));
+  assert(args.size() <= 4);
+
+  // rspq hands over the command words in a0-a3, the first one has the overlay and command ID in its top byte.
+  // Anything else is left from earlier commands, so fill it with a pattern
+  for(int r=1; r<32; ++r)gpr[r] = 0xBAADF00D;
+  uint32_t regs[4]{0, 0, 0, 0};
+  uint32_t i = 0;
+  for(auto a : args)regs[i++] = a;
+  regs[0] = (regs[0] & 0xFFFFFF) | ((0x20 | cmd) << 24);
+  for(int r=0; r<4; ++r)gpr[4 + r] = regs[r];
+
+  uint32_t pc = commands[cmd];
+  uint32_t npc = pc + 1;
+  lastInstr = nullptr;
+  while(pc != EXIT_TARGET) {
+    if(pc >= code.size())fatal("ran past the end of the code", std::to_string(pc));
+    execute(pc, npc);
+  }
+}
+
+void HostRsp::sync()
+{
+  if(!dmas.empty()) {
+    uint64_t end = dmas.back().end;
+    stats.cycles += end > cycle ? end - cycle : 0;
+    cycle = std::max(cycle, end);
+  }
+  finishDmas(UINT64_MAX);
+}
+
+HostRsp::Stats& HostRsp::getStats() { return stats; }
+
+void HostRsp::resetStats()
+{
+  stats = {};
+  std::fill(cyclesPerInstr.begin(), cyclesPerInstr.end(), 0);
+}
+
+uint64_t HostRsp::getCycles(const char *labelStart, const char *labelEnd)
+{
+  uint32_t start = getSymbol(labelStart);
+  uint32_t end = getSymbol(labelEnd);
+  uint64_t sum = 0;
+  for(uint32_t i=start; i<end && i<code.size(); ++i)sum += cyclesPerInstr[i];
+  return sum;
+}
@@ -0,0 +1,53 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <cstdint>
+#include <initializer_list>
+
+/**
+ * Host interpreter for RSP overlays, used to test ucode against a CPU reference.
+ * Assembles the '.S' files of this repo (RSPL output or hand-written, GNU as syntax using the
+ * 'rsp_queue.inc' conventions) and runs single commands on a 4KB DMEM and a flat 8MB RDRAM.
+ *
+ * DMAs land after an estimated number of cycles, accessing DMEM that a running DMA still works on
+ * counts as a hazard. Cycles follow a simple dual-issue pipeline model (see 'rsp_host.cpp'),
+ * they are meant to compare two versions of a ucode and don't replace measurements on hardware.
+ * Vector registers keep their state between commands, like on hardware.
+ */
+namespace HostRsp
+{
+  constexpr uint32_t RDRAM_SIZE = 8 * 1024 * 1024;
+  constexpr uint32_t DMEM_SIZE = 4096;
+
+  struct Stats {
+    uint64_t cycles{};
+    uint64_t instructions{};
+    uint64_t dualIssued{};
+    uint64_t stallCycles{};
+    uint32_t dmaCount{};
+    uint32_t dmaHazards{}; // DMEM accessed while a DMA on it was still running
+  };
+
+  // Assembles the ucode, prints the line and returns false on errors
+  bool load(const char *path);
+  // Address of a DMEM symbol or index of a code label, asserts if missing
+  uint32_t getSymbol(const char *name);
+  // First free byte after the overlay's data and bss
+  uint32_t getDmemEnd();
+
+  // RDRAM is big-endian like on the N64, addresses are the lower 24 bits
+  uint8_t* getRdram();
+  uint8_t* getDmem();
+
+  // Runs command 'cmd' of the overlay until it jumps back to 'RSPQ_Loop', 'args' are the command words
+  void run(uint32_t cmd, std::initializer_list<uint32_t> args);
+  // Waits for all pending DMAs
+  void sync();
+
+  Stats& getStats();
+  void resetStats();
+  // Cycles spent in the code from one label up to another one, since the last reset
+  uint64_t getCycles(const char *labelStart, const char *labelEnd);
+}
@@ -0,0 +1,22 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <libdragon.h>
+
+// Host replacement for <rspq_profile.h>, there is no RSP so all slots stay empty
+#define RSPQ_PROFILE_SLOT_COUNT 16
+
+typedef struct {
+  const char *name;
+  uint64_t total_ticks;
+  uint64_t sample_count;
+} rspq_profile_slot_t;
+
+typedef struct {
+  rspq_profile_slot_t slots[RSPQ_PROFILE_SLOT_COUNT];
+  uint64_t total_ticks;
+  uint64_t rdp_busy_ticks;
+  uint64_t frame_count;
+} rspq_profile_data_t;
@@ -0,0 +1,237 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+
+/**
+ * Host test of the animation update-rate LOD ('t3danimlod.h').
+ * A crowd of 'cath.t3dm' instances is placed at different distances, with a random frame time,
+ * and compared against the same animation updated every frame.
+ *
+ * Checks:
+ * - the level follows the distance/screen-size thresholds
+ * - the round-robin spreads the updates: every frame evaluates the same number of instances,
+ *   and each instance is evaluated exactly every '1 << level' frames
+ * - no time is lost, after each update the animation time matches the full-rate one
+ * - interpolated frames draw the 16.16 lerp from the previous towards the latest pose
+ * - going back to full rate in the middle of an interpolation draws the current pose in every buffer,
+ *   even for bones that no longer change
+ *
+ * Usage: test_animlod [model=build_host/filesystem/cath.t3dm] [instances=16] [frames=480] [seed=1]
+ */
+#include <libdragon.h>
+#include <t3d/t3danimlod.h>
+#include "host/model_host.h"
+#include "host/rom_host.h"
+#include <random>
+#include <vector>
+
+namespace
+{
+  constexpr int BUFFER_COUNT = 3;
+  constexpr float TIME_EPSILON = 1e-3f;
+
+  const T3DAnimLodConf LOD_CONF{
+    .distance = {100.0f, 200.0f, 400.0f},
+    .screenSize = {0.0f, 40.0f, 0.0f},
+    .interpolate = true,
+  };
+
+  int errors = 0;
+
+  void fail(const char* msg, uint32_t frame, uint32_t inst) {
+    if(errors < 16)printf("FAIL: %s (frame %u, instance %u)\n", msg, frame, inst);
+    ++errors;
+  }
+
+  int32_t toFixed(int16_t i, uint16_t f) { return (int32_t)(((uint32_t)(uint16_t)i << 16) | f); }
+
+  void toPalette(const T3DSkeleton &skel, std::vector<T3DMat4FP> &res) {
+    for(uint32_t i=0; i<res.size(); ++i)t3d_mat4_to_fixed_3x4(&res[i], &skel.bones[i].matrix);
+  }
+
+  // Independent version of the lerp in 't3danimlod.c', 'factor' is in 1/256 steps
+  bool isLerp(const T3DMat4FP *res, const std::vector<T3DMat4FP> &a, const std::vector<T3DMat4FP> &b, int32_t factor) {
+    for(uint32_t m=0; m<a.size(); ++m) {
+      for(int y=0; y<4; ++y) {
+        for(int x=0; x<4; ++x) {
+          int64_t valA = toFixed(a[m].m[y].i[x], a[m].m[y].f[x]);
+          int64_t valB = toFixed(b[m].m[y].i[x], b[m].m[y].f[x]);
+          int64_t expected = valA + (((valB - valA) * factor) >> 8);
+          if(toFixed(res[m].m[y].i[x], res[m].m[y].f[x]) != (int32_t)expected)return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  struct Instance {
+    T3DSkeleton skel;
+    T3DAnim anim;
+    T3DAnimLodInst lod;
+    T3DAnim animRef; // same animation at full rate, only to compare the time
+    T3DSkeleton skelRef;
+    float distance;
+    uint32_t lastUpdate;
+    bool hasPose; // evaluated at least once
+    std::vector<T3DMat4FP> palettePrev{};
+    std::vector<T3DMat4FP> paletteLatest{};
+  };
+
+  // Interpolates an instance for a few frames, then switches to full rate with the animation paused.
+  // Nothing changes anymore, so only the LOD can make the skeleton replace the interpolated matrices.
+  void testLeaveInterpolation(T3DModel *model, const char* clip, uint32_t boneCount) {
+    T3DAnimLod lod = t3d_anim_lod_create(&LOD_CONF);
+    T3DSkeleton skel = t3d_skeleton_create_buffered(model, BUFFER_COUNT);
+    T3DAnim anim = t3d_anim_create(model, clip);
+    t3d_anim_attach(&anim, &skel);
+    T3DAnimLodInst inst = t3d_anim_lod_inst_create(&lod, &skel);
+    std::vector<T3DMat4FP> palette(boneCount);
+
+    constexpr uint32_t FRAMES_FAR = 8 * 3 + 3; // ends between two updates at the 1/8 rate
+    for(uint32_t f=0; f<FRAMES_FAR + BUFFER_COUNT * 2; ++f) {
+      bool isFar = f < FRAMES_FAR;
+      float deltaTime = 1.0f / 30.0f;
+      t3d_anim_lod_begin_frame(&lod);
+      bool doUpdate = t3d_anim_lod_should_update(&lod, &inst, &deltaTime, isFar ? 500.0f : 50.0f, 0.0f);
+      if(doUpdate && isFar)t3d_anim_update(&anim, deltaTime);
+      t3d_anim_lod_update_skeleton(&lod, &inst, &skel, doUpdate);
+      if(isFar)continue;
+
+      toPalette(skel, palette);
+      const T3DMat4FP *drawn = &skel.boneMatricesFP[skel.currentBufferIdx * boneCount];
+      if(!isLerp(drawn, palette, palette, 0))fail("full rate after interpolating draws a stale pose", f, 0);
+    }
+
+    t3d_anim_lod_inst_destroy(&inst);
+    t3d_anim_destroy(&anim);
+    t3d_skeleton_destroy(&skel);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  const char* path = argc > 1 ? argv[1] : "build_host/filesystem/cath.t3dm";
+  uint32_t instCount = argc > 2 ? (uint32_t)atoi(argv[2]) : 16;
+  uint32_t frames = argc > 3 ? (uint32_t)atoi(argv[3]) : 480;
+  uint32_t seed = argc > 4 ? (uint32_t)atoi(argv[4]) : 1;
+
+  HostRom::mount("build_host/filesystem");
+  HostRom::setSwap16(true);
+  T3DModel *model = HostModel::load(path);
+  if(!model) {
+    printf("Failed to load model: %s\n", path);
+    return 1;
+  }
+
+  std::vector<T3DChunkAnim*> clips(t3d_model_get_animation_count(model));
+  t3d_model_get_animations(model, clips.data());
+  uint32_t boneCount = t3d_model_get_skeleton(model)->boneCount;
+
+  T3DAnimLod lod = t3d_anim_lod_create(&LOD_CONF);
+
+  // levels
+  struct { float dist, size; uint32_t level; } levelTests[]{
+    {50.0f, 0.0f, 0}, {100.0f, 0.0f, 1}, {250.0f, 0.0f, 2}, {1000.0f, 0.0f, 3},
+    {50.0f, 80.0f, 0}, {50.0f, 20.0f, 2}, {250.0f, 20.0f, 2}, {450.0f, 20.0f, 3},
+  };
+  for(auto &t : levelTests) {
+    if(t3d_anim_lod_get_level(&lod, t.dist, t.size) != t.level)fail("wrong level", 0, (uint32_t)t.dist);
+  }
+
+  testLeaveInterpolation(model, clips[0]->name, boneCount);
+
+  // the crowd, a quarter per distance band
+  const float distances[]{50.0f, 150.0f, 250.0f, 500.0f};
+  std::vector<Instance> instances(instCount);
+  for(uint32_t i=0; i<instCount; ++i) {
+    Instance &inst = instances[i];
+    const char* clip = clips[i % clips.size()]->name;
+    inst.skel = t3d_skeleton_create_buffered(model, BUFFER_COUNT);
+    inst.anim = t3d_anim_create(model, clip);
+    t3d_anim_attach(&inst.anim, &inst.skel);
+    inst.skelRef = t3d_skeleton_create(model);
+    inst.animRef = t3d_anim_create(model, clip);
+    t3d_anim_attach(&inst.animRef, &inst.skelRef);
+    inst.lod = t3d_anim_lod_inst_create(&lod, &inst.skel);
+    inst.distance = distances[(i / 4) % 4];
+    inst.palettePrev.resize(boneCount);
+    inst.paletteLatest.resize(boneCount);
+  }
+
+  std::mt19937 rng{seed};
+  std::uniform_real_distribution<float> frameTime{1.0f / 60.0f, 1.0f / 20.0f};
+  std::vector<uint32_t> updatesPerLevel(T3D_ANIM_LOD_LEVELS + 1);
+  std::vector<uint32_t> minPerFrame(T3D_ANIM_LOD_LEVELS + 1, UINT32_MAX), maxPerFrame(T3D_ANIM_LOD_LEVELS + 1);
+  uint32_t interpolatedFrames = 0;
+
+  for(uint32_t f=0; f<frames; ++f) {
+    float deltaTime = frameTime(rng);
+    t3d_anim_lod_begin_frame(&lod);
+    std::vector<uint32_t> updatesThisFrame(T3D_ANIM_LOD_LEVELS + 1);
+
+    for(uint32_t i=0; i<instCount; ++i) {
+      Instance &inst = instances[i];
+      t3d_anim_update(&inst.animRef, deltaTime);
+
+      float instDelta = deltaTime;
+      bool doUpdate = t3d_anim_lod_should_update(&lod, &inst.lod, &instDelta, inst.distance, 0.0f);
+      uint32_t level = inst.lod.level;
+
+      if(doUpdate) {
+        ++updatesThisFrame[level];
+        ++updatesPerLevel[level];
+        if(inst.hasPose && f - inst.lastUpdate != (1u << level))fail("update interval does not match the level", f, i);
+        inst.lastUpdate = f;
+        t3d_anim_update(&inst.anim, instDelta);
+        if(fabsf(inst.anim.time - inst.animRef.time) > TIME_EPSILON)fail("animation time was lost", f, i);
+      }
+      t3d_anim_lod_update_skeleton(&lod, &inst.lod, &inst.skel, doUpdate);
+      if(doUpdate && level == 0)inst.hasPose = true;
+
+      const T3DMat4FP *drawn = &inst.skel.boneMatricesFP[inst.skel.currentBufferIdx * boneCount];
+      if(level == 0) {
+        toPalette(inst.skel, inst.paletteLatest);
+        if(!isLerp(drawn, inst.paletteLatest, inst.paletteLatest, 0))fail("full rate does not draw the current pose", f, i);
+        continue;
+      }
+
+      if(doUpdate) {
+        // the first pose has nothing to interpolate from
+        inst.palettePrev = inst.paletteLatest;
+        toPalette(inst.skel, inst.paletteLatest);
+        if(!inst.hasPose)inst.palettePrev = inst.paletteLatest;
+        inst.hasPose = true;
+      }
+      if(!inst.hasPose)continue;
+
+      int32_t factor = ((f - inst.lastUpdate) << 8) >> level;
+      if(!isLerp(drawn, inst.palettePrev, inst.paletteLatest, factor))fail("interpolated pose is wrong", f, i);
+      if(factor != 0)++interpolatedFrames;
+    }
+
+    for(uint32_t l=0; l<=T3D_ANIM_LOD_LEVELS; ++l) {
+      if(updatesThisFrame[l] < minPerFrame[l])minPerFrame[l] = updatesThisFrame[l];
+      if(updatesThisFrame[l] > maxPerFrame[l])maxPerFrame[l] = updatesThisFrame[l];
+    }
+  }
+
+  // each band has the same number of instances, so every frame should see the same share of them
+  for(uint32_t l=0; l<=T3D_ANIM_LOD_LEVELS; ++l) {
+    if(maxPerFrame[l] - minPerFrame[l] > 1)fail("updates are not spread across frames", l, maxPerFrame[l]);
+    printf("Level %u: %.2f updates per frame (min %u, max %u)\n",
+      l, (double)updatesPerLevel[l] / frames, minPerFrame[l], maxPerFrame[l]);
+  }
+  printf("Instances: %u, frames: %u, interpolated draws: %u\n", instCount, frames, interpolatedFrames);
+  printf("Errors: %d\n", errors);
+
+  for(auto &inst : instances) {
+    t3d_anim_lod_inst_destroy(&inst.lod);
+    t3d_anim_destroy(&inst.anim);
+    t3d_anim_destroy(&inst.animRef);
+    t3d_skeleton_destroy(&inst.skel);
+    t3d_skeleton_destroy(&inst.skelRef);
+  }
+  HostModel::free(model);
+  return errors ? 1 : 0;
+}
@@ -0,0 +1,319 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+
+/**
+ * Host test of the PI DMA keyframe streaming in 't3danim.c'.
+ * Each instance plays a clip of 'cath.t3dm' through the streamed 'T3DAnim', and the same clip
+ * through 'FileAnim', which reads the keyframes with 'fread' like 't3danim.c' did before streaming.
+ * Instances have random clips, speeds and start times, jump around with 't3d_anim_set_time',
+ * and get destroyed/re-created while their DMAs may still be running.
+ * The emulated DMA only lands after a random number of polls, and fills the target before that.
+ * A poll happens about once per 't3d_anim_update', so the DMA is much slower than on hardware
+ * and most prefetches are waited for, which is the harder case for the stream.
+ *
+ * Checks:
+ * - both produce bit-identical bones in every frame, for 1 to 20 instances
+ * - at a steady 30fps and a realistic latency (done by the next poll) no update waits for a DMA
+ * - compressed files are read in full with the asset reader, without any DMA
+ *
+ * Usage: test_animstream [model=build_host/filesystem/cath.t3dm] [frames=600] [seed=1]
+ */
+#include <libdragon.h>
+#include <t3d/t3danim.h>
+#include "host/model_host.h"
+#include "host/rom_host.h"
+#include <random>
+#include <vector>
+
+namespace
+{
+  constexpr uint32_t MAX_INSTANCES = 20;
+  constexpr uint32_t MAX_LATENCY = 12;
+  constexpr float SQRT_2_INV = 0.70710678118f;
+  constexpr float KF_TIME_TICK = 1.0f / 60.0f;
+  constexpr uint32_t SRT_SIZE = sizeof(T3DVec3) + sizeof(T3DQuat) + sizeof(T3DVec3);
+
+  struct Keyframe {
+    uint16_t nextTime;
+    uint16_t channelIdx;
+    uint16_t data[2];
+  };
+
+  /**
+   * Reference player, reads the keyframes from the file as they are needed.
+   */
+  struct FileAnim {
+    const T3DChunkAnim *animRef{};
+    FILE *file{};
+    std::vector<T3DAnimTargetQuat> targetsQuat{};
+    std::vector<T3DAnimTargetScalar> targetsScalar{};
+    float time{};
+    float speed{1.0f};
+    uint32_t nextKfSize{sizeof(Keyframe)};
+
+    FileAnim(const T3DModel *model, const char *name, const T3DSkeleton &skel) {
+      animRef = t3d_model_get_animation(model, name);
+      file = asset_fopen(animRef->filePath, nullptr);
+      targetsQuat.resize(animRef->channelsQuat);
+      targetsScalar.resize(animRef->channelsScalar);
+
+      uint32_t idxQuat = 0, idxScalar = 0;
+      for(uint32_t i=0; i<(uint32_t)(animRef->channelsQuat + animRef->channelsScalar); ++i) {
+        const T3DAnimChannelMapping &map = animRef->channelMappings[i];
+        T3DBone &bone = skel.bones[map.targetIdx];
+        if(map.targetType == T3D_ANIM_TARGET_ROTATION) {
+          targetsQuat[idxQuat].targetQuat = &bone.rotation;
+          targetsQuat[idxQuat++].base.changedFlag = &bone.hasChanged;
+        } else {
+          T3DVec3 &vec = map.targetType == T3D_ANIM_TARGET_TRANSLATION ? bone.position : bone.scale;
+          targetsScalar[idxScalar].targetScalar = &vec.v[map.attributeIdx];
+          targetsScalar[idxScalar++].base.changedFlag = &bone.hasChanged;
+        }
+      }
+      rewindAnim();
+    }
+
+    ~FileAnim() { fclose(file); }
+
+    void rewindAnim() {
+      for(auto &t : targetsQuat)t.base.timeEnd = 0;
+      for(auto &t : targetsScalar)t.base.timeEnd = 0;
+      nextKfSize = sizeof(Keyframe);
+      rewind(file);
+    }
+
+    T3DAnimTargetBase* getTarget(uint32_t channelIdx) {
+      if(channelIdx < animRef->channelsQuat)return &targetsQuat[channelIdx].base;
+      return &targetsScalar[channelIdx - animRef->channelsQuat].base;
+    }
+
+    static float s10ToFloat(uint32_t value, float offset, float scale) {
+      return (float)value / 1023.0f * scale + offset;
+    }
+
+    static void unpackQuat(uint16_t dataHi, uint16_t dataLo, T3DQuat *out) {
+      int largestIdx = dataHi >> 14;
+      int idx0 = (largestIdx + 1) & 0b11;
+      int idx1 = (largestIdx + 2) & 0b11;
+      int idx2 = (largestIdx + 3) & 0b11;
+
+      uint16_t dataMid = (dataHi << 6) | (dataLo >> 10);
+      float q0 = s10ToFloat((dataHi >> 4) & 0x3FF, -SQRT_2_INV, SQRT_2_INV+SQRT_2_INV);
+      float q1 = s10ToFloat((dataMid    ) & 0x3FF, -SQRT_2_INV, SQRT_2_INV+SQRT_2_INV);
+      float q2 = s10ToFloat((dataLo     ) & 0x3FF, -SQRT_2_INV, SQRT_2_INV+SQRT_2_INV);
+
+      out->v[idx0] = q0;
+      out->v[idx1] = q1;
+      out->v[idx2] = q2;
+      out->v[largestIdx] = sqrtf(1.0f - q0*q0 - q1*q1 - q2*q2);
+    }
+
+    bool loadKeyframe() {
+      Keyframe kf{};
+      if(fread(&kf, nextKfSize, 1, file) != 1)return false; // swapped by the host ROM, like on the N64
+
+      bool isLarge = kf.nextTime & 0x8000;
+      nextKfSize = isLarge ? sizeof(Keyframe) : (sizeof(Keyframe)-2);
+      kf.nextTime &= 0x7FFF;
+
+      const T3DAnimChannelMapping &map = animRef->channelMappings[kf.channelIdx];
+      T3DAnimTargetBase *target = getTarget(kf.channelIdx);
+      target->timeStart = target->timeEnd;
+      target->timeEnd += (float)kf.nextTime * KF_TIME_TICK;
+      if(kf.nextTime == 0)target->timeStart -= 0.00001f;
+
+      if(map.targetType == T3D_ANIM_TARGET_ROTATION) {
+        auto t = (T3DAnimTargetQuat*)target;
+        t->kfCurr = t->kfNext;
+        unpackQuat(kf.data[0], kf.data[1], &t->kfNext);
+      } else {
+        auto t = (T3DAnimTargetScalar*)target;
+        t->kfCurr = t->kfNext;
+        t->kfNext = (float)kf.data[0] * map.quantScale + map.quantOffset;
+      }
+      return true;
+    }
+
+    void update(float deltaTime) {
+      int32_t updateFlag = 1;
+      time += deltaTime * speed;
+      if(time >= animRef->duration) {
+        time -= animRef->duration;
+        rewindAnim();
+        updateFlag = 2;
+      }
+
+      uint32_t channelCount = animRef->channelsQuat + animRef->channelsScalar;
+      for(uint32_t c=0; c<channelCount; ++c) {
+        bool isRot = c < animRef->channelsQuat;
+        T3DAnimTargetBase *target = getTarget(c);
+        while(time >= target->timeEnd) {
+          if(!loadKeyframe())break;
+        }
+
+        float interp = (time - target->timeStart) / (target->timeEnd - target->timeStart);
+        *target->changedFlag = updateFlag;
+        if(isRot) {
+          auto t = (T3DAnimTargetQuat*)target;
+          t3d_quat_nlerp(t->targetQuat, &t->kfCurr, &t->kfNext, interp);
+        } else {
+          auto t = (T3DAnimTargetScalar*)target;
+          *t->targetScalar = t3d_lerp(t->kfCurr, t->kfNext, interp);
+        }
+      }
+    }
+
+    void setTime(float newTime) {
+      if(newTime > animRef->duration)newTime = animRef->duration;
+      if(newTime < time)rewindAnim();
+      time = newTime;
+    }
+  };
+
+  struct Instance {
+    T3DSkeleton skel;
+    T3DSkeleton skelRef;
+    T3DAnim anim;
+    FileAnim *animRef;
+  };
+
+  void createInstance(Instance &inst, const T3DModel *model, const char *clip, float speed, float time) {
+    inst.anim = t3d_anim_create(model, clip);
+    t3d_anim_attach(&inst.anim, &inst.skel);
+    t3d_anim_set_speed(&inst.anim, speed);
+    inst.animRef = new FileAnim(model, clip, inst.skelRef);
+    inst.animRef->speed = speed;
+    t3d_anim_set_time(&inst.anim, time);
+    inst.animRef->setTime(time);
+  }
+
+  void destroyInstance(Instance &inst) {
+    t3d_anim_destroy(&inst.anim);
+    delete inst.animRef;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  const char* path = argc > 1 ? argv[1] : "build_host/filesystem/cath.t3dm";
+  uint32_t frames = argc > 2 ? (uint32_t)atoi(argv[2]) : 600;
+  uint32_t seed = argc > 3 ? (uint32_t)atoi(argv[3]) : 1;
+
+  HostRom::mount("build_host/filesystem");
+  HostRom::setSwap16(true);
+  T3DModel *model = HostModel::load(path);
+  if(!model) {
+    printf("Failed to load model: %s\n", path);
+    return 1;
+  }
+
+  std::vector<T3DChunkAnim*> clips(t3d_model_get_animation_count(model));
+  t3d_model_get_animations(model, clips.data());
+  uint32_t boneCount = t3d_model_get_skeleton(model)->boneCount;
+
+  std::mt19937 rng{seed};
+  auto randFloat = [&](float min, float max) { return std::uniform_real_distribution<float>{min, max}(rng); };
+  auto randInt = [&](uint32_t max) { return std::uniform_int_distribution<uint32_t>{0, max - 1}(rng); };
+
+  int errors = 0;
+  uint32_t jumpCount = 0, recreateCount = 0;
+
+  // plays 'instCount' instances for all frames, returns how often an update waited for a DMA
+  // without a jump or re-creation of that instance right before it.
+  // A steady pass runs at 30fps without any jumps or re-creations.
+  auto runPass = [&](uint32_t instCount, uint32_t latency, bool isSteady) {
+    HostRom::setLatency(latency);
+    HostRom::getStats() = {};
+    uint32_t otherWaits = 0;
+
+    std::vector<Instance> instances(instCount);
+    for(auto &inst : instances) {
+      inst.skel = t3d_skeleton_create(model);
+      inst.skelRef = t3d_skeleton_create(model);
+      createInstance(inst, model, clips[randInt(clips.size())]->name, randFloat(0.5f, 2.0f), 0.0f);
+    }
+
+    uint32_t instErrors = 0;
+    for(uint32_t f=0; f<frames; ++f) {
+      float deltaTime = isSteady ? (1.0f / 30.0f) : randFloat(1.0f / 60.0f, 1.0f / 20.0f);
+
+      for(uint32_t i=0; i<instCount; ++i) {
+        Instance &inst = instances[i];
+        uint32_t waitsBefore = HostRom::getStats().waitCount;
+        uint32_t event = isSteady ? 2 : randInt(200);
+        if(event == 0) {
+          // jump anywhere, backwards needs a rewind, forwards skips keyframes
+          float time = randFloat(0.0f, inst.anim.animRef->duration);
+          t3d_anim_set_time(&inst.anim, time);
+          inst.animRef->setTime(time);
+          ++jumpCount;
+        } else if(event == 1) {
+          // the stream may still have DMAs queued or running
+          destroyInstance(inst);
+          t3d_skeleton_reset(&inst.skel);
+          t3d_skeleton_reset(&inst.skelRef);
+          createInstance(inst, model, clips[randInt(clips.size())]->name, randFloat(0.5f, 2.0f),
+            randFloat(0.0f, 1.0f));
+          ++recreateCount;
+        }
+
+        t3d_anim_update(&inst.anim, deltaTime);
+        inst.animRef->update(deltaTime);
+        if(event > 1)otherWaits += HostRom::getStats().waitCount - waitsBefore;
+
+        for(uint32_t b=0; b<boneCount; ++b) {
+          if(memcmp(inst.skel.bones[b].scale.v, inst.skelRef.bones[b].scale.v, SRT_SIZE) != 0) {
+            if(errors < 16)printf("FAIL: bone %u differs (%u instances, frame %u, instance %u)\n", b, instCount, f, i);
+            ++errors;
+            ++instErrors;
+            break;
+          }
+        }
+      }
+    }
+
+    auto &stats = HostRom::getStats();
+    printf("Instances: %2u, DMA latency: %2u polls, DMAs: %5u (%4u KB), waited for: %4u (%4u outside of jumps), errors: %u\n",
+      instCount, latency, stats.dmaCount, stats.dmaBytes / 1024, stats.waitCount, otherWaits, instErrors);
+
+    for(auto &inst : instances) {
+      destroyInstance(inst);
+      t3d_skeleton_destroy(&inst.skel);
+      t3d_skeleton_destroy(&inst.skelRef);
+    }
+    return otherWaits;
+  };
+
+  // slow DMAs, most prefetches are waited for
+  for(uint32_t instCount=1; instCount<=MAX_INSTANCES; ++instCount) {
+    runPass(instCount, randInt(MAX_LATENCY + 1), false);
+  }
+
+  // realistic DMAs, done by the next poll: without jumps or re-creations every page is prefetched in time
+  printf("Steady 30fps, realistic latency:\n");
+  for(uint32_t instCount : {1u, 8u, MAX_INSTANCES}) {
+    if(runPass(instCount, 1, true) != 0) {
+      printf("FAIL: update waited for a prefetch (%u instances)\n", instCount);
+      ++errors;
+    }
+  }
+
+  // compressed files can't be streamed with DMAs, they have to be read in full
+  printf("Compressed:\n");
+  HostRom::setCompressed(true);
+  for(uint32_t instCount : {1u, MAX_INSTANCES}) {
+    runPass(instCount, 1, false);
+    if(HostRom::getStats().dmaCount != 0) {
+      printf("FAIL: compressed animation was read with DMAs (%u instances)\n", instCount);
+      ++errors;
+    }
+  }
+  HostRom::setCompressed(false);
+
+  printf("Frames: %u, jumps: %u, re-created: %u\n", frames, jumpCount, recreateCount);
+  printf("Errors: %d\n", errors);
+  HostModel::free(model);
+  return errors ? 1 : 0;
+}
@@ -0,0 +1,224 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+
+/**
+ * Host test of 't3d_skeleton_blend_tree' together with a buffered skeleton.
+ * Uses a small synthetic skeleton with a base pose, a masked upper-body layer and a masked additive layer,
+ * which are faded in and out over time while the skeleton is updated every frame like in the game.
+ *
+ * Checks:
+ * - additive layers without any regular input stay constant over frames (no compounding)
+ * - a weight-1 additive layer on top of a pose gives 'pose * (rest^-1 * layer)'
+ * - the buffer drawn in each frame always matches the current pose, also after bones stop changing
+ *
+ * Usage: test_blend [frames=600]
+ */
+#include <libdragon.h>
+#include <t3d/t3dmath.h>
+#include <t3d/t3dskeleton.h>
+#include <vector>
+
+namespace
+{
+  constexpr uint32_t BONE_COUNT = 6;
+  constexpr int BUFFER_COUNT = 3;
+  constexpr float EPSILON = 1e-4f;
+  constexpr int32_t EPSILON_FP = 2; // in 1/65536
+
+  // root -> spine -> chest -> arm -> hand, plus a leg on the root
+  constexpr uint16_t PARENTS[BONE_COUNT]{0xFFFF, 0, 1, 2, 3, 0};
+  constexpr uint16_t DEPTHS[BONE_COUNT]{0, 1, 2, 3, 4, 1};
+  constexpr uint8_t MASK_UPPER[BONE_COUNT]{0, 0, 255, 255, 255, 0};
+  constexpr uint8_t MASK_ARM[BONE_COUNT]{0, 0, 0, 255, 128, 0};
+
+  int errors = 0;
+
+  void check(bool cond, const char* msg, uint32_t frame, uint32_t bone) {
+    if(cond)return;
+    if(errors < 16)printf("FAIL: %s (frame %u, bone %u)\n", msg, frame, bone);
+    ++errors;
+  }
+
+  T3DQuat quatAxisAngle(float x, float y, float z, float angle) {
+    T3DQuat q;
+    T3DVec3 axis{{x, y, z}};
+    t3d_vec3_norm(&axis);
+    t3d_quat_from_rotation(&q, axis.v, angle);
+    return q;
+  }
+
+  T3DChunkSkeleton* createSkeletonDef() {
+    auto def = (T3DChunkSkeleton*)calloc(1, sizeof(T3DChunkSkeleton) + sizeof(T3DChunkBone) * BONE_COUNT);
+    def->boneCount = BONE_COUNT;
+    for(uint32_t i=0; i<BONE_COUNT; ++i) {
+      T3DChunkBone &bone = def->bones[i];
+      bone.name = (char*)"bone";
+      bone.parentIdx = PARENTS[i];
+      bone.depth = DEPTHS[i];
+      bone.scale = {{1.0f, 1.0f, 1.0f}};
+      bone.rotation = quatAxisAngle(0.2f * i, 1.0f, 0.3f, 0.1f + 0.15f * i);
+      bone.position = {{0.0f, 10.0f + i, 2.0f * i}};
+    }
+    return def;
+  }
+
+  T3DSkeleton createSkeleton(const T3DChunkSkeleton *def, int bufferCount) {
+    T3DSkeleton skel{
+      .bones = (T3DBone*)malloc(sizeof(T3DBone) * def->boneCount),
+      .boneMatricesFP = bufferCount ? (T3DMat4FP*)malloc_uncached(sizeof(T3DMat4FP) * def->boneCount * bufferCount) : nullptr,
+      .bufferCount = (uint8_t)bufferCount,
+      .currentBufferIdx = 0,
+      .skeletonRef = def,
+    };
+    t3d_skeleton_reset(&skel);
+    return skel;
+  }
+
+  // Poses the bones of an input skeleton, 'phase' moves them over time
+  void setPose(T3DSkeleton &skel, float phase, float offset) {
+    for(uint32_t i=0; i<BONE_COUNT; ++i) {
+      T3DBone &bone = skel.bones[i];
+      bone.rotation = quatAxisAngle(1.0f, 0.5f * i, offset, sinf(phase + i) * 0.8f + offset);
+      bone.position = {{offset * i, 10.0f + cosf(phase) * i, 2.0f * i}};
+      bone.scale = {{1.0f, 1.0f + offset * 0.1f, 1.0f}};
+    }
+  }
+
+  bool srtEquals(const T3DBone &a, const T3DVec3 &scale, const T3DQuat &rot, const T3DVec3 &pos) {
+    for(int a2=0; a2<3; ++a2) {
+      if(fabsf(a.scale.v[a2] - scale.v[a2]) > EPSILON)return false;
+      if(fabsf(a.position.v[a2] - pos.v[a2]) > EPSILON)return false;
+    }
+    // q and -q are the same rotation
+    float dot = t3d_quat_dot(&a.rotation, &rot);
+    return fabsf(fabsf(dot) - 1.0f) < EPSILON;
+  }
+
+  // Full matrices of the current pose, computed from scratch without any change tracking
+  void referencePalette(const T3DSkeleton &skel, std::vector<T3DMat4FP> &res) {
+    std::vector<T3DMat4> mats(BONE_COUNT);
+    for(uint32_t i=0; i<BONE_COUNT; ++i) {
+      const T3DBone &bone = skel.bones[i];
+      T3DMat4 local;
+      t3d_mat4_from_srt(&local, bone.scale.v, bone.rotation.v, bone.position.v);
+      if(PARENTS[i] == 0xFFFF) {
+        mats[i] = local;
+      } else {
+        t3d_mat4_mul(&mats[i], &mats[PARENTS[i]], &local);
+      }
+      t3d_mat4_to_fixed(&res[i], &mats[i]);
+    }
+  }
+
+  bool paletteEquals(const T3DMat4FP &a, const T3DMat4FP &b) {
+    for(int y=0; y<4; ++y) {
+      for(int x=0; x<4; ++x) {
+        int32_t valA = (int32_t)(((uint32_t)(uint16_t)a.m[y].i[x] << 16) | a.m[y].f[x]);
+        int32_t valB = (int32_t)(((uint32_t)(uint16_t)b.m[y].i[x] << 16) | b.m[y].f[x]);
+        if(abs(valA - valB) > EPSILON_FP)return false;
+      }
+    }
+    return true;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  uint32_t frames = argc > 1 ? (uint32_t)atoi(argv[1]) : 600;
+  T3DChunkSkeleton *def = createSkeletonDef();
+
+  T3DSkeleton skelBase = createSkeleton(def, 0);
+  T3DSkeleton skelUpper = createSkeleton(def, 0);
+  T3DSkeleton skelAdd = createSkeleton(def, 0);
+  T3DSkeleton skel = createSkeleton(def, BUFFER_COUNT);
+  setPose(skelAdd, 0.5f, 0.4f);
+
+  // an additive layer alone must give the same result every time, and only mark changes once
+  {
+    T3DBlendInput inputs[]{{.skel = &skelAdd, .weight = 1.0f, .boneMask = MASK_ARM, .isAdditive = true}};
+    t3d_skeleton_blend_tree(&skel, inputs, 1);
+    std::vector<T3DBone> first(skel.bones, skel.bones + BONE_COUNT);
+
+    for(uint32_t f=0; f<8; ++f) {
+      for(uint32_t i=0; i<BONE_COUNT; ++i)skel.bones[i].hasChanged = false;
+      t3d_skeleton_blend_tree(&skel, inputs, 1);
+      for(uint32_t i=0; i<BONE_COUNT; ++i) {
+        check(srtEquals(skel.bones[i], first[i].scale, first[i].rotation, first[i].position), "additive-only drift", f, i);
+        check(!skel.bones[i].hasChanged, "additive-only marked as changed", f, i);
+      }
+    }
+    for(uint32_t i=0; i<BONE_COUNT; ++i) {
+      if(MASK_ARM[i])continue;
+      const T3DChunkBone &rest = def->bones[i];
+      check(srtEquals(skel.bones[i], rest.scale, rest.rotation, rest.position), "unmasked bone left rest pose", 0, i);
+    }
+  }
+
+  // a weight-1 additive layer on top of a pose
+  {
+    setPose(skelBase, 1.3f, 0.0f);
+    T3DBlendInput inputs[]{
+      {.skel = &skelBase, .weight = 1.0f},
+      {.skel = &skelAdd, .weight = 1.0f, .boneMask = MASK_UPPER, .isAdditive = true},
+    };
+    t3d_skeleton_blend_tree(&skel, inputs, 2);
+    for(uint32_t i=0; i<BONE_COUNT; ++i) {
+      const T3DBone &base = skelBase.bones[i];
+      if(!MASK_UPPER[i]) {
+        check(srtEquals(skel.bones[i], base.scale, base.rotation, base.position), "masked-out bone", 0, i);
+        continue;
+      }
+      const T3DChunkBone &rest = def->bones[i];
+      const T3DBone &add = skelAdd.bones[i];
+      T3DQuat restInv{{-rest.rotation.v[0], -rest.rotation.v[1], -rest.rotation.v[2], rest.rotation.v[3]}};
+      T3DQuat delta, rot, addRot = add.rotation, baseRot = base.rotation;
+      t3d_quat_mul(&delta, &restInv, &addRot);
+      t3d_quat_mul(&rot, &baseRot, &delta);
+      T3DVec3 pos, scale;
+      for(int a=0; a<3; ++a) {
+        pos.v[a] = base.position.v[a] + add.position.v[a] - rest.position.v[a];
+        scale.v[a] = base.scale.v[a] + add.scale.v[a] - rest.scale.v[a];
+      }
+      check(srtEquals(skel.bones[i], scale, rot, pos), "additive on top of pose", 0, i);
+    }
+  }
+
+  // fade layers in and out, with phases where nothing moves, and check what would be drawn each frame
+  std::vector<T3DMat4FP> refPalette(BONE_COUNT);
+  uint32_t changedBones = 0;
+  for(uint32_t f=0; f<frames; ++f) {
+    // base moves for 40 frames, then holds for 20
+    if(f % 60 < 40)setPose(skelBase, f * 0.05f, 0.0f);
+    setPose(skelUpper, f * 0.11f, 0.3f);
+
+    float upperWeight = (f % 90) < 45 ? 1.0f : 0.0f;
+    float addWeight = (f % 120) < 30 ? (f % 30) / 30.0f : ((f % 120) < 70 ? 1.0f : 0.0f);
+    T3DBlendInput inputs[]{
+      {.skel = &skelBase, .weight = 1.0f},
+      {.skel = &skelUpper, .weight = upperWeight, .boneMask = MASK_UPPER},
+      {.skel = &skelAdd, .weight = addWeight, .boneMask = MASK_ARM, .isAdditive = true},
+    };
+    t3d_skeleton_blend_tree(&skel, inputs, 3);
+    for(uint32_t i=0; i<BONE_COUNT; ++i)changedBones += skel.bones[i].hasChanged ? 1 : 0;
+    t3d_skeleton_update(&skel);
+
+    referencePalette(skel, refPalette);
+    const T3DMat4FP *drawn = &skel.boneMatricesFP[skel.currentBufferIdx * BONE_COUNT];
+    for(uint32_t i=0; i<BONE_COUNT; ++i) {
+      check(paletteEquals(drawn[i], refPalette[i]), "drawn buffer is outdated", f, i);
+    }
+  }
+
+  printf("Frames: %u, bones: %u, buffers: %d\n", frames, BONE_COUNT, BUFFER_COUNT);
+  printf("Bones marked as changed: %u of %u\n", changedBones, frames * BONE_COUNT);
+  printf("Errors: %d\n", errors);
+
+  t3d_skeleton_destroy(&skel);
+  t3d_skeleton_destroy(&skelAdd);
+  t3d_skeleton_destroy(&skelUpper);
+  t3d_skeleton_destroy(&skelBase);
+  free(def);
+  return errors ? 1 : 0;
+}
@@ -0,0 +1,259 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+
+/**
+ * Host test of the cell/portal query ('t3d_model_portal_query').
+ * Uses 'bench/assets/portals.glb', three rooms in a row ('CELL_A' to 'CELL_C') connected by a door each,
+ * with crates in every room, a beam reaching through the wall between A and B, and one object outside of all cells.
+ * Cameras are placed randomly inside the rooms and look in random directions.
+ *
+ * Checks:
+ * - the returned cell is the one the camera is in
+ * - nothing visible is culled: points sampled on each object are traced from the camera through the cells,
+ *   any object with a point in the frustum that is only seen through portals must be marked
+ * - objects behind walls are culled, for a few fixed views and compared to frustum culling alone
+ *
+ * Usage: test_portal [model=build_host/filesystem/portals.t3dm] [views=4096] [seed=1]
+ */
+#include <libdragon.h>
+#include <t3d/t3dmath.h>
+#include <t3d/t3dmodel.h>
+#include "host/model_host.h"
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+  constexpr float CAM_FOV = T3D_DEG_TO_RAD(70.0f);
+  constexpr float CAM_NEAR = 2.0f;
+  constexpr float CAM_FAR = 1000.0f;
+  constexpr float CAM_MARGIN = 4.0f; // distance to the walls
+  constexpr uint32_t SAMPLES = 4; // per axis and object
+
+  int errors = 0;
+
+  void fail(const char* msg, uint32_t view, const char* obj) {
+    if(errors < 16)printf("FAIL: %s (view %u, object %s)\n", msg, view, obj);
+    ++errors;
+  }
+
+  struct Scene {
+    const T3DModel *model;
+    const T3DPortalData *data;
+    const T3DPortal *portals;
+    std::vector<T3DObject*> objects{};
+  };
+
+  T3DFrustum createFrustum(const T3DVec3 &pos, const T3DVec3 &target) {
+    T3DMat4 matProj, matCam, matCamProj;
+    T3DVec3 up{{0, 1, 0}};
+    t3d_mat4_perspective(&matProj, CAM_FOV, 320.0f / 240.0f, CAM_NEAR, CAM_FAR);
+    t3d_mat4_look_at(&matCam, &pos, &target, &up);
+    t3d_mat4_mul(&matCamProj, &matProj, &matCam);
+    T3DFrustum frustum;
+    t3d_mat4_to_frustum(&frustum, &matCamProj);
+    return frustum;
+  }
+
+  bool inFrustum(const T3DFrustum &frustum, const T3DVec3 &p) {
+    for(auto &plane : frustum.planes) {
+      if(plane.v[3] + plane.v[0] * p.v[0] + plane.v[1] * p.v[1] + plane.v[2] * p.v[2] <= 0.0f)return false;
+    }
+    return true;
+  }
+
+  // same order as the query, the first cell containing the point wins
+  int findCell(const T3DPortalData *data, const T3DVec3 &p) {
+    for(uint32_t c=0; c<data->cellCount; ++c) {
+      const T3DCell &cell = data->cells[c];
+      bool inside = true;
+      for(int a=0; a<3; ++a)inside &= p.v[a] >= cell.aabbMin[a] && p.v[a] <= cell.aabbMax[a];
+      if(inside)return (int)c;
+    }
+    return -1;
+  }
+
+  /**
+   * Returns the factor along 'from -> to' where the segment hits the portal polygon, or a negative value.
+   */
+  float segmentVsPortal(const T3DPortal &portal, const T3DVec3 &from, const T3DVec3 &to) {
+    T3DVec3 points[T3D_PORTAL_MAX_POINTS];
+    for(uint32_t i=0; i<portal.pointCount; ++i) {
+      points[i] = {{(float)portal.points[i][0], (float)portal.points[i][1], (float)portal.points[i][2]}};
+    }
+    T3DVec3 edgeA, edgeB, normal, dir, toPlane;
+    t3d_vec3_diff(&edgeA, &points[1], &points[0]);
+    t3d_vec3_diff(&edgeB, &points[2], &points[0]);
+    t3d_vec3_cross(&normal, &edgeA, &edgeB);
+    t3d_vec3_diff(&dir, &to, &from);
+    t3d_vec3_diff(&toPlane, &points[0], &from);
+
+    float denom = t3d_vec3_dot(&normal, &dir);
+    if(denom == 0.0f)return -1.0f;
+    float t = t3d_vec3_dot(&normal, &toPlane) / denom;
+    if(t < 0.0f || t > 1.0f)return -1.0f;
+
+    T3DVec3 hit;
+    t3d_vec3_lerp(&hit, &from, &to, t);
+    for(uint32_t i=0; i<portal.pointCount; ++i) {
+      T3DVec3 edge, toHit, cross;
+      t3d_vec3_diff(&edge, &points[i+1 == portal.pointCount ? 0 : i+1], &points[i]);
+      t3d_vec3_diff(&toHit, &hit, &points[i]);
+      t3d_vec3_cross(&cross, &edge, &toHit);
+      if(t3d_vec3_dot(&cross, &normal) < 0.0f)return -1.0f;
+    }
+    return t;
+  }
+
+  /**
+   * Reference visibility of a single point, walks the cells along the line from the camera.
+   * Leaving a cell anywhere else than through one of its portals means a wall is in the way.
+   */
+  bool isReachable(const Scene &scene, int camCell, const T3DVec3 &camPos, const T3DVec3 &p) {
+    int cellIdx = camCell;
+    float tCurr = 0.0f;
+    for(uint32_t depth=0; depth<=scene.data->cellCount; ++depth) {
+      const T3DCell &cell = scene.data->cells[cellIdx];
+
+      float tExit = 1.0f;
+      for(int a=0; a<3; ++a) {
+        float dir = p.v[a] - camPos.v[a];
+        if(dir > 0.0f)tExit = fminf(tExit, (cell.aabbMax[a] - camPos.v[a]) / dir);
+        if(dir < 0.0f)tExit = fminf(tExit, (cell.aabbMin[a] - camPos.v[a]) / dir);
+      }
+      if(tExit >= 1.0f)return true;
+
+      int nextCell = -1;
+      for(uint32_t i=0; i<cell.portalCount; ++i) {
+        const T3DPortal &portal = scene.portals[cell.portalIdx + i];
+        float t = segmentVsPortal(portal, camPos, p);
+        if(t >= tCurr && fabsf(t - tExit) < 1e-3f) {
+          nextCell = portal.targetCell;
+          tCurr = t;
+          break;
+        }
+      }
+      if(nextCell < 0)return false;
+      cellIdx = nextCell;
+    }
+    return false;
+  }
+
+  bool isVisible(const Scene &scene, const T3DFrustum &frustum, int camCell, const T3DVec3 &camPos, const T3DObject *obj) {
+    for(uint32_t x=0; x<SAMPLES; ++x) {
+      for(uint32_t y=0; y<SAMPLES; ++y) {
+        for(uint32_t z=0; z<SAMPLES; ++z) {
+          // stay off the faces, those can touch walls and portal edges
+          float f[3]{(x + 0.5f) / SAMPLES, (y + 0.5f) / SAMPLES, (z + 0.5f) / SAMPLES};
+          T3DVec3 p;
+          for(int a=0; a<3; ++a)p.v[a] = obj->aabbMin[a] + (obj->aabbMax[a] - obj->aabbMin[a]) * f[a];
+          if(inFrustum(frustum, p) && isReachable(scene, camCell, camPos, p))return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  int runQuery(const Scene &scene, const T3DFrustum &frustum, const T3DVec3 &camPos) {
+    for(auto obj : scene.objects)obj->isVisible = false;
+    return t3d_model_portal_query(scene.model, &frustum, &camPos);
+  }
+
+  const T3DObject* findObject(const Scene &scene, const char *name) {
+    for(auto obj : scene.objects) {
+      if(strcmp(obj->name, name) == 0)return obj;
+    }
+    return nullptr;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  const char* path = argc > 1 ? argv[1] : "build_host/filesystem/portals.t3dm";
+  uint32_t views = argc > 2 ? (uint32_t)atoi(argv[2]) : 4096;
+  uint32_t seed = argc > 3 ? (uint32_t)atoi(argv[3]) : 1;
+
+  T3DModel *model = HostModel::load(path);
+  if(!model) {
+    printf("Failed to load model: %s\n", path);
+    return 1;
+  }
+
+  Scene scene{.model = model, .data = t3d_model_portal_get(model)};
+  if(!scene.data) {
+    printf("Model has no portal data: %s\n", path);
+    return 1;
+  }
+  scene.portals = (const T3DPortal*)&scene.data->cells[scene.data->cellCount];
+  for(uint32_t i=0; i<model->chunkCount; ++i) {
+    if(model->chunkOffsets[i].type == T3D_CHUNK_TYPE_OBJECT)scene.objects.push_back(t3d_model_get_object_by_index(model, i));
+  }
+  printf("Model: %s, cells: %u, portals: %u, objects: %zu\n",
+    path, scene.data->cellCount, scene.data->portalCount, scene.objects.size());
+
+  // fixed views in room A, positions are in model units (64 per meter)
+  struct { T3DVec3 pos, target; std::vector<std::string> visible, hidden; } fixedViews[]{
+    // looking through the door into B
+    {{{64, 64, 0}}, {{384, 32, 0}}, {"CrateB0"}, {"CrateB1", "CrateB2", "CrateC1", "CrateC2", "Outside"}},
+    // facing away from the door
+    {{{192, 64, 0}}, {{0, 64, 0}}, {"CrateA0"}, {"CrateB0", "CrateB1", "CrateB2", "CrateC0", "CrateC1", "CrateC2"}},
+    // looking at the wall next to the door, the beam reaches through it
+    {{{128, 100, 64}}, {{256, 112, 96}}, {"Beam"}, {"CrateB1", "CrateB2", "CrateC0", "CrateC1", "CrateC2"}},
+  };
+  uint32_t viewIdx = 0;
+  for(auto &view : fixedViews) {
+    T3DFrustum frustum = createFrustum(view.pos, view.target);
+    if(runQuery(scene, frustum, view.pos) != 0)fail("wrong camera cell", viewIdx, "-");
+    for(auto &name : view.visible) {
+      const T3DObject *obj = findObject(scene, name.c_str());
+      if(!obj || !obj->isVisible)fail("object should be visible", viewIdx, name.c_str());
+    }
+    for(auto &name : view.hidden) {
+      const T3DObject *obj = findObject(scene, name.c_str());
+      if(!obj || obj->isVisible)fail("object should be culled", viewIdx, name.c_str());
+    }
+    ++viewIdx;
+  }
+
+  // random views in all rooms
+  std::mt19937 rng{seed};
+  std::uniform_real_distribution<float> rand01{0.0f, 1.0f};
+  uint64_t countFrustum = 0, countPortal = 0, countVisible = 0;
+  for(uint32_t v=0; v<views; ++v) {
+    uint32_t cellIdx = v % scene.data->cellCount;
+    const T3DCell &cell = scene.data->cells[cellIdx];
+    T3DVec3 pos;
+    for(int a=0; a<3; ++a) {
+      float min = cell.aabbMin[a] + CAM_MARGIN;
+      float max = cell.aabbMax[a] - CAM_MARGIN;
+      pos.v[a] = min + (max - min) * rand01(rng);
+    }
+    float yaw = rand01(rng) * T3D_PI * 2.0f;
+    float pitch = (rand01(rng) - 0.5f) * 1.2f;
+    T3DVec3 target{{pos.v[0] + cosf(yaw) * cosf(pitch) * 100.0f, pos.v[1] + sinf(pitch) * 100.0f, pos.v[2] + sinf(yaw) * cosf(pitch) * 100.0f}};
+
+    T3DFrustum frustum = createFrustum(pos, target);
+    int camCell = runQuery(scene, frustum, pos);
+    if(camCell != findCell(scene.data, pos))fail("wrong camera cell", v, "-");
+    if(camCell < 0)continue;
+
+    for(auto obj : scene.objects) {
+      bool visible = isVisible(scene, frustum, camCell, pos, obj);
+      countFrustum += t3d_frustum_vs_aabb_s16(&frustum, obj->aabbMin, obj->aabbMax) ? 1 : 0;
+      countPortal += obj->isVisible ? 1 : 0;
+      countVisible += visible ? 1 : 0;
+      if(visible && !obj->isVisible)fail("visible object was culled", v, obj->name);
+    }
+  }
+
+  if(countPortal >= countFrustum)fail("portals did not cull anything", views, "-");
+  printf("Views: %u, objects per view: %.2f frustum, %.2f portals, %.2f visible\n", views,
+    (double)countFrustum / views, (double)countPortal / views, (double)countVisible / views);
+  printf("Errors: %d\n", errors);
+
+  HostModel::free(model);
+  return errors ? 1 : 0;
+}
@@ -0,0 +1,191 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+
+/**
+ * Host test of the shared animation pose cache ('t3d_pose_cache_get').
+ * A crowd of instances plays the clips of 'cath.t3dm' with a few different phases,
+ * and switches clips every few seconds so poses get recycled between clips.
+ * There are more clips*phases than poses, so recycling happens in the middle of the run.
+ * One clip is changed to only animate a single bone, so a recycled pose has bones that change only once.
+ *
+ * Checks:
+ * - each returned palette matches the clip evaluated from scratch at the same quantized time
+ * - palettes returned in the last 'bufferCount-1' frames stay untouched (they may still be drawn)
+ * - instances at the same clip and time share one pose, so evaluations only scale with distinct poses
+ *
+ * Usage: test_posecache [model=build_host/filesystem/cath.t3dm] [instances=48] [frames=1200]
+ */
+#include <libdragon.h>
+#include <t3d/t3dposecache.h>
+#include "host/model_host.h"
+#include "host/rom_host.h"
+#include <set>
+#include <vector>
+
+namespace
+{
+  constexpr uint32_t MAX_POSES = 12;
+  constexpr int BUFFER_COUNT = 3;
+  constexpr uint32_t PHASE_COUNT = 3;
+  constexpr float FRAME_TIME = 1.0f / 60.0f;
+  constexpr uint32_t SWITCH_FRAMES = 150;
+  constexpr int32_t EPSILON_FP = 16; // in 1/65536, times are reached by different float sums
+
+  struct Snapshot {
+    const T3DMat4FP *ptr;
+    std::vector<T3DMat4FP> data;
+  };
+
+  int32_t toFixed(int16_t i, uint16_t f) { return (int32_t)(((uint32_t)(uint16_t)i << 16) | f); }
+
+  int32_t paletteDiff(const T3DMat4FP *a, const T3DMat4FP *b, uint32_t count) {
+    int32_t maxDiff = 0;
+    for(uint32_t m=0; m<count; ++m) {
+      for(int y=0; y<4; ++y) {
+        for(int x=0; x<4; ++x) {
+          int32_t diff = abs(toFixed(a[m].m[y].i[x], a[m].m[y].f[x]) - toFixed(b[m].m[y].i[x], b[m].m[y].f[x]));
+          if(diff > maxDiff)maxDiff = diff;
+        }
+      }
+    }
+    return maxDiff;
+  }
+
+  /**
+   * Reference, evaluates a clip from its start up to the given time on a fresh skeleton.
+   */
+  struct Reference {
+    T3DSkeleton skel;
+    std::vector<T3DAnim> anims{};
+
+    Reference(const T3DModel *model, const std::vector<T3DChunkAnim*> &clips) {
+      skel = t3d_skeleton_create(model);
+      for(auto clip : clips)anims.push_back(t3d_anim_create(model, clip->name));
+    }
+
+    ~Reference() {
+      for(auto &anim : anims)t3d_anim_destroy(&anim);
+      t3d_skeleton_destroy(&skel);
+    }
+
+    const T3DMat4FP* eval(uint32_t clip, float time) {
+      T3DAnim &anim = anims[clip];
+      t3d_skeleton_reset(&skel);
+      t3d_anim_attach(&anim, &skel);
+      t3d_anim_set_time(&anim, 0.0f);
+      t3d_anim_update(&anim, time);
+      t3d_skeleton_update(&skel);
+      return skel.boneMatricesFP;
+    }
+  };
+}
+
+int main(int argc, char** argv)
+{
+  const char* path = argc > 1 ? argv[1] : "build_host/filesystem/cath.t3dm";
+  uint32_t instances = argc > 2 ? (uint32_t)atoi(argv[2]) : 48;
+  uint32_t frames = argc > 3 ? (uint32_t)atoi(argv[3]) : 1200;
+
+  HostRom::mount("build_host/filesystem");
+  HostRom::setSwap16(true);
+  T3DModel *model = HostModel::load(path);
+  if(!model) {
+    printf("Failed to load model: %s\n", path);
+    return 1;
+  }
+
+  uint32_t clipCount = t3d_model_get_animation_count(model);
+  std::vector<T3DChunkAnim*> clips(clipCount);
+  t3d_model_get_animations(model, clips.data());
+  const T3DChunkSkeleton *skelDef = t3d_model_get_skeleton(model);
+  uint32_t boneCount = skelDef->boneCount;
+  printf("Model: %s, bones: %u, clips: %u\n", path, boneCount, clipCount);
+
+  // all clips animate every bone, turn one into a clip that only moves a leaf bone (like a face or hand clip).
+  // All other bones then only change once when a pose switches to that clip, and must reach every buffer.
+  uint32_t leafBone = boneCount - 1; // children always follow their parent, so the last bone is a leaf
+  T3DChunkAnim *partialClip = clips[1];
+  for(uint32_t c=0; c<partialClip->channelsQuat + partialClip->channelsScalar; ++c) {
+    partialClip->channelMappings[c].targetIdx = leafBone;
+  }
+
+  T3DPoseCacheConf conf{.maxPoses = MAX_POSES, .timeStep = 1.0f / 30.0f, .bufferCount = BUFFER_COUNT};
+  T3DPoseCache cache = t3d_pose_cache_create(model, &conf);
+  Reference ref{model, clips};
+
+  int errors = 0;
+  int32_t maxDiff = 0;
+  uint64_t evalCount = 0, hitCount = 0, requestCount = 0;
+  uint32_t maxEvalsPerFrame = 0;
+  std::vector<std::vector<Snapshot>> history{}; // palettes returned in the last frames
+
+  for(uint32_t f=0; f<frames; ++f) {
+    float time = f * FRAME_TIME;
+    t3d_pose_cache_begin_frame(&cache);
+
+    std::set<std::pair<uint32_t, uint32_t>> distinct{};
+    std::vector<Snapshot> snapshots{};
+    // only two clips are active at a time, which change every few seconds
+    uint32_t clipBase = f / SWITCH_FRAMES;
+
+    for(uint32_t i=0; i<instances; ++i) {
+      uint32_t clip = (clipBase + (i % 2)) % clipCount;
+      float phase = (i % PHASE_COUNT) * 0.35f;
+      const T3DChunkAnim *anim = clips[clip];
+
+      const T3DMat4FP *mats = t3d_pose_cache_get(&cache, anim, time + phase);
+      ++requestCount;
+
+      // same quantization as the cache
+      float step = conf.timeStep;
+      uint32_t stepCount = (uint32_t)ceilf(anim->duration / step);
+      float localTime = fmodf(time + phase, anim->duration);
+      uint32_t timeIdx = (uint32_t)(localTime / step);
+      if(timeIdx >= stepCount)timeIdx = stepCount - 1;
+
+      if(distinct.insert({clip, timeIdx}).second) {
+        snapshots.push_back({mats, std::vector<T3DMat4FP>(mats, mats + boneCount)});
+      }
+
+      int32_t diff = paletteDiff(mats, ref.eval(clip, (float)timeIdx * step), boneCount);
+      if(diff > maxDiff)maxDiff = diff;
+      if(diff > EPSILON_FP) {
+        if(errors < 16)printf("FAIL: palette differs by %d (frame %u, instance %u, clip %u)\n", diff, f, i, clip);
+        ++errors;
+      }
+    }
+
+    // anything returned in the previous frames may still be in use by the RDP
+    for(auto &old : history) {
+      for(auto &snap : old) {
+        if(paletteDiff(snap.ptr, snap.data.data(), boneCount) != 0) {
+          if(errors < 16)printf("FAIL: palette of an earlier frame was overwritten (frame %u)\n", f);
+          ++errors;
+        }
+      }
+    }
+    history.push_back(std::move(snapshots));
+    if(history.size() > BUFFER_COUNT - 1)history.erase(history.begin());
+
+    if(cache.evalCount > distinct.size()) {
+      if(errors < 16)printf("FAIL: %u evaluations for %zu distinct poses (frame %u)\n", cache.evalCount, distinct.size(), f);
+      ++errors;
+    }
+    evalCount += cache.evalCount;
+    hitCount += cache.hitCount;
+    if(cache.evalCount > maxEvalsPerFrame)maxEvalsPerFrame = cache.evalCount;
+  }
+
+  printf("Instances: %u, frames: %u, max. poses: %u\n", instances, frames, MAX_POSES);
+  printf("Evaluations: %.2f per frame (max %u), shared requests: %.2f per frame\n",
+    (double)evalCount / frames, maxEvalsPerFrame, (double)hitCount / frames);
+  printf("Without the cache: %.2f evaluations per frame\n", (double)requestCount / frames);
+  printf("Max. difference to reference: %d/65536\n", maxDiff);
+  printf("Errors: %d\n", errors);
+
+  t3d_pose_cache_destroy(&cache);
+  HostModel::free(model);
+  return errors ? 1 : 0;
+}
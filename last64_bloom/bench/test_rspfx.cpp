@@ -0,0 +1,328 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+
+/**
+ * Host test of the bloom/HDR ucode ('src/rsp/rsp_fx.S'), run in the RSP interpreter of 'host/rsp_host.h'.
+ * Commands are issued like 'RspFX' does, on random images, and compared against a plain C++ version.
+ *
+ * Checks:
+ * - HDR + bloom output within 1 LSB per RGBA16 channel, over multiple strips,
+ *   including the bloom edges on the right and bottom which are clamped to the last pixel
+ * - the luminance histogram of each strip matches exactly
+ * - downscale and blur within 1-2 LSB for RGB, nothing is written outside of the output buffers
+ *   (both use the row before their output as scratch space, like 'PostProcess' allows)
+ * - no DMEM access races a running DMA
+ *
+ * Also prints the estimated cycles of each command at the game's resolution,
+ * and of the HDR inner loop per 8 pixels.
+ *
+ * Usage: test_rspfx [ucode=src/rsp/rsp_fx.S] [seed=1]
+ */
+#include <libdragon.h>
+#include "host/rsp_host.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+  constexpr uint32_t CMD_HDR_BLIT   = 0x00;
+  constexpr uint32_t CMD_BLUR       = 0x01;
+  constexpr uint32_t CMD_DOWN_SCALE = 0x02;
+
+  // see 'rspFX.h'
+  constexpr uint32_t TILE_WIDTH = 320;
+  constexpr int LUMA_BIN_COUNT = 16;
+
+  constexpr uint8_t FILL_BYTE = 0xA5;
+
+  int errors = 0;
+
+  void fail(const char* msg, uint32_t x, uint32_t y) {
+    if(errors < 16)printf("FAIL: %s (%u, %u)\n", msg, x, y);
+    ++errors;
+  }
+
+  struct Image {
+    uint32_t addr;
+    uint32_t width, height, bpp;
+    uint32_t stride() const { return width * bpp; }
+    uint8_t* at(uint32_t x, uint32_t y) const { return HostRsp::getRdram() + addr + y * stride() + x * bpp; }
+  };
+
+  uint32_t rdramPos = 0x1000;
+
+  // images are placed with a free row before and after them, to catch writes out of bounds
+  Image alloc(uint32_t width, uint32_t height, uint32_t bpp, uint32_t extraRows = 0) {
+    Image img{rdramPos + width * bpp, width, height, bpp};
+    rdramPos = (img.addr + (height + extraRows + 1) * img.stride() + 0xFF) & ~0xFFu;
+    return img;
+  }
+
+  void fillRandom(const Image &img, std::mt19937 &rng) {
+    for(uint32_t i=0; i<img.height * img.stride(); ++i)HostRsp::getRdram()[img.addr + i] = (uint8_t)rng();
+  }
+
+  std::vector<uint8_t> rdramBefore{};
+
+  void resetRdram() {
+    rdramPos = 0x1000;
+    memset(HostRsp::getRdram(), FILL_BYTE, HostRsp::RDRAM_SIZE);
+  }
+
+  void snapshotRdram() {
+    rdramBefore.assign(HostRsp::getRdram(), HostRsp::getRdram() + rdramPos + 0x1000);
+  }
+
+  // everything but the given ranges must be the same as in the last snapshot
+  void checkUntouched(std::initializer_list<std::pair<uint32_t, uint32_t>> ranges, const char* cmd) {
+    const uint8_t *rdram = HostRsp::getRdram();
+    for(uint32_t i=0; i<rdramBefore.size(); ++i) {
+      bool isOutput = false;
+      for(auto &r : ranges)if(i >= r.first && i < r.first + r.second)isOutput = true;
+      if(!isOutput && rdram[i] != rdramBefore[i]) {
+        fail(cmd, i, 0);
+        return;
+      }
+    }
+  }
+
+  uint32_t readU32(const uint8_t *p) { return (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]; }
+
+  // Sizes packed into the upper 8 bits of the address, like 'RspFX'
+  uint32_t packAddr(uint32_t addr, uint32_t size) { return (addr & 0xFFFFFF) | (size << 24); }
+
+  void hdrBlit(const Image &in, const Image &out, const Image &bloom, float factor) {
+    uint32_t factorInt = (uint32_t)(factor * 0xFFFF) & 0xFFFFFF;
+    factorInt |= (in.height / 4) << 24;
+    for(uint32_t x=0; x<in.width; x += TILE_WIDTH) {
+      uint32_t tileWidth = std::min(in.width - x, TILE_WIDTH);
+      uint32_t lastStripFlag = (x + tileWidth == in.width) ? 0x80 : 0;
+      HostRsp::run(CMD_HDR_BLIT, {
+        packAddr(in.addr + x * 4, 0),
+        packAddr(out.addr + x * 2, in.width / 8),
+        packAddr(bloom.addr + x, (tileWidth / 8) | lastStripFlag),
+        factorInt
+      });
+    }
+  }
+
+  void downscale(const Image &in, const Image &out) {
+    for(uint32_t x=0; x<in.width; x += TILE_WIDTH) {
+      uint32_t tileWidth = std::min(in.width - x, TILE_WIDTH);
+      HostRsp::run(CMD_DOWN_SCALE, {
+        in.addr + x * 4, out.addr + x, ((tileWidth * 4) << 16) | (in.height / 4), in.stride()
+      });
+    }
+  }
+
+  uint32_t blurBrightness(float brightness) { return (uint32_t)(brightness * (1 << 12) * 0.99f) & 0xFFFF; }
+
+  void blur(const Image &in, const Image &out, float brightness, float threshold) {
+    uint32_t factors = ((uint32_t)(threshold * 0x7FFF) & 0xFFFF) << 16;
+    factors |= blurBrightness(brightness);
+    HostRsp::run(CMD_BLUR, {in.addr, out.addr - out.stride(), factors, (in.width << 16) | in.height});
+  }
+
+  /* ---------------- Reference ---------------- */
+
+  uint8_t refHdrChannel(const Image &in, const Image &bloom, float factor, uint32_t x, uint32_t y, int c) {
+    // bloom is interpolated bilinear, clamped at the right and bottom edge
+    uint32_t bx = x / 4, by = y / 4;
+    uint32_t bx1 = std::min(bx + 1, bloom.width - 1);
+    uint32_t by1 = std::min(by + 1, bloom.height - 1);
+    float fx = (x % 4) / 4.0f, fy = (y % 4) / 4.0f;
+    float top = bloom.at(bx, by)[c] + (bloom.at(bx1, by)[c] - bloom.at(bx, by)[c]) * fx;
+    float bottom = bloom.at(bx, by1)[c] + (bloom.at(bx1, by1)[c] - bloom.at(bx, by1)[c]) * fx;
+    float hdr = std::min(in.at(x, y)[c] * factor, 255.99f);
+    return (uint8_t)std::min(hdr + top + (bottom - top) * fy, 255.0f);
+  }
+
+  int lumaBin(const uint8_t *rgba) {
+    int luma = (rgba[0] + rgba[1] * 2 + rgba[2]) >> 4;
+    return std::min(15, (int)floorf(2.5f * log2f(luma + 1.0f)));
+  }
+
+  void checkHdr(const Image &in, const Image &out, const Image &bloom, float factor) {
+    bool reported[3]{};
+    for(uint32_t y=0; y<in.height; ++y) {
+      for(uint32_t x=0; x<in.width; ++x) {
+        const uint8_t *p = out.at(x, y);
+        uint16_t col = (p[0] << 8) | p[1];
+        int res[3]{col >> 11, (col >> 6) & 0x1F, (col >> 1) & 0x1F};
+        for(int c=0; c<3; ++c) {
+          int expected = refHdrChannel(in, bloom, factor, x, y, c) >> 3;
+          if(abs(res[c] - expected) > 1) {
+            int kind = x >= in.width - 4 ? 1 : (y >= in.height - 4 ? 2 : 0);
+            if(!reported[kind])fail(kind == 1 ? "HDR right edge" : (kind == 2 ? "HDR bottom edge" : "HDR"), x, y);
+            reported[kind] = true;
+          }
+        }
+      }
+    }
+
+    // histograms are placed after the last row of each strip
+    for(uint32_t x=0; x<in.width; x += TILE_WIDTH) {
+      uint32_t tileWidth = std::min(in.width - x, TILE_WIDTH);
+      uint32_t expected[LUMA_BIN_COUNT]{};
+      for(uint32_t y=0; y<in.height; ++y) {
+        for(uint32_t sx=2; sx<tileWidth; sx += 8)++expected[lumaBin(in.at(x + sx, y))];
+      }
+      const uint8_t *hist = in.at(x, in.height);
+      for(int b=0; b<LUMA_BIN_COUNT; ++b) {
+        if(readU32(hist + b * 4) != expected[b])fail("histogram", x, b);
+      }
+    }
+  }
+
+  void checkDownscale(const Image &in, const Image &out) {
+    for(uint32_t y=0; y<out.height; ++y) {
+      for(uint32_t x=0; x<out.width; ++x) {
+        // alpha of every second pixel is not averaged, bloom only uses RGB
+        for(int c=0; c<3; ++c) {
+          // rows 0 and 2 of each group of 4
+          int sum = 0;
+          for(int sx=0; sx<4; ++sx)sum += in.at(x * 4 + sx, y * 4)[c] + in.at(x * 4 + sx, y * 4 + 2)[c];
+          if(abs(out.at(x, y)[c] - sum / 8) > 1) {
+            fail("downscale", x, y);
+            return;
+          }
+        }
+      }
+    }
+  }
+
+  void checkBlur(const Image &in, const Image &out, float brightness, float threshold) {
+    int limit = (int)(threshold * 0x7FFF);
+    auto sample = [&](int x, int y, int c) {
+      x = std::clamp(x, 0, (int)in.width - 1);
+      y = std::clamp(y, 0, (int)in.height - 1);
+      int val = in.at(x, y)[c];
+      return (val << 7) < limit ? 0 : val;
+    };
+
+    // the kernel of the first two columns starts with an empty sum and is darker, alpha is not blurred
+    float scale = blurBrightness(brightness) / 32768.0f;
+    for(int y=0; y<(int)out.height; ++y) {
+      for(int x=2; x<(int)out.width; ++x) {
+        for(int c=0; c<3; ++c) {
+          int sum = 0;
+          for(int ky=-1; ky<=1; ++ky) {
+            for(int kx=-1; kx<=1; ++kx)sum += sample(x + kx, y + ky, c);
+          }
+          int expected = std::min((int)(sum * scale), 255);
+          if(abs(out.at(x, y)[c] - expected) > 2) {
+            fail("blur", x, y);
+            return;
+          }
+        }
+      }
+    }
+  }
+
+  void printStats(const char* name) {
+    auto &stats = HostRsp::getStats();
+    printf("%-10s %8lu cycles, %7lu instr., %6lu dual-issued, %6lu stalls, %4u DMAs\n", name,
+      (unsigned long)stats.cycles, (unsigned long)stats.instructions, (unsigned long)stats.dualIssued,
+      (unsigned long)stats.stallCycles, stats.dmaCount
+    );
+    if(stats.dmaHazards)fail("DMEM accessed during a DMA", stats.dmaHazards, 0);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  const char* path = argc > 1 ? argv[1] : "src/rsp/rsp_fx.S";
+  uint32_t seed = argc > 2 ? (uint32_t)atoi(argv[2]) : 1;
+  std::mt19937 rng{seed};
+
+  if(!HostRsp::load(path)) {
+    printf("Failed to load ucode: %s\n", path);
+    return 1;
+  }
+
+  // Downscale, runs first since its threshold reads a lane no command sets (zero after loading)
+  {
+    resetRdram();
+    Image in = alloc(640, 32, 4);
+    Image out = alloc(160, 8, 4);
+    fillRandom(in, rng);
+    snapshotRdram();
+    HostRsp::resetStats();
+    downscale(in, out);
+    HostRsp::sync();
+    printStats("Downscale");
+    checkDownscale(in, out);
+    checkUntouched({{out.addr - out.stride(), (out.height + 1) * out.stride()}}, "downscale wrote out of bounds");
+  }
+
+  // Blur, with and without threshold
+  for(float threshold : {0.0f, 0.4f}) {
+    resetRdram();
+    Image in = alloc(80, 12, 4);
+    Image out = alloc(80, 12, 4);
+    fillRandom(in, rng);
+    snapshotRdram();
+    HostRsp::resetStats();
+    blur(in, out, 0.8f, threshold);
+    HostRsp::sync();
+    printStats("Blur");
+    checkBlur(in, out, 0.8f, threshold);
+    checkUntouched({{out.addr - out.stride(), (out.height + 1) * out.stride()}}, "blur wrote out of bounds");
+  }
+
+  // HDR + bloom, split into strips
+  for(float factor : {1.0f, 1.6f}) {
+    resetRdram();
+    Image in = alloc(640, 32, 4, 1);
+    Image out = alloc(640, 32, 2);
+    Image bloom = alloc(160, 8, 4);
+    fillRandom(in, rng);
+    fillRandom(bloom, rng);
+    snapshotRdram();
+    HostRsp::resetStats();
+    hdrBlit(in, out, bloom, factor);
+    HostRsp::sync();
+    printStats("HDR");
+    checkHdr(in, out, bloom, factor);
+    checkUntouched({
+      {out.addr, out.height * out.stride()},
+      {in.addr + in.height * in.stride(), in.stride()}
+    }, "HDR wrote out of bounds");
+  }
+
+  // Timing at the game's resolution
+  {
+    resetRdram();
+    Image hdr = alloc(320, 240, 4, 1);
+    Image out = alloc(320, 240, 2);
+    Image bloomA = alloc(80, 60, 4);
+    Image bloomB = alloc(80, 60, 4);
+    fillRandom(hdr, rng);
+    printf("Timing at 320x240:\n");
+
+    HostRsp::resetStats();
+    downscale(hdr, bloomA);
+    HostRsp::sync();
+    printStats("Downscale");
+
+    HostRsp::resetStats();
+    blur(bloomA, bloomB, 0.8f, 0.2f);
+    HostRsp::sync();
+    printStats("Blur");
+
+    HostRsp::resetStats();
+    hdrBlit(hdr, out, bloomB, 1.2f);
+    HostRsp::sync();
+    printStats("HDR");
+
+    // inner loop of the HDR pass, one iteration handles 8 pixels
+    uint64_t loopCycles = HostRsp::getCycles("LABEL_Cmd_HDRBloom_000B", "LABEL_Cmd_HDRBloom_000C");
+    printf("HDR loop   %8lu cycles, %.2f per 8 pixels\n", (unsigned long)loopCycles, loopCycles / (320.0 * 240.0 / 8.0));
+  }
+
+  printf("Errors: %d\n", errors);
+  return errors ? 1 : 0;
+}
@@ -0,0 +1,266 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+
+/**
+ * Host test of the skeleton ucode of Tiny3D ('src/t3d/rsp/rsp_tinyskel.S'), run in the RSP interpreter of 'host/rsp_host.h'.
+ * A synthetic skeleton is posed randomly over multiple frames, with all or only some bones changing.
+ * One copy is updated with 't3d_skeleton_update' (the reference), the other one with 't3d_skeleton_update_rsp',
+ * whose packed bones are then run through the ucode.
+ *
+ * Checks:
+ * - the matrices match the reference within a tolerance per level of depth, the maximum error is printed
+ * - chains deeper than a batch of the ucode and parents from earlier batches (read back from RDRAM)
+ * - bone counts below, at and above the batch size
+ * - nothing is written outside of the current buffer, no DMEM access races a running DMA
+ * - two updates queued before the RSP runs either of them, each one gets the pose of its own frame
+ *
+ * Usage: test_rspskel [ucode=../src/t3d/rsp/rsp_tinyskel.S] [seed=1]
+ */
+#include <libdragon.h>
+#include <t3d/t3dmath.h>
+#include <t3d/t3dskeleton.h>
+#include "host/rsp_host.h"
+#include <random>
+#include <vector>
+
+namespace
+{
+  constexpr int BUFFER_COUNT = 2;
+  constexpr uint32_t FRAMES = 24;
+  constexpr uint8_t FILL_BYTE = 0xA5;
+
+  // the RSP works with s1.15 rotations and truncates in each 16.16 multiplication,
+  // so errors add up along the chain: tolerances are per bone from the root, in world units.
+  // With local positions up to 6 units, translations can be off by 2 units per 1000.
+  constexpr float TOLERANCE_BASIS = 1.0f / 4096.0f;
+  constexpr float TOLERANCE_POS = 1.0f / 512.0f;
+
+  constexpr uint32_t RDRAM_SRT = 0x1000;
+  constexpr uint32_t RDRAM_PALETTE = 0x4000;
+
+  int errors = 0;
+  float maxErrorBasis = 0.0f;
+  float maxErrorPos = 0.0f;
+
+  void check(bool cond, const char* msg, uint32_t frame, uint32_t bone) {
+    if(cond)return;
+    if(errors < 16)printf("FAIL: %s (frame %u, bone %u)\n", msg, frame, bone);
+    ++errors;
+  }
+
+  // Bones in depth-first order: a spine deeper than a batch, branches attached to it
+  // in earlier batches, a leg on the root and a single bone on the root at the end
+  T3DChunkSkeleton* createSkeletonDef(uint32_t boneCount) {
+    std::vector<uint16_t> parents{0xFFFF};
+    auto addChain = [&](uint16_t parent, uint32_t length) {
+      for(uint32_t i=0; i<length; ++i) {
+        parents.push_back(parent);
+        parent = (uint16_t)(parents.size() - 1);
+      }
+    };
+    addChain(0, 20); // bones 1-20
+    addChain(10, 4); // on the spine, after its end
+    addChain(5, 8);
+    addChain(0, 10);
+    addChain(0, 1);
+
+    auto def = (T3DChunkSkeleton*)calloc(1, sizeof(T3DChunkSkeleton) + sizeof(T3DChunkBone) * boneCount);
+    def->boneCount = boneCount;
+    for(uint32_t i=0; i<boneCount; ++i) {
+      T3DChunkBone &bone = def->bones[i];
+      bone.name = (char*)"bone";
+      bone.parentIdx = parents[i];
+      bone.depth = i == 0 ? 0 : def->bones[parents[i]].depth + 1;
+      bone.scale = {{1.0f, 1.0f, 1.0f}};
+      bone.rotation = {{0.0f, 0.0f, 0.0f, 1.0f}};
+      bone.position = {{0.0f, 1.0f, 0.0f}};
+    }
+    return def;
+  }
+
+  T3DSkeleton createSkeleton(const T3DChunkSkeleton *def) {
+    T3DSkeleton skel{
+      .bones = (T3DBone*)malloc(sizeof(T3DBone) * def->boneCount),
+      .boneMatricesFP = (T3DMat4FP*)malloc_uncached(sizeof(T3DMat4FP) * def->boneCount * BUFFER_COUNT),
+      .bufferCount = (uint8_t)BUFFER_COUNT,
+      .currentBufferIdx = 0,
+      .skeletonRef = def,
+    };
+    t3d_skeleton_reset(&skel);
+    return skel;
+  }
+
+  void randomPose(T3DBone &bone, std::mt19937 &rng) {
+    std::uniform_real_distribution<float> distRot{-1.0f, 1.0f};
+    std::uniform_real_distribution<float> distScale{0.85f, 1.15f};
+    std::uniform_real_distribution<float> distPos{-6.0f, 6.0f};
+    for(int a=0; a<4; ++a)bone.rotation.v[a] = distRot(rng);
+    t3d_quat_normalize(&bone.rotation);
+    for(int a=0; a<3; ++a) {
+      bone.scale.v[a] = distScale(rng);
+      bone.position.v[a] = distPos(rng);
+    }
+    bone.hasChanged = true;
+  }
+
+  // the RDRAM of the interpreter is big-endian, all values of the packed bones are 16-bit.
+  // Each buffer has its own packed bones, they are copied to the RDRAM when the command would run.
+  uint32_t uploadSRT(const T3DSkeleton &skel, uint32_t bufferIdx) {
+    uint32_t boneCount = skel.skeletonRef->boneCount;
+    uint32_t addr = RDRAM_SRT + bufferIdx * boneCount * sizeof(T3DBoneSRTFP);
+    const uint16_t *src = (const uint16_t*)&skel.bonesSRT[bufferIdx * boneCount];
+    uint8_t *dst = HostRsp::getRdram() + addr;
+    for(uint32_t i=0; i<boneCount * sizeof(T3DBoneSRTFP) / 2; ++i) {
+      dst[i*2 + 0] = (uint8_t)(src[i] >> 8);
+      dst[i*2 + 1] = (uint8_t)src[i];
+    }
+    return addr;
+  }
+
+  float readFixed(uint32_t addr, uint32_t col, uint32_t row) {
+    const uint8_t *mat = HostRsp::getRdram() + addr + col * 16;
+    int32_t valInt = (int16_t)((mat[row * 2] << 8) | mat[row * 2 + 1]);
+    uint32_t valFrac = (mat[8 + row * 2] << 8) | mat[8 + row * 2 + 1];
+    return (float)(int32_t)(((uint32_t)valInt << 16) | valFrac) / 65536.0f;
+  }
+
+  std::vector<T3DMat4> getMatrices(const T3DSkeleton &skel) {
+    std::vector<T3DMat4> res(skel.skeletonRef->boneCount);
+    for(uint32_t i=0; i<res.size(); ++i)res[i] = skel.bones[i].matrix;
+    return res;
+  }
+
+  void checkPalette(const T3DChunkSkeleton *def, const std::vector<T3DMat4> &refMats, uint32_t addr, uint32_t frame) {
+    for(uint32_t i=0; i<def->boneCount; ++i) {
+      const T3DMat4 &ref = refMats[i];
+      float errBasis = 0.0f, errPos = 0.0f;
+      for(uint32_t col=0; col<4; ++col) {
+        for(uint32_t row=0; row<4; ++row) {
+          float refVal = row == 3 ? (col == 3 ? 1.0f : 0.0f) : ref.m[col][row];
+          float err = fabsf(readFixed(addr + i * sizeof(T3DMat4FP), col, row) - refVal);
+          if(col == 3)errPos = fmaxf(errPos, err);
+          else errBasis = fmaxf(errBasis, err);
+        }
+      }
+      float levels = (float)(def->bones[i].depth + 1);
+      maxErrorBasis = fmaxf(maxErrorBasis, errBasis / levels);
+      maxErrorPos = fmaxf(maxErrorPos, errPos / levels);
+      check(errBasis <= TOLERANCE_BASIS * levels, "rotation/scale differs from the reference", frame, i);
+      check(errPos <= TOLERANCE_POS * levels, "translation differs from the reference", frame, i);
+    }
+  }
+
+  // a random pose for all bones, or for about a third of them
+  void randomPoses(T3DSkeleton &skelRef, T3DSkeleton &skelRsp, bool allBones, std::mt19937 &rng) {
+    std::bernoulli_distribution distChanged{0.3};
+    for(uint32_t i=0; i<skelRef.skeletonRef->boneCount; ++i) {
+      if(allBones || distChanged(rng)) {
+        randomPose(skelRef.bones[i], rng);
+        skelRsp.bones[i] = skelRef.bones[i];
+      }
+    }
+  }
+
+  void testSkeleton(uint32_t boneCount, std::mt19937 &rng) {
+    T3DChunkSkeleton *def = createSkeletonDef(boneCount);
+    T3DSkeleton skelRef = createSkeleton(def);
+    T3DSkeleton skelRsp = createSkeleton(def);
+    uint32_t paletteSize = boneCount * sizeof(T3DMat4FP);
+    uint64_t cycles = 0;
+
+    memset(HostRsp::getRdram(), FILL_BYTE, RDRAM_PALETTE + paletteSize * (BUFFER_COUNT + 1));
+
+    for(uint32_t f=0; f<FRAMES; ++f) {
+      // first frame is the rest pose, then every other frame moves only some of the bones
+      if(f > 0)randomPoses(skelRef, skelRsp, f % 2 == 0, rng);
+
+      t3d_skeleton_update(&skelRef);
+      t3d_skeleton_update_rsp(&skelRsp);
+      for(uint32_t i=0; i<boneCount; ++i)check(!skelRsp.bones[i].hasChanged, "bone still marked as changed", f, i);
+
+      uint32_t addrSRT = uploadSRT(skelRsp, skelRsp.currentBufferIdx);
+      uint32_t addrOut = RDRAM_PALETTE + skelRsp.currentBufferIdx * paletteSize;
+      std::vector<uint8_t> before(HostRsp::getRdram(), HostRsp::getRdram() + RDRAM_PALETTE + paletteSize * (BUFFER_COUNT + 1));
+
+      HostRsp::resetStats();
+      HostRsp::run(T3D_SKEL_CMD_UPDATE, {addrSRT, addrOut, boneCount});
+      HostRsp::sync();
+      auto &stats = HostRsp::getStats();
+      cycles += stats.cycles;
+      check(stats.dmaHazards == 0, "DMEM accessed during a DMA", f, 0);
+
+      checkPalette(def, getMatrices(skelRef), addrOut, f);
+      for(uint32_t i=0; i<before.size(); ++i) {
+        bool isOutput = i >= addrOut && i < addrOut + paletteSize;
+        bool isInput = i >= addrSRT && i < addrSRT + boneCount * sizeof(T3DBoneSRTFP);
+        if(!isOutput && !isInput && HostRsp::getRdram()[i] != before[i]) {
+          check(false, "wrote outside of the current buffer", f, i);
+          break;
+        }
+      }
+    }
+
+    printf("Bones: %2u, %6lu cycles per update, %.1f per bone\n", boneCount,
+      (unsigned long)(cycles / FRAMES), (double)cycles / FRAMES / boneCount
+    );
+
+    t3d_skeleton_destroy(&skelRsp);
+    t3d_skeleton_destroy(&skelRef);
+    free(def);
+  }
+
+  // The CPU runs ahead of the RSP: all buffers are updated before the first command runs
+  void testQueued(uint32_t boneCount, std::mt19937 &rng) {
+    T3DChunkSkeleton *def = createSkeletonDef(boneCount);
+    T3DSkeleton skelRef = createSkeleton(def);
+    T3DSkeleton skelRsp = createSkeleton(def);
+    uint32_t paletteSize = boneCount * sizeof(T3DMat4FP);
+
+    for(uint32_t f=0; f<FRAMES; f += BUFFER_COUNT) {
+      std::vector<std::vector<T3DMat4>> refMats{};
+      for(int b=0; b<BUFFER_COUNT; ++b) {
+        if(f + b > 0)randomPoses(skelRef, skelRsp, (f / BUFFER_COUNT) % 2 == 0, rng);
+        t3d_skeleton_update(&skelRef);
+        t3d_skeleton_update_rsp(&skelRsp);
+        refMats.push_back(getMatrices(skelRef));
+      }
+
+      // the last update used the current buffer, the ones before it the previous buffers in order
+      for(int b=0; b<BUFFER_COUNT; ++b) {
+        uint32_t bufferIdx = (skelRsp.currentBufferIdx + 1 + b) % BUFFER_COUNT;
+        uint32_t addrSRT = uploadSRT(skelRsp, bufferIdx);
+        uint32_t addrOut = RDRAM_PALETTE + bufferIdx * paletteSize;
+        HostRsp::run(T3D_SKEL_CMD_UPDATE, {addrSRT, addrOut, boneCount});
+        HostRsp::sync();
+        checkPalette(def, refMats[b], addrOut, f + b);
+      }
+    }
+
+    t3d_skeleton_destroy(&skelRsp);
+    t3d_skeleton_destroy(&skelRef);
+    free(def);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  const char* path = argc > 1 ? argv[1] : "../src/t3d/rsp/rsp_tinyskel.S";
+  uint32_t seed = argc > 2 ? (uint32_t)atoi(argv[2]) : 1;
+  std::mt19937 rng{seed};
+
+  if(!HostRsp::load(path)) {
+    printf("Failed to load ucode: %s\n", path);
+    return 1;
+  }
+
+  for(uint32_t boneCount : {1u, 16u, 17u, 44u}) {
+    testSkeleton(boneCount, rng);
+  }
+  testQueued(44, rng);
+
+  printf("Max. error per level: %.6f rotation/scale, %.6f translation\n", maxErrorBasis, maxErrorPos);
+  printf("Errors: %d\n", errors);
+  return errors ? 1 : 0;
+}
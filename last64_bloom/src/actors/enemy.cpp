@@ -5,44 +5,39 @@
 #include "enemy.h"
 #include "player.h"
 #include "../systems/experience.h"
+#include "../systems/targeting_system.h"
 #include "../main.h"
+#include "../profiler.h"
 #include <t3d/t3d.h>
 #include <t3d/tpx.h>
 #include <libdragon.h>
-#include <malloc.h>
-
 
+namespace {
+    float getScale(Actor::EnemySize size) {
+        switch (size) {
+            case Actor::EnemySize::MEDIUM: return 1.5f;
+            case Actor::EnemySize::LARGE:  return 4.0f;
+            default:                       return 1.0f;
+        }
+    }
+}
 
 namespace Actor {
     // Static member definitions
-    T3DVertPacked* Enemy::sharedVertices = nullptr;
-    T3DMat4FP** Enemy::sharedMatrices = nullptr;
-    bool* Enemy::activeFlags = nullptr;
-    uint32_t Enemy::activeCount = 0;
+    QuadBatch* Enemy::batch = nullptr;
+    PTBatch* Enemy::ptBatch = nullptr;
     bool Enemy::initialized = false;
-    Enemy Enemy::enemyPool[MAX_ENEMIES];
 
-    Enemy::Enemy() : Base() {
-        if (!initialized) {
-            initializePool();
-        }
-        
-        poolIndex = MAX_ENEMIES; // Invalid index until spawned
-        position = {0, 0, 0};
-        speed = 0.0f;
-        health = 8;
-        maxHealth = 8;
-        targetPlayer = nullptr; // Initialize individual target player
-        size = EnemySize::SMALL;
-        color = 0xFF0000FF; // Default red color
-        xpReward = 1;
-        flags |= FLAG_DISABLED; // Start as disabled
-    }
+    T3DVec3 Enemy::position[MAX_ENEMIES];
+    float Enemy::speed[MAX_ENEMIES];
+    float Enemy::hitTimer[MAX_ENEMIES];
+    int Enemy::health[MAX_ENEMIES];
+    uint32_t Enemy::color[MAX_ENEMIES];
+    int Enemy::xpReward[MAX_ENEMIES];
+    EnemySize Enemy::size[MAX_ENEMIES];
+    Player* Enemy::targetPlayer[MAX_ENEMIES];
 
-    Enemy::~Enemy() {
-        // We don't actually delete from the pool here
-        // The pool is managed statically
-    }
+    ActorPool<Enemy, MAX_ENEMIES> Enemy::pool{};
 
     void Enemy::initialize() {
         if (!initialized) {
@@ -51,305 +46,170 @@ namespace Actor {
     }
 
     void Enemy::cleanup() {
-        if (sharedVertices) {
-            free_uncached(sharedVertices);
-            sharedVertices = nullptr;
-        }
-        
-        if (sharedMatrices) {
-            for (int i = 0; i < MAX_ENEMIES; i++) {
-                if (sharedMatrices[i]) {
-                    free_uncached(sharedMatrices[i]);
-                }
-            }
-            free(sharedMatrices);
-            sharedMatrices = nullptr;
-        }
-        
-        if (activeFlags) {
-            free(activeFlags);
-            activeFlags = nullptr;
-        }
-        
-        activeCount = 0;
+        delete batch;
+        batch = nullptr;
+        delete ptBatch;
+        ptBatch = nullptr;
+
+        pool.reset();
         initialized = false;
     }
 
     void Enemy::initializePool() {
         if (initialized) return;
 
-        // Allocate vertices for all enemies (quads)
-        T3DVec3 normalVec = {{0.0f, 0.0f, 1.0f}};
-        uint16_t norm = t3d_vert_pack_normal(&normalVec);
-        sharedVertices = (T3DVertPacked*)malloc_uncached(sizeof(T3DVertPacked) * MAX_ENEMIES * 2);
-        
-        for (int i = 0; i < MAX_ENEMIES; i++) {
-            int idx = i * 2;
-            // First structure: vertices 0 and 1
-            sharedVertices[idx] = (T3DVertPacked){};
-            sharedVertices[idx].posA[0] = -3; sharedVertices[idx].posA[1] = -3; sharedVertices[idx].posA[2] = 0;
-            sharedVertices[idx].normA = norm;
-            sharedVertices[idx].posB[0] = 3; sharedVertices[idx].posB[1] = -3; sharedVertices[idx].posB[2] = 0;
-            sharedVertices[idx].normB = norm;
-            // Ensure enemy colors are also bright for bloom effect
-            sharedVertices[idx].rgbaA = 0xFF0000FF; // Bright red
-            sharedVertices[idx].rgbaB = 0xFF0000FF; // Bright red
-            sharedVertices[idx].stA[0] = 0; sharedVertices[idx].stA[1] = 0;
-            sharedVertices[idx].stB[0] = 0; sharedVertices[idx].stB[1] = 0;
-            
-            // Second structure: vertices 2 and 3
-            sharedVertices[idx+1] = (T3DVertPacked){};
-            sharedVertices[idx+1].posA[0] = 3; sharedVertices[idx+1].posA[1] = 3; sharedVertices[idx+1].posA[2] = 0;
-            sharedVertices[idx+1].normA = norm;
-            sharedVertices[idx+1].posB[0] = -3; sharedVertices[idx+1].posB[1] = 3; sharedVertices[idx+1].posB[2] = 0;
-            sharedVertices[idx+1].normB = norm;
-            sharedVertices[idx+1].rgbaA = 0xFF0000FF; // Bright red
-            sharedVertices[idx+1].rgbaB = 0xFF0000FF; // Bright red
-            sharedVertices[idx+1].stA[0] = 0; sharedVertices[idx+1].stA[1] = 0;
-            sharedVertices[idx+1].stB[0] = 0; sharedVertices[idx+1].stB[1] = 0;
-        }
-        
-        // Allocate matrices for all enemies
-        sharedMatrices = (T3DMat4FP**)malloc(sizeof(T3DMat4FP*) * MAX_ENEMIES);
-        for (int i = 0; i < MAX_ENEMIES; i++) {
-            sharedMatrices[i] = (T3DMat4FP*)malloc_uncached(sizeof(T3DMat4FP));
-            t3d_mat4fp_identity(sharedMatrices[i]);
-        }
-        
-        // Allocate active flags
-        activeFlags = (bool*)calloc(MAX_ENEMIES, sizeof(bool));
-        
+        batch = new QuadBatch(MAX_ENEMIES);
+        ptBatch = new PTBatch(MAX_ENEMIES, {{SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f, 0.0f}});
+
+        pool.reset();
         initialized = true;
     }
 
-    Enemy* Enemy::spawn(const T3DVec3& position, float speed, Player* targetPlayer, EnemySize size, uint32_t color, int xpReward, int health) {
+    Enemy::Handle Enemy::spawn(const T3DVec3& pos, float spd, Player* target, EnemySize enemySize, uint32_t enemyColor, int reward, int hp) {
         if (!initialized) {
             initializePool();
         }
-        
-        // Find an inactive enemy slot
-        for (uint32_t i = 0; i < MAX_ENEMIES; i++) {
-            if (!activeFlags[i]) {
-                // Found an inactive slot, activate it
-                activeFlags[i] = true;
-                activeCount++;
-                
-                // Get an enemy from the pool
-                Enemy* enemy = &enemyPool[i];
-                
-                enemy->poolIndex = i;
-                enemy->position = position;
-                enemy->speed = speed;
-                enemy->size = size;
-                enemy->color = color;
-                enemy->xpReward = xpReward;
-                enemy->maxHealth = health;
-                enemy->health = health;
-                
-                // Set the target player
-                enemy->targetPlayer = targetPlayer;
-                
-                enemy->flags &= ~FLAG_DISABLED; // Enable the enemy
-                
-                return enemy;
-            }
+
+        uint16_t i = pool.alloc();
+        if (i == INVALID_INDEX) {
+            return {}; // No inactive slots available
         }
-        
-        // No inactive slots available
-        return nullptr;
+
+        position[i] = pos;
+        speed[i] = spd;
+        hitTimer[i] = 0.0f;
+        size[i] = enemySize;
+        color[i] = enemyColor;
+        xpReward[i] = reward;
+        health[i] = hp;
+        targetPlayer[i] = target;
+        return pool.getHandle(i);
     }
 
     void Enemy::updateAll(float deltaTime) {
         if (!initialized) return;
-        
-        for (uint32_t i = 0; i < MAX_ENEMIES; i++) {
-            if (activeFlags[i]) {
-                Enemy* enemy = &enemyPool[i];
-                enemy->update(deltaTime);
-            }
+        PROFILE_SCOPE("enemy-upd");
+
+        // Iterate backwards, deactivating swaps an already updated enemy into the current spot
+        for (uint32_t n = pool.getCount(); n-- > 0;) {
+            update(pool.getLive(n), deltaTime);
         }
     }
 
     void Enemy::drawAll(float deltaTime) {
         if (!initialized) return;
-        
+
+        batch->begin();
+        for (uint32_t n = 0; n < pool.getCount(); ++n) {
+            uint32_t idx = pool.getLive(n);
+            batch->add(position[idx], 3.0f * getScale(size[idx]), getDrawColor(idx));
+        }
+
         // Set up rendering state once for all enemies
         t3d_state_set_drawflags((enum T3DDrawFlags)(T3D_FLAG_SHADED | T3D_FLAG_DEPTH));
-        
-        for (uint32_t i = 0; i < MAX_ENEMIES; i++) {
-            if (activeFlags[i]) {
-                Enemy* enemy = &enemyPool[i];
-                enemy->draw3D(deltaTime);
-            }
+        batch->draw();
+    }
+
+    void Enemy::drawAllParticles() {
+        if (!initialized) return;
+
+        ptBatch->begin();
+        for (uint32_t n = 0; n < pool.getCount(); ++n) {
+            uint32_t idx = pool.getLive(n);
+            ptBatch->add(position[idx], 3.0f * getScale(size[idx]), getDrawColor(idx));
         }
+        ptBatch->draw();
     }
 
-    void Enemy::update(float deltaTime) {
-        if (flags & FLAG_DISABLED) return;
+    uint32_t Enemy::getDrawColor(uint32_t idx) {
+        // Hit flash override
+        if (hitTimer[idx] > 0.96f) {
+            uint8_t flash_white = 64;
+            return (flash_white << 24) | (flash_white << 16) | (flash_white << 8) | 0xFF;
+        }
+        return color[idx];
+    }
 
-        if (hitTimer > 0.0f) {
-            hitTimer -= deltaTime;
+    void Enemy::update(uint32_t idx, float deltaTime) {
+        if (hitTimer[idx] > 0.0f) {
+            hitTimer[idx] -= deltaTime;
         }
-        
+
         // Check if our target player is still alive, if not, find a new one
-        if (targetPlayer && targetPlayer->getIsDead()) {
-            targetPlayer = Experience::getRandomAlivePlayer();
-        }
-        
-        // If we still don't have a target player, try to get one
-        if (!targetPlayer) {
-            targetPlayer = Experience::getRandomAlivePlayer();
+        Player *target = targetPlayer[idx];
+        if (!target || target->getIsDead()) {
+            target = targetPlayer[idx] = TargetingSystem::getRandomAlivePlayer();
         }
-        
+
+        T3DVec3 &pos = position[idx];
+
         // Get player position from the individual target player reference
-        if (targetPlayer) {
-            T3DVec3 playerPos = targetPlayer->getPosition();
-            
+        if (target) {
+            T3DVec3 playerPos = target->getPosition();
+
             // Calculate direction to player
             T3DVec3 direction;
-            direction.x = playerPos.x - position.x;
-            direction.y = playerPos.y - position.y;
-            direction.z = playerPos.z - position.z;
-            
+            direction.x = playerPos.x - pos.x;
+            direction.y = playerPos.y - pos.y;
+            direction.z = playerPos.z - pos.z;
+
             // Normalize direction
             float length = sqrtf(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
             if (length > 0.0f) {
-                direction.x /= length;
-                direction.y /= length;
-                direction.z /= length;
-                
                 // Move enemy directly towards player
-                float moveDistance = speed * deltaTime;
-                position.x += direction.x * moveDistance;
-                position.y += direction.y * moveDistance;
-                position.z += direction.z * moveDistance;
+                float moveDistance = speed[idx] * deltaTime / length;
+                pos.x += direction.x * moveDistance;
+                pos.y += direction.y * moveDistance;
+                pos.z += direction.z * moveDistance;
             }
         }
-        
+
         // Deactivate enemies that go off-screen
-        if (position.x < SCREEN_LEFT || position.x > SCREEN_RIGHT || 
-            position.y < SCREEN_TOP || position.y > SCREEN_BOTTOM) {
-            deactivate();
+        if (pos.x < SCREEN_LEFT || pos.x > SCREEN_RIGHT ||
+            pos.y < SCREEN_TOP || pos.y > SCREEN_BOTTOM) {
+            deactivate(idx);
             return;
         }
-        
-        // Update matrix
-        if (poolIndex < MAX_ENEMIES) {
-            t3d_mat4fp_from_srt_euler(
-                sharedMatrices[poolIndex],
-                (T3DVec3){{1.0f, 1.0f, 1.0f}},  // scale
-                (T3DVec3){{0.0f, 0.0f, 0.0f}},  // rotation
-                position                         // translation
-            );
-        }
     }
 
-    void Enemy::draw3D(float deltaTime) {
-        if (flags & FLAG_DISABLED) return;
-        
-        if (poolIndex < MAX_ENEMIES) {
-            uint32_t new_color = color; // Use the enemy's color
-            // Hit flash override
-            if (hitTimer > 0.96f) {
-                uint8_t flash_white = 64;
-                new_color = (flash_white << 24) | (flash_white << 16) | (flash_white << 8) | 0xFF;
-            }
-
-            // Update vertex colors for this specific enemy
-            sharedVertices[poolIndex * 2].rgbaA = new_color;
-            sharedVertices[poolIndex * 2].rgbaB = new_color;
-            sharedVertices[poolIndex * 2 + 1].rgbaA = new_color;
-            sharedVertices[poolIndex * 2 + 1].rgbaB = new_color;
-
-            // Calculate scale based on enemy size
-            float scale = 1.0f;
-            switch (size) {
-                case EnemySize::SMALL:
-                    scale = 1.0f;
-                    break;
-                case EnemySize::MEDIUM:
-                    scale = 1.5f;
-                    break;
-                case EnemySize::LARGE:
-                    scale = 4.0f;
-                    break;
-            }
-
-            // Update matrix with scale
-            if (poolIndex < MAX_ENEMIES) {
-                t3d_mat4fp_from_srt_euler(
-                    sharedMatrices[poolIndex],
-                    (T3DVec3){{scale, scale, scale}},  // scale
-                    (T3DVec3){{0.0f, 0.0f, 0.0f}},  // rotation
-                    position                         // translation
-                );
-            }
-
-            t3d_matrix_push(sharedMatrices[poolIndex]);
-            t3d_vert_load(&sharedVertices[poolIndex * 2], 0, 4);
-            t3d_tri_draw(0, 1, 2);
-            t3d_tri_draw(2, 3, 0);
-            t3d_tri_sync();
-            t3d_matrix_pop(1);
-        }
-    }
-
-    void Enemy::drawPTX(float deltaTime) {
-        // No particle effects for enemies
-    }
-
-    void Enemy::deactivate() {
-        if (poolIndex < MAX_ENEMIES) {
-            activeFlags[poolIndex] = false;
-            flags |= FLAG_DISABLED;
-            activeCount--;
-        }
+    void Enemy::deactivate(uint32_t idx) {
+        pool.free(idx);
     }
 
-    bool Enemy::isActive() const {
-        if (poolIndex < MAX_ENEMIES) {
-            return activeFlags[poolIndex] && !(flags & FLAG_DISABLED);
-        }
-        return false;
-    }
-
-    void Enemy::takeDamage(int amount) {
+    void Enemy::takeDamage(uint32_t idx, int amount) {
         // Get the number of active players from the Experience system
         int activePlayers = Experience::getActivePlayerCount();
-        
+
         // Scale damage inversely with the number of active players
         // More players = less effective damage per hit
         int scaledDamage = (activePlayers > 0) ? (amount + activePlayers - 1) / activePlayers : amount; // Integer division with rounding up
-        health -= scaledDamage;
-        hitTimer = 1.0f;
-        if (health <= 0) {
-            die();
+        health[idx] -= scaledDamage;
+        hitTimer[idx] = 1.0f;
+        if (health[idx] <= 0) {
+            die(idx);
         }
     }
 
-    void Enemy::die() {
-        Experience::addXP(xpReward);
-        deactivate();
+    void Enemy::die(uint32_t idx) {
+        Experience::addXP(xpReward[idx]);
+        deactivate(idx);
     }
 
-    bool Enemy::collidesWith(Base* other) {
-        if (!other || (other->flags & FLAG_DISABLED) || (flags & FLAG_DISABLED)) {
+    bool Enemy::collidesWith(uint32_t idx, const T3DVec3 &otherPos, float otherRadius) {
+        if (!isActive(idx)) {
             return false;
         }
 
-        T3DVec3 otherPos = other->getPosition();
-        float otherRadius = other->getRadius();
-
-        float dx = position.x - otherPos.x;
-        float dy = position.y - otherPos.y;
+        float dx = position[idx].x - otherPos.x;
+        float dy = position[idx].y - otherPos.y;
         float distanceSq = dx * dx + dy * dy;
-        float radii = getRadius() + otherRadius;
+        float radii = getRadius(idx) + otherRadius;
 
         return distanceSq < (radii * radii);
     }
-    
-    float Enemy::getRadius() const {
-        switch (size) {
+
+    float Enemy::getRadius(uint32_t idx) {
+        switch (size[idx]) {
             case EnemySize::SMALL:
                 return 3.0f;
             case EnemySize::MEDIUM:
@@ -360,4 +220,4 @@ namespace Actor {
                 return 3.0f;
         }
     }
-}
\ No newline at end of file
+}
@@ -5,6 +5,9 @@
 #pragma once
 #include "../actors/base.h"
 #include "player.h"
+#include "../memory/actorPool.h"
+#include "../render/quadBatch.h"
+#include "../render/ptBatch.h"
 #include <t3d/t3d.h>
 
 #define MAX_ENEMIES 100
@@ -17,55 +20,60 @@ namespace Actor {
         LARGE
     };
 
-    class Enemy : public Base {
+    /**
+     * Pool of all enemies, stored as struct-of-arrays.
+     * Enemies are referenced by their slot index, live slots are kept in a packed list
+     * so that update, collision and drawing only ever stream over active entries.
+     */
+    class Enemy {
     private:
-        static T3DVertPacked* sharedVertices;
-        static T3DMat4FP** sharedMatrices;
-        static bool* activeFlags;
-        static uint32_t activeCount;
+        static QuadBatch* batch; // all enemies are drawn as batched world-space quads
+        static PTBatch* ptBatch; // alternative TPX render path
         static bool initialized;
-        static Enemy enemyPool[MAX_ENEMIES]; // Static pool of enemies
 
-        T3DVec3 position;
-        float speed;
-        int health;
-        int maxHealth;
-        uint32_t poolIndex;
-        Player* targetPlayer; // Individual target player for this enemy
-        float hitTimer;
-        EnemySize size;       // Size of this enemy
-        uint32_t color;       // Color of this enemy
-        int xpReward;         // XP reward for killing this enemy
+        // Per-enemy data
+        static T3DVec3 position[MAX_ENEMIES];
+        static float speed[MAX_ENEMIES];
+        static float hitTimer[MAX_ENEMIES];
+        static int health[MAX_ENEMIES];
+        static uint32_t color[MAX_ENEMIES];
+        static int xpReward[MAX_ENEMIES];
+        static EnemySize size[MAX_ENEMIES];
+        static Player* targetPlayer[MAX_ENEMIES]; // Individual target player for each enemy
+
+        static ActorPool<Enemy, MAX_ENEMIES> pool;
 
         static void initializePool();
-        void die();
+        static void update(uint32_t idx, float deltaTime);
+        static void die(uint32_t idx);
+        static uint32_t getDrawColor(uint32_t idx);
 
     public:
-        Enemy();
-        ~Enemy();
+        using Handle = ActorPool<Enemy, MAX_ENEMIES>::Handle;
+        constexpr static uint16_t INVALID_INDEX = ActorPool<Enemy, MAX_ENEMIES>::INVALID_INDEX;
 
         static void initialize();
         static void cleanup();
-        static Enemy* spawn(const T3DVec3& position, float speed, Player* targetPlayer, EnemySize size = EnemySize::SMALL, uint32_t color = 0xFF0000FF, int xpReward = 1, int health = 8);
+        // Returns a handle to the new enemy, which is invalid if the pool is full
+        static Handle spawn(const T3DVec3& position, float speed, Player* targetPlayer, EnemySize size = EnemySize::SMALL, uint32_t color = 0xFF0000FF, int xpReward = 1, int health = 8);
         static void updateAll(float deltaTime);
         static void drawAll(float deltaTime);
-        static uint32_t getActiveCount() { return activeCount; }
-        static Enemy* getEnemy(uint32_t index) { return &enemyPool[index]; }
-        static bool isActive(uint32_t index) { return activeFlags[index]; }
-
-        void update(float deltaTime) override;
-        void draw3D(float deltaTime) override;
-        void drawPTX(float deltaTime) override;
+        // Draws all enemies as TPX particles, expects the TPX state and RDP mode to be set up
+        static void drawAllParticles();
 
-        void deactivate();
-        bool isActive() const;
+        static uint32_t getActiveCount() { return pool.getCount(); }
+        // Slot index of the n-th live enemy, valid for n < getActiveCount()
+        static uint16_t getLiveIndex(uint32_t n) { return pool.getLive(n); }
+        static bool isActive(uint32_t idx) { return pool.isActive(idx); }
+        static bool isAlive(Handle handle) { return pool.isAlive(handle); }
 
-        void takeDamage(int amount);
-        bool collidesWith(Base* other);
+        static void deactivate(uint32_t idx);
+        static void takeDamage(uint32_t idx, int amount);
+        static bool collidesWith(uint32_t idx, const T3DVec3 &otherPos, float otherRadius);
 
-        T3DVec3 getPosition() const override { return position; }
-        float getRadius() const override;
-        EnemySize getSize() const { return size; }
-        int getXPReward() const { return xpReward; }
+        static const T3DVec3& getPosition(uint32_t idx) { return position[idx]; }
+        static float getRadius(uint32_t idx);
+        static EnemySize getSize(uint32_t idx) { return size[idx]; }
+        static int getXPReward(uint32_t idx) { return xpReward[idx]; }
     };
-}
\ No newline at end of file
+}
@@ -28,11 +28,7 @@ namespace Actor
       models[0] = t3d_model_load("rom:/envPot.t3dm");
       models[1] = t3d_model_load("rom:/envSphere.t3dm");
       models[2] = t3d_model_load("rom:/envTorus.t3dm");
-      for(auto m : models) {
-        rspq_block_begin();
-          t3d_model_draw(m);
-        m->userBlock = rspq_block_end();
-      }
+      for(auto m : models)t3d_model_cache_record(m, {});
     }
 
     pos = _pos;
@@ -75,7 +71,7 @@ namespace Actor
     t3d_matrix_set(matFP.get(), true);
 
     t3d_light_set_count(3);
-    rspq_block_run(models[args.type]->userBlock);
+    t3d_model_draw_cached(models[args.type], {});
     t3d_light_set_count(0);
   }
 }
\ No newline at end of file
@@ -24,9 +24,7 @@ namespace Actor
   {
     if(refCount++ == 0) {
       model = t3d_model_load("rom:/light.t3dm");
-      rspq_block_begin();
-        t3d_model_draw(model);
-      model->userBlock = rspq_block_end();
+      t3d_model_cache_record(model, {});
     }
 
     pos = _pos;
@@ -69,6 +67,6 @@ namespace Actor
   {
     rdpq_set_prim_color({args.color.r, args.color.g,args.color.b, 0x10});
     t3d_matrix_set(matFP.get(), true);
-    rspq_block_run(model->userBlock);
+    t3d_model_draw_cached(model, {});
   }
 }
\ No newline at end of file
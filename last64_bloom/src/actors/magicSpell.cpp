@@ -28,9 +28,7 @@ namespace Actor
     if(refCount++ == 0) {
       model = t3d_model_load("rom:/magic.t3dm");
       obj = t3d_model_get_object_by_index(model, 0);
-      rspq_block_begin();
-        t3d_model_draw_object(obj, nullptr);
-      obj->userBlock = rspq_block_end();
+      t3d_model_cache_record(model, {.skipMaterials = true});
     }
 
     pos = _pos;
@@ -115,8 +113,9 @@ namespace Actor
     tex.s.low = fmodf(tex.s.low, tex.texWidth * 2.0f);
     tex.t.low = fmodf(tex.t.low, tex.texHeight * 2.0f);
 
+    // texture scrolls every frame, so only the mesh is cached
     t3d_model_draw_material(obj->material, nullptr);
-    rspq_block_run(obj->userBlock);
+    t3d_model_draw_cached(model, {.skipMaterials = true});
   }
 
   void MagicSpell::drawPTX(float deltaTime)
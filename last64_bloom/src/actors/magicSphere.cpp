@@ -24,9 +24,7 @@ namespace Actor
   {
     if(refCount++ == 0) {
       model = t3d_model_load("rom:/magicRing.t3dm");
-      rspq_block_begin();
-        t3d_model_draw(model);
-      model->userBlock = rspq_block_end();
+      t3d_model_cache_record(model, {});
     }
 
     pos = _pos;
@@ -61,6 +59,6 @@ namespace Actor
     t3d_matrix_set(matFP.get(), true);
 
     rdpq_set_prim_color(args.color);
-    rspq_block_run(model->userBlock);
+    t3d_model_draw_cached(model, {});
   }
 }
\ No newline at end of file
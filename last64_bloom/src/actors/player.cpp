@@ -3,11 +3,9 @@
 * @license MIT
 */
 #include "player.h"
-#include "../systems/weapon_projectile.h"
-#include "../systems/weapon_homing.h"
-#include "../systems/weapon_circular.h"
-#include "../systems/weapon_spiral.h"
+#include "../systems/upgrade_system.h"
 #include "../main.h"
+#include "../systems/random.h"
 #include <t3d/t3d.h>
 #include <t3d/tpx.h>
 #include <libdragon.h>
@@ -19,6 +17,7 @@
 namespace Actor {
     // Static members for player mesh
     T3DVertPacked* Player::sharedVertices = nullptr;
+    T3DVertPacked* Player::vertexPool = nullptr;
     T3DMat4FP* Player::sharedMatrix = nullptr;
     bool Player::initialized = false;
     
@@ -52,6 +51,9 @@ namespace Actor {
         sharedVertices[1].stA[0] = 0; sharedVertices[1].stA[1] = 0;
         sharedVertices[1].stB[0] = 0; sharedVertices[1].stB[1] = 0;
         
+        // Per-player copies, allocated up-front so that joining mid-round doesn't allocate
+        vertexPool = (T3DVertPacked*)malloc_uncached(sizeof(T3DVertPacked) * 2 * JOYPAD_PORT_COUNT);
+
         // Allocate matrix
         sharedMatrix = (T3DMat4FP*)malloc_uncached(sizeof(T3DMat4FP));
         t3d_mat4fp_identity(sharedMatrix);
@@ -64,6 +66,11 @@ namespace Actor {
             free_uncached(sharedVertices);
             sharedVertices = nullptr;
         }
+
+        if (vertexPool) {
+            free_uncached(vertexPool);
+            vertexPool = nullptr;
+        }
         
         if (sharedMatrix) {
             free_uncached(sharedMatrix);
@@ -78,17 +85,13 @@ namespace Actor {
             initialize();
         }
         
-        // Allocate per-player vertices and matrix
-        playerVertices = (T3DVertPacked*)malloc_uncached(sizeof(T3DVertPacked) * 2);
-        playerMatrix = (T3DMat4FP*)malloc_uncached(sizeof(T3DMat4FP));
+        // Per-player vertices
+        playerVertices = vertexPool + 2 * port;
         
         // Copy shared vertices to player vertices
         playerVertices[0] = sharedVertices[0];
         playerVertices[1] = sharedVertices[1];
         
-        // Initialize matrix
-        t3d_mat4fp_identity(playerMatrix);
-        
         position = startPos;
         velocity = {0, 0, 0};
         speed = 26.0f;
@@ -115,22 +118,7 @@ namespace Actor {
         }
         
         // Initialize a single random weapon
-        int weaponType = rand() % 4;
-        WeaponBase* initialWeapon = nullptr;
-        switch (weaponType) {
-            case 0:
-                initialWeapon = new WeaponProjectile();
-                break;
-            case 1:
-                initialWeapon = new WeaponHoming();
-                break;
-            case 2:
-                initialWeapon = new WeaponCircular();
-                break;
-            case 3:
-                initialWeapon = new WeaponSpiral();
-                break;
-        }
+        WeaponBase* initialWeapon = UpgradeSystem::createWeapon((WeaponType)Random::range(4));
         if (initialWeapon) {
             initialWeapon->setPlayer(this);
             weapons.push_back(initialWeapon);
@@ -147,38 +135,20 @@ namespace Actor {
         }
     }
     
-    bool Player::collidesWith(Base* other) {
+    bool Player::collidesWith(const T3DVec3 &otherPos, float otherRadius) const {
         // Simple circle-circle collision for now
-        T3DVec3 otherPos = other->getPosition();
-        float otherRadius = other->getRadius();
-
         float dx = position.x - otherPos.x;
         float dy = position.y - otherPos.y;
-        float distance = sqrtf(dx * dx + dy * dy);
 
         // Player radius is assumed to be 3.0f, same as enemy
-        return distance < (3.0f + otherRadius);
+        float radii = 3.0f + otherRadius;
+        return (dx * dx + dy * dy) < (radii * radii);
     }
     
     Player::~Player() {
-        // Clean up per-player vertices and matrix
-        if (playerVertices) {
-            free_uncached(playerVertices);
-            playerVertices = nullptr;
-        }
-        
-        if (playerMatrix) {
-            free_uncached(playerMatrix);
-            playerMatrix = nullptr;
-        }
-        
-        // Clean up all weapons
-        for (auto& weapon : weapons) {
-            if (weapon) {
-                delete weapon;
-                weapon = nullptr;
-            }
-        }
+        // Vertices belong to the shared pool, the matrix is returned by 'RingMat4FP'.
+        // Weapons are destroyed together with the round arena.
+        playerVertices = nullptr;
         weapons.clear();
     }
     
@@ -208,11 +178,13 @@ namespace Actor {
         float newY = position.y + moveY * moveSpeed;
         
         // Check boundaries
-        if (newX >= SCREEN_LEFT && newX <= SCREEN_RIGHT) {
+        if (newX >= SCREEN_LEFT && newX <= SCREEN_RIGHT && newX != position.x) {
             position.x = newX;
+            matrixDirty = true;
         }
-        if (newY >= SCREEN_TOP && newY <= SCREEN_BOTTOM) {
+        if (newY >= SCREEN_TOP && newY <= SCREEN_BOTTOM && newY != position.y) {
             position.y = newY;
+            matrixDirty = true;
         }
         // Z position stays constant (we're moving on the X/Y plane)
         
@@ -236,16 +208,7 @@ namespace Actor {
         // Update rotation based on movement direction
         if (moveX != 0.0f || moveY != 0.0f) {
             rotation = atan2f(moveX, moveY); // Point in movement direction
-        }
-        
-        // Update matrix
-        if (playerMatrix) {
-            t3d_mat4fp_from_srt_euler(
-                playerMatrix,
-                (T3DVec3){{1.0f, 1.0f, 1.0f}},  // scale
-                (T3DVec3){{0.0f, 0.0f, rotation}},  // rotation around Z axis
-                position                         // translation
-            );
+            matrixDirty = true;
         }
     }
     
@@ -253,15 +216,27 @@ namespace Actor {
     // Set up rendering state
     t3d_state_set_drawflags((enum T3DDrawFlags)(T3D_FLAG_SHADED | T3D_FLAG_DEPTH));
     
+    // Only rebuild the matrix after a change, into the next buffer so the RSP never reads a half-written one.
+    // Otherwise the last one stays valid, the CPU doesn't touch it anymore.
+    if (matrixDirty) {
+        t3d_mat4fp_from_srt_euler(
+            matFP.getNext(),
+            (T3DVec3){{1.0f, 1.0f, 1.0f}},  // scale
+            (T3DVec3){{0.0f, 0.0f, rotation}},  // rotation around Z axis
+            position                         // translation
+        );
+        matrixDirty = false;
+    }
+
     // Draw the player using the player-specific vertices and matrix
-    if (playerMatrix && playerVertices) {
+    if (matFP.mat && playerVertices) {
         // Update vertex colors for this specific player
         playerVertices[0].rgbaA = playerColor;
         playerVertices[0].rgbaB = playerColor;
         playerVertices[1].rgbaA = playerColor;
         playerVertices[1].rgbaB = playerColor;
         
-        t3d_matrix_push(playerMatrix);
+        t3d_matrix_push(matFP.get());
         t3d_vert_load(playerVertices, 0, 4); // Load 4 vertices (2 structures)
         t3d_tri_draw(0, 1, 2); // Draw triangle with vertices 0, 1, 2
         t3d_tri_sync();
@@ -287,7 +262,7 @@ namespace Actor {
 };
 
 void Actor::Player::addWeapon(Actor::WeaponBase* weapon) {
-    if (weapon) {
+    if (weapon && !weapons.full()) {
         weapons.push_back(weapon);
     }
 }
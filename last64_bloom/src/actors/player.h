@@ -7,22 +7,29 @@
 #include "../actors/projectile.h"
 #include "../systems/weapon_base.h"
 #include "../audio.h"
+#include "../memory/matrixManager.h"
+#include "../memory/fixedVector.h"
 #include <t3d/t3d.h>
 #include <libdragon.h>
-#include <vector>
 
 namespace Actor {
     // Forward declarations
     class WeaponBase;
     
     class Player : public Base {
+    public:
+        constexpr static uint32_t MAX_WEAPONS = 4; // one of each type
+        using WeaponList = FixedVector<WeaponBase*, MAX_WEAPONS>;
+
     private:
         static T3DVertPacked* sharedVertices;
+        static T3DVertPacked* vertexPool; // vertices of all players, indexed by port
         static T3DMat4FP* sharedMatrix;
         static bool initialized;
         
-        T3DVertPacked* playerVertices; // Per-player vertices
-        T3DMat4FP* playerMatrix; // Per-player matrix
+        T3DVertPacked* playerVertices; // Per-player vertices, points into 'vertexPool'
+        RingMat4FP matFP{}; // Per-player matrix, only rewritten when 'matrixDirty' is set
+        bool matrixDirty{true};
         
         T3DVec3 position;
         T3DVec3 velocity;
@@ -35,7 +42,7 @@ namespace Actor {
         int maxHealth;
         
         // Multiple weapons - players can have multiple weapons
-        std::vector<WeaponBase*> weapons;  // The player's weapons
+        WeaponList weapons;  // The player's weapons, owned by the round arena
         
         static void initialize();
         static void cleanup();
@@ -48,16 +55,16 @@ namespace Actor {
         void drawPTX(float deltaTime) override;
         
         T3DVec3 getPosition() const { return position; }
-        void setPosition(T3DVec3 newPos) { position = newPos; }
+        void setPosition(T3DVec3 newPos) { position = newPos; matrixDirty = true; }
         float getRotation() const { return rotation; }
         
         void takeDamage(int amount);
         void kill() { isDead = true; playerColor = 0xFF0000FF; gSFXManager.play(SFXManager::SFX_DEATH);}
         bool getIsDead() const { return isDead; }
-        bool collidesWith(Base* other);
+        bool collidesWith(const T3DVec3 &otherPos, float otherRadius) const;
         
         // Weapon methods
-        std::vector<WeaponBase*>& getWeapons() { return weapons; }
+        WeaponList& getWeapons() { return weapons; }
         void addWeapon(WeaponBase* weapon);
         void removeWeapon(WeaponBase* weapon);
         
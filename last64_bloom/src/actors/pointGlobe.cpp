@@ -6,12 +6,18 @@
 #include <t3d/t3d.h>
 #include <t3d/t3dmodel.h>
 #include "pointGlobe.h"
+#include <algorithm>
 #include "../scene/scene.h"
 #include "../main.h"
 
 namespace {
   constexpr float BASE_SCALE = 0.8f;
 
+  // Work done per load-step, see 'SceneBunker::loadStep'
+  constexpr int LOAD_READ_BYTES = 16 * 1024;
+  constexpr uint32_t LOAD_SAMPLES = 250;
+  constexpr uint32_t SAMPLE_COUNT = 2000;
+
   constexpr int SLICE_SIZE = 500;
   constexpr float SLICE_SPEED = 1000.0f;
   constexpr float SLICE_COOLDOWN = 6.0f;
@@ -75,31 +81,44 @@ namespace Actor
       dplMat = rspq_block_end();
     }
 
-    sprite_t *texWorld = sprite_load("rom:/worldMap.rgba32.sprite");
-    auto worldMap = (color_t*)sprite_get_pixels(texWorld).buffer;
-
     pos = _pos;
     args = _args;
     timer = (rand() % 100) / 25;
     args.scale *= BASE_SCALE;
 
-    uint32_t sampleCount = 2000;
-    particles.resize(sampleCount);
+    particles.resize(SAMPLE_COUNT);
     particles.count = 0;
 
-    float phi = T3D_PI * (sqrtf(5.0f) - 1.0f);  // golden angle in radians
+    // the map (128KB) is read in 'loadStep' to not stall the frame
+    mapFile = asset_fopen("rom:/worldMap.rgba32.sprite", &mapSize);
+    mapData = (uint8_t*)malloc(mapSize);
+  }
 
-    float latAngle = 0.0f;
-    float lonAngle = T3D_PI / 2.0f;
+  bool PointGlobe::loadStep()
+  {
+    if(mapFile) {
+      int read = fread(mapData + mapRead, 1, std::min(LOAD_READ_BYTES, mapSize - mapRead), mapFile);
+      assertf(read > 0, "Failed to read world map");
+      mapRead += read;
+      if(mapRead < mapSize)return false;
+
+      fclose(mapFile);
+      mapFile = nullptr;
+      // only parses the header in place, the pixels stay in 'mapData'
+      worldMap = (color_t*)sprite_get_pixels(sprite_load_buf(mapData, mapSize)).buffer;
+      return false;
+    }
+    if(!worldMap)return true;
 
-    float longIncr = (T3D_PI) / sampleCount;
-    float latIncr = (T3D_PI * 32.0f) / sampleCount;
+    float phi = T3D_PI * (sqrtf(5.0f) - 1.0f);  // golden angle in radians
 
-    for(uint32_t i=0; i<sampleCount; ++i) {
+    uint32_t sampleEnd = std::min(sampleIdx + LOAD_SAMPLES, SAMPLE_COUNT);
+    for(; sampleIdx<sampleEnd; ++sampleIdx) {
+      uint32_t i = sampleIdx;
       auto p = tpx_buffer_get_pos(particles.particles, particles.count);
       auto col = tpx_buffer_get_rgba(particles.particles, particles.count);
 
-      float y = 1.0f - (i / (float)(sampleCount - 1)) * 2.0f;//  # y goes from 1 to -1
+      float y = 1.0f - (i / (float)(SAMPLE_COUNT - 1)) * 2.0f;//  # y goes from 1 to -1
       float radius = sqrtf(1.0f - y * y);
       float theta = phi * i;
 
@@ -107,7 +126,10 @@ namespace Actor
       uint8_t brightness = colImg.a;
       if(brightness < 20)continue;
 
-      if(particles.count >= particles.countMax)break;
+      if(particles.count >= particles.countMax) {
+        sampleIdx = SAMPLE_COUNT;
+        break;
+      }
       ++particles.count;
 
       float displ = colImg.r / 255.0f;
@@ -129,16 +151,21 @@ namespace Actor
       col[1] = colImg.g;
       col[2] = colImg.b;
       col[3] = 0;
-
-      lonAngle += longIncr;
-      latAngle += latIncr;
     }
+    if(sampleIdx < SAMPLE_COUNT)return false;
 
-    sprite_free(texWorld);
+    worldMap = nullptr;
+    free(mapData);
+    mapData = nullptr;
+    return true;
   }
 
   PointGlobe::~PointGlobe()
   {
+    // may get deleted while still loading
+    if(mapFile)fclose(mapFile);
+    free(mapData);
+
     if(--refCount == 0) {
       sprite_free(ptTex);
       ptTex = nullptr;
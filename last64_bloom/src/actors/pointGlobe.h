@@ -28,10 +28,24 @@ namespace Actor
       int lastDrawnPartCount{};
       Args args{};
 
+      // world map the particles are generated from, only kept while loading
+      FILE *mapFile{};
+      uint8_t *mapData{};
+      int mapSize{};
+      int mapRead{};
+      color_t *worldMap{}; // pixels inside 'mapData'
+      uint32_t sampleIdx{};
+
     public:
       PointGlobe(const fm_vec3_t &_pos, const Args &_args);
       ~PointGlobe();
 
+      /**
+       * Reads the world map and generates the particles, a small slice of work per call.
+       * Returns true once done, until then the globe has no particles.
+       */
+      bool loadStep();
+
       void update(float deltaTime) final;
       void draw3D(float deltaTime) final {}
       void drawPTX(float deltaTime) final;
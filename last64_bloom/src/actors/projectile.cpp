@@ -3,41 +3,27 @@
 * @license MIT
 */
 #include "projectile.h"
-#include "enemy.h"  // Include enemy header for collision detection
 #include "../main.h"
-#include "../systems/experience.h"
+#include "../profiler.h"
 #include <t3d/t3d.h>
 #include <libdragon.h>
-#include <malloc.h>
-
-
 
 namespace Actor {
     // Static member definitions
-    T3DVertPacked* Projectile::sharedVertices = nullptr;
-    T3DMat4FP** Projectile::sharedMatrices = nullptr;
-    bool* Projectile::activeFlags = nullptr;
-    uint32_t Projectile::activeCount = 0;
+    QuadBatch* Projectile::batch = nullptr;
+    PTBatch* Projectile::ptBatch = nullptr;
     bool Projectile::initialized = false;
-    Projectile Projectile::projectilePool[MAX_PROJECTILES];
 
-    Projectile::Projectile() : Base() {
-        if (!initialized) {
-            initializePool();
-        }
-        poolIndex = MAX_PROJECTILES;
-        position = {0, 0, 0};
-        velocity = {0, 0, 0};
-        speed = 0.0f;
-        slowdown = 0.0f; // Default no slowdown
-        lifetime = 0.0f;
-        maxLifetime = 1.0f;
-        damage = 4; // Default damage so it can be divived by 4 players
-        color = DEFAULT_PROJECTILE_COLOR; // Default color
-        flags |= FLAG_DISABLED;
-    }
+    T3DVec3 Projectile::position[MAX_PROJECTILES];
+    T3DVec3 Projectile::velocity[MAX_PROJECTILES];
+    float Projectile::speed[MAX_PROJECTILES];
+    float Projectile::slowdown[MAX_PROJECTILES];
+    float Projectile::lifetime[MAX_PROJECTILES];
+    float Projectile::maxLifetime[MAX_PROJECTILES];
+    int Projectile::damage[MAX_PROJECTILES];
+    uint32_t Projectile::color[MAX_PROJECTILES];
 
-    Projectile::~Projectile() {}
+    ActorPool<Projectile, MAX_PROJECTILES> Projectile::pool{};
 
     void Projectile::initialize() {
         if (!initialized) {
@@ -46,195 +32,107 @@ namespace Actor {
     }
 
     void Projectile::cleanup() {
-        if (sharedVertices) {
-            free_uncached(sharedVertices);
-            sharedVertices = nullptr;
-        }
-        if (sharedMatrices) {
-            for (int i = 0; i < MAX_PROJECTILES; i++) {
-                if (sharedMatrices[i]) free_uncached(sharedMatrices[i]);
-            }
-            free(sharedMatrices);
-            sharedMatrices = nullptr;
-        }
-        if (activeFlags) {
-            free(activeFlags);
-            activeFlags = nullptr;
-        }
-        activeCount = 0;
+        delete batch;
+        batch = nullptr;
+        delete ptBatch;
+        ptBatch = nullptr;
+        pool.reset();
         initialized = false;
     }
 
     void Projectile::initializePool() {
         if (initialized) return;
 
-        T3DVec3 normalVec = {{0.0f, 0.0f, 1.0f}};
-        uint16_t norm = t3d_vert_pack_normal(&normalVec);
-        // Allocate vertices for all projectiles, just like enemies
-        sharedVertices = (T3DVertPacked*)malloc_uncached(sizeof(T3DVertPacked) * MAX_PROJECTILES * 2);
-
-        for (int i = 0; i < MAX_PROJECTILES; i++) {
-            int idx = i * 2;
-            // A simple 2x2 quad
-            sharedVertices[idx] = (T3DVertPacked){};
-            sharedVertices[idx].posA[0] = -2; sharedVertices[idx].posA[1] = -2; sharedVertices[idx].posA[2] = 0;
-            sharedVertices[idx].posB[0] =  2; sharedVertices[idx].posB[1] = -2; sharedVertices[idx].posB[2] = 0;
-            sharedVertices[idx].rgbaA = DEFAULT_PROJECTILE_COLOR;
-            sharedVertices[idx].rgbaB = DEFAULT_PROJECTILE_COLOR;
-            sharedVertices[idx].normA = norm;
-            sharedVertices[idx].normB = norm;
-
-            sharedVertices[idx+1] = (T3DVertPacked){};
-            sharedVertices[idx+1].posA[0] =  2; sharedVertices[idx+1].posA[1] =  2; sharedVertices[idx+1].posA[2] = 0;
-            sharedVertices[idx+1].posB[0] = -2; sharedVertices[idx+1].posB[1] =  2; sharedVertices[idx+1].posB[2] = 0;
-            sharedVertices[idx+1].rgbaA = DEFAULT_PROJECTILE_COLOR;
-            sharedVertices[idx+1].rgbaB = DEFAULT_PROJECTILE_COLOR;
-            sharedVertices[idx+1].normA = norm;
-            sharedVertices[idx+1].normB = norm;
-        }
-
-        sharedMatrices = (T3DMat4FP**)malloc(sizeof(T3DMat4FP*) * MAX_PROJECTILES);
-        for (int i = 0; i < MAX_PROJECTILES; i++) {
-            sharedMatrices[i] = (T3DMat4FP*)malloc_uncached(sizeof(T3DMat4FP));
-            t3d_mat4fp_identity(sharedMatrices[i]);
-        }
+        batch = new QuadBatch(MAX_PROJECTILES);
+        ptBatch = new PTBatch(MAX_PROJECTILES, {{SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f, 0.0f}});
 
-        activeFlags = (bool*)calloc(MAX_PROJECTILES, sizeof(bool));
+        pool.reset();
         initialized = true;
     }
 
-    Projectile* Projectile::spawn(const T3DVec3& pos, const T3DVec3& vel, float spd, float slowdown, float maxLifetime, int damage, uint32_t color) {
+    Projectile::Handle Projectile::spawn(const T3DVec3& pos, const T3DVec3& vel, float spd, float slow, float maxLife, int dmg, uint32_t col) {
         if (!initialized) initializePool();
 
-        for (uint32_t i = 0; i < MAX_PROJECTILES; i++) {
-            if (!activeFlags[i]) {
-                activeFlags[i] = true;
-                activeCount++;
-                Projectile* p = &projectilePool[i];
-                p->poolIndex = i;
-                p->position = pos;
-                p->velocity = vel;
-                p->speed = spd;
-                p->slowdown = slowdown;
-                p->lifetime = 0.0f;
-                p->maxLifetime = maxLifetime; // Use the provided max lifetime
-                p->damage = damage; // Set the damage value
-                p->color = color; // Set the color
-                p->flags &= ~FLAG_DISABLED;
-                return p;
-            }
+        uint16_t i = pool.alloc();
+        if (i == INVALID_INDEX) {
+            return {};
         }
-        return nullptr;
+
+        position[i] = pos;
+        velocity[i] = vel;
+        speed[i] = spd;
+        slowdown[i] = slow;
+        lifetime[i] = 0.0f;
+        maxLifetime[i] = maxLife; // Use the provided max lifetime
+        damage[i] = dmg; // Set the damage value
+        color[i] = col; // Set the color
+        return pool.getHandle(i);
     }
 
     void Projectile::updateAll(float deltaTime) {
         if (!initialized) return;
-        
-        for (uint32_t i = 0; i < MAX_PROJECTILES; i++) {
-            if (activeFlags[i]) {
-                projectilePool[i].update(deltaTime);
-            }
+        PROFILE_SCOPE("projectile-upd");
+
+        // Iterate backwards, deactivating swaps an already updated projectile into the current spot
+        for (uint32_t n = pool.getCount(); n-- > 0;) {
+            update(pool.getLive(n), deltaTime);
         }
     }
 
     void Projectile::drawAll(float deltaTime) {
-        if (!initialized || activeCount == 0) return;
+        if (!initialized || pool.getCount() == 0) return;
+
+        batch->begin();
+        for (uint32_t n = 0; n < pool.getCount(); ++n) {
+            uint32_t idx = pool.getLive(n);
+            batch->add(position[idx], RADIUS, color[idx]);
+        }
 
         t3d_state_set_drawflags((enum T3DDrawFlags)(T3D_FLAG_SHADED | T3D_FLAG_DEPTH));
+        batch->draw();
+    }
+
+    void Projectile::drawAllParticles() {
+        if (!initialized || pool.getCount() == 0) return;
 
-        for (uint32_t i = 0; i < MAX_PROJECTILES; i++) {
-            if (activeFlags[i]) {
-                projectilePool[i].draw3D(deltaTime);
-            }
+        ptBatch->begin();
+        for (uint32_t n = 0; n < pool.getCount(); ++n) {
+            uint32_t idx = pool.getLive(n);
+            ptBatch->add(position[idx], RADIUS, color[idx]);
         }
+        ptBatch->draw();
     }
 
-    void Projectile::update(float deltaTime) {
-        if (flags & FLAG_DISABLED) return;
-
-        lifetime += deltaTime;
-        if (lifetime >= maxLifetime) {
-            deactivate();
+    void Projectile::update(uint32_t idx, float deltaTime) {
+        lifetime[idx] += deltaTime;
+        if (lifetime[idx] >= maxLifetime[idx]) {
+            deactivate(idx);
             return;
         }
 
         // Apply slowdown to reduce speed over time
-        speed -= slowdown * deltaTime;
-        if (speed < 0.0f) {
-            speed = 0.0f; // Don't let speed go negative
+        float spd = speed[idx] - slowdown[idx] * deltaTime;
+        if (spd < 0.0f) {
+            spd = 0.0f; // Don't let speed go negative
         }
+        speed[idx] = spd;
 
-        position.x += velocity.x * speed * deltaTime;
-        position.y += velocity.y * speed * deltaTime;
-        position.z += velocity.z * speed * deltaTime;
+        T3DVec3 &pos = position[idx];
+        const T3DVec3 &vel = velocity[idx];
+        pos.x += vel.x * spd * deltaTime;
+        pos.y += vel.y * spd * deltaTime;
+        pos.z += vel.z * spd * deltaTime;
 
-        if (position.x < SCREEN_LEFT || position.x > SCREEN_RIGHT ||
-            position.y < SCREEN_TOP || position.y > SCREEN_BOTTOM) {
-            deactivate();
+        if (pos.x < SCREEN_LEFT || pos.x > SCREEN_RIGHT ||
+            pos.y < SCREEN_TOP || pos.y > SCREEN_BOTTOM) {
+            deactivate(idx);
             return;
         }
 
-        // Check for collisions with enemies
-        for (uint32_t i = 0; i < MAX_ENEMIES; i++) {
-            if (Actor::Enemy::isActive(i)) {
-                Actor::Enemy* enemy = Actor::Enemy::getEnemy(i);
-                if (enemy && enemy->isActive() && enemy->collidesWith(this)) {
-                    enemy->takeDamage(damage); // This will be updated when we pass the player count
-                    deactivate(); // Projectile disappears on hit
-                    // Play hit sound effect
-                    gSFXManager.play(SFXManager::SFX_HIT);
-                }
-            }
-        }
-
-        // Check for collisions with players (for enemy projectiles)
-        // This would be implemented if we had enemy projectiles
-
-        if (poolIndex < MAX_PROJECTILES) {
-            t3d_mat4fp_from_srt_euler(
-                sharedMatrices[poolIndex],
-                (T3DVec3){{1.0f, 1.0f, 1.0f}},
-                (T3DVec3){{0.0f, 0.0f, 0.0f}},
-                position
-            );
-        }
+        // Collisions with enemies are resolved by the scene via the CollisionGrid
     }
 
-    void Projectile::draw3D(float deltaTime) {
-        if (flags & FLAG_DISABLED) return;
-
-        if (poolIndex < MAX_PROJECTILES) {
-            // Update vertex colors for this specific projectile
-            sharedVertices[poolIndex * 2].rgbaA = color;
-            sharedVertices[poolIndex * 2].rgbaB = color;
-            sharedVertices[poolIndex * 2 + 1].rgbaA = color;
-            sharedVertices[poolIndex * 2 + 1].rgbaB = color;
-
-            t3d_matrix_push(sharedMatrices[poolIndex]);
-            t3d_vert_load(&sharedVertices[poolIndex * 2], 0, 4);
-            t3d_tri_draw(0, 1, 2);
-            t3d_tri_draw(2, 3, 0);
-            t3d_tri_sync();
-            t3d_matrix_pop(1);
-        }
-    }
-
-    void Projectile::drawPTX(float deltaTime) {}
-
-    void Projectile::deactivate() {
-        if (poolIndex < MAX_PROJECTILES) {
-            activeFlags[poolIndex] = false;
-            flags |= FLAG_DISABLED;
-            if (activeCount > 0) {
-                activeCount--;
-            }
-        }
-    }
-
-    bool Projectile::isActive() const {
-        if (poolIndex < MAX_PROJECTILES) {
-            return activeFlags[poolIndex] && !(flags & FLAG_DISABLED);
-        }
-        return false;
+    void Projectile::deactivate(uint32_t idx) {
+        pool.free(idx);
     }
-}
\ No newline at end of file
+}
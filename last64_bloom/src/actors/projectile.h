@@ -4,6 +4,9 @@
 */
 #pragma once
 #include "../actors/base.h"
+#include "../memory/actorPool.h"
+#include "../render/quadBatch.h"
+#include "../render/ptBatch.h"
 #include <t3d/t3d.h>
 
 #define MAX_PROJECTILES 100
@@ -12,55 +15,59 @@
 #define DEFAULT_PROJECTILE_COLOR 0xFF00FFFF
 
 namespace Actor {
-    class Projectile : public Base {
+    /**
+     * Pool of all projectiles, stored as struct-of-arrays.
+     * Projectiles are referenced by their slot index, live slots are kept in a packed list.
+     */
+    class Projectile {
     private:
         // Static data for the projectile pool
-        static T3DVertPacked* sharedVertices;
-        static T3DMat4FP** sharedMatrices;
-        static bool* activeFlags;
-        static uint32_t activeCount;
+        static QuadBatch* batch; // all projectiles are drawn as batched world-space quads
+        static PTBatch* ptBatch; // alternative TPX render path
         static bool initialized;
-        static Projectile projectilePool[MAX_PROJECTILES];
 
         // Per-projectile data
-        T3DVec3 position;
-        T3DVec3 velocity;
-        float speed;
-        float slowdown; // Slowdown factor per second
-        float lifetime;
-        float maxLifetime;
-        uint32_t poolIndex;
-        int damage; // Damage dealt by this projectile
-        uint32_t color; // Color of this projectile
+        static T3DVec3 position[MAX_PROJECTILES];
+        static T3DVec3 velocity[MAX_PROJECTILES];
+        static float speed[MAX_PROJECTILES];
+        static float slowdown[MAX_PROJECTILES]; // Slowdown factor per second
+        static float lifetime[MAX_PROJECTILES];
+        static float maxLifetime[MAX_PROJECTILES];
+        static int damage[MAX_PROJECTILES]; // Damage dealt by this projectile
+        static uint32_t color[MAX_PROJECTILES]; // Color of this projectile
+
+        static ActorPool<Projectile, MAX_PROJECTILES> pool;
 
         static void initializePool();
+        static void update(uint32_t idx, float deltaTime);
 
     public:
-        Projectile();
-        ~Projectile();
+        using Handle = ActorPool<Projectile, MAX_PROJECTILES>::Handle;
+        constexpr static uint16_t INVALID_INDEX = ActorPool<Projectile, MAX_PROJECTILES>::INVALID_INDEX;
+        constexpr static float RADIUS = 2.0f; // Projectiles are 2x2 quads
 
         // Static methods for managing the pool
         static void initialize();
         static void cleanup();
-        static Projectile* spawn(const T3DVec3& position, const T3DVec3& velocity, float speed, float slowdown, float maxLifetime, int damage, uint32_t color = DEFAULT_PROJECTILE_COLOR);
+        // Returns a handle to the new projectile, which is invalid if the pool is full
+        static Handle spawn(const T3DVec3& position, const T3DVec3& velocity, float speed, float slowdown, float maxLifetime, int damage, uint32_t color = DEFAULT_PROJECTILE_COLOR);
         static void updateAll(float deltaTime);
         static void drawAll(float deltaTime);
-        static uint32_t getActiveCount() { return activeCount; }
-        static Projectile* getProjectile(uint32_t index) { return &projectilePool[index]; }
+        // Draws all projectiles as TPX particles, expects the TPX state and RDP mode to be set up
+        static void drawAllParticles();
 
-        // Overrides from Base
-        void update(float deltaTime) override;
-        void draw3D(float deltaTime) override;
-        void drawPTX(float deltaTime) override;
+        static uint32_t getActiveCount() { return pool.getCount(); }
+        // Slot index of the n-th live projectile, valid for n < getActiveCount()
+        static uint16_t getLiveIndex(uint32_t n) { return pool.getLive(n); }
+        static bool isActive(uint32_t idx) { return pool.isActive(idx); }
+        static bool isAlive(Handle handle) { return pool.isAlive(handle); }
 
-        void deactivate();
-        bool isActive() const;
+        static void deactivate(uint32_t idx);
 
-        T3DVec3 getPosition() const override { return position; }
-        void setPosition(const T3DVec3& newPosition) { position = newPosition; }
-        float getRadius() const override { return 2.0f; } // Projectiles are 2x2 quads
-        int getDamage() const { return damage; }
-        uint32_t getColor() const { return color; }
-        void setColor(uint32_t newColor) { color = newColor; }
+        static const T3DVec3& getPosition(uint32_t idx) { return position[idx]; }
+        static void setPosition(uint32_t idx, const T3DVec3& newPosition) { position[idx] = newPosition; }
+        static int getDamage(uint32_t idx) { return damage[idx]; }
+        static uint32_t getColor(uint32_t idx) { return color[idx]; }
+        static void setColor(uint32_t idx, uint32_t newColor) { color[idx] = newColor; }
     };
-}
\ No newline at end of file
+}
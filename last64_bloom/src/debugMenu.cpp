@@ -6,6 +6,8 @@
 #include <libdragon.h>
 #include "render/debugDraw.h"
 #include "scene/sceneManager.h"
+#include "profiler.h"
+#include "memory/matrixManager.h"
 #include <vector>
 
 namespace
@@ -16,6 +18,7 @@ namespace
 
   constinit int sceneId{};
   constinit bool needsSceneLoad{false};
+  constinit bool showMatrixStats{false};
 
   template<typename T>
   constexpr T clamp(T val, T min, T max)
@@ -27,6 +30,23 @@ namespace
 
   std::vector<DebugMenu::Entry> entries{};
   std::vector<bool*> changedFlags{};
+
+  void drawMatrixStats(float posX, float posY)
+  {
+    auto stats = MatrixManager::getStats();
+    uint32_t capacity = MatrixManager::getTotalCapacity();
+    uint32_t freeCount = capacity - stats.used;
+    // share of free matrices not usable by a single request
+    uint32_t frag = freeCount == 0 ? 0 : 100 - (stats.largestFreeSpan * 100 / freeCount);
+
+    Debug::print(posX, posY, "Matrices:"); posY += 10;
+    Debug::printf(posX, posY, "Used: %ld/%ld", stats.used, capacity); posY += 8;
+    Debug::printf(posX, posY, "Peak: %ld", stats.peakUsed); posY += 8;
+    Debug::printf(posX, posY, "Spans: %ld", stats.freeSpans); posY += 8;
+    Debug::printf(posX, posY, "Max: %ld", stats.largestFreeSpan); posY += 8;
+    Debug::printf(posX, posY, "Frag: %ld%%", frag); posY += 8;
+    Debug::printf(posX, posY, "Fail: %ld", stats.failedAllocs);
+  }
 }
 
 static inline joypad_buttons_t joypad_get_all_pressed() {
@@ -88,7 +108,13 @@ void DebugMenu::reset()
   entries.push_back({"Expos", EntryType::FLOAT, &state.ppConf.hdrFactor, 0.0f, 8.0f, 0.03f});
   entries.push_back({"Thres", EntryType::FLOAT, &state.ppConf.bloomThreshold, 0.0f, 1.0f, 1.0f/256.0f});
   entries.push_back({"RDP-S", EntryType::BOOL, &state.ppConf.scalingUseRDP});
+  entries.push_back({"Reuse", EntryType::BOOL, &state.ppConf.bloomReuse});
   entries.push_back({"Auto ", EntryType::BOOL, &state.autoExposure});
+  entries.push_back({"Mats ", EntryType::BOOL, &showMatrixStats});
+  #if PROFILER_ENABLED
+    entries.push_back({"Prof ", EntryType::BOOL, Profiler::getShowOverlay()});
+    entries.push_back({"CSV  ", EntryType::BOOL, Profiler::getLogCSV()});
+  #endif
 
   changedFlags.resize(entries.size());
   changedFlags[0] = &needsSceneLoad;
@@ -166,6 +192,10 @@ void DebugMenu::draw()
   Debug::print(display_get_width() - 100, posY, "[L/R] Scene");
   posY += 12;
 
+  if(showMatrixStats) {
+    drawMatrixStats(display_get_width() - 100, posY);
+  }
+
   int idx = 0;
   for(auto &entry : entries) {
     if(idx == idxCustom) {
@@ -9,7 +9,6 @@
 ////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////
 
-#include <array>
 #include <libdragon.h>
 #include <rspq_constants.h>
 #include <rspq_profile.h>
@@ -21,6 +20,7 @@
 #include "main.h"
 #include "debugMenu.h"
 #include "postProcess.h"
+#include "profiler.h"
 #include "render/debugDraw.h"
 #include "rsp/rspFX.h"
 
@@ -29,6 +29,8 @@
 #include "scene/scenes/sceneBunker.h"
 #include "scene/scenes/sceneLast64.h" // Include SceneLast64 header
 #include "systems/experience.h"
+#include "systems/random.h"
+#include "memory/allocGuard.h"
 #include "audio.h"
 
 State state{
@@ -47,6 +49,11 @@ State state{
 namespace {
   constexpr int BUFF_COUNT = 3;
 
+  // Auto-exposure: brightness the scene luminance gets mapped to, and adaption speeds (1/sec.)
+  constexpr float AUTO_EXPOSURE_KEY = 0.40f;
+  constexpr float AUTO_EXPOSURE_SPEED_BRIGHT = 3.0f;
+  constexpr float AUTO_EXPOSURE_SPEED_DARK = 1.0f;
+
   rspq_profile_data_t profileData{};
   #if RSPQ_PROFILE
     uint64_t lastUcodeTime = 0;
@@ -68,6 +75,7 @@ int main()
   
   // Initialize random number generator
   srand(TICKS_READ());
+  Random::seed(TICKS_READ());
 
   display_init(RESOLUTION_320x240, DEPTH_16_BPP, BUFF_COUNT, GAMMA_NONE, FILTERS_RESAMPLE);
 
@@ -78,7 +86,7 @@ int main()
   #endif
 
   RspFX::init();
-  PostProcess postProc[BUFF_COUNT]{};
+  PostProcess postProc{};
   Debug::init();
 
   joypad_init();
@@ -91,14 +99,15 @@ int main()
 
   SceneManager::loadScene(0);
 
-  uint32_t frameIdx = 0;
   bool showMenu = false;
 
-  int lastBrightnessIdx = 0;
-  std::array<float, 8> lastBrightness{};
 
   for(uint64_t frame = 0;; ++frame)
   {
+    #if PROFILER_ENABLED
+      Profiler::beginFrame();
+    #endif
+
     if (audio_can_write()) {
       int nsamples = audio_get_buffer_length();
       int16_t *buf = audio_write_begin();
@@ -106,9 +115,10 @@ int main()
       audio_write_end();
     }
 
-    uint32_t frameIdxLast = (frameIdx+BUFF_COUNT-1) % BUFF_COUNT;
-
-    SceneManager::update();
+    {
+      PROFILE_SCOPE("scene-mgr");
+      SceneManager::update();
+    }
 
     joypad_poll();
     if(joypad_get_buttons_pressed(JOYPAD_PORT_1).start)showMenu = !showMenu;
@@ -129,7 +139,12 @@ int main()
     if (showMenu) {
       deltaTime *= 0.1f; // Slow down to 10% speed
     }
+    {
+      PROFILE_SCOPE("update");
+      AllocGuard::arm("update");
       state.activeScene->update(deltaTime);
+      AllocGuard::disarm();
+    }
 
       // Check if the current scene (if it's SceneLast64) has requested a restart
       SceneLast64* currentLast64Scene = dynamic_cast<SceneLast64*>(state.activeScene);
@@ -150,37 +165,40 @@ int main()
     }
 
     if(state.autoExposure) {
-      lastBrightnessIdx = (lastBrightnessIdx+1) % lastBrightness.size();
-      lastBrightness[lastBrightnessIdx] = postProc[frameIdxLast].getBrightness();
-
-      float avg = 0;
-      for(auto b : lastBrightness)avg += b;
-      avg /= lastBrightness.size();
-
-      float delta = 0.05f;
-      float target = 0.40f;
-      if(avg > (target+delta)) {
-        float adjust = (0.8f) * deltaTime;
-        state.ppConf.hdrFactor = fmaxf(state.ppConf.hdrFactor-adjust, 0.0f);
-      }
-      if(avg < (target-delta)) {
-        float adjust = (0.8f) * deltaTime;
-        state.ppConf.hdrFactor = fmin(state.ppConf.hdrFactor+adjust, 8.0f);
+      // The histogram is taken before exposure, so the target does not depend on the current factor.
+      // Adapt towards it in log-space, faster when the scene gets brighter like the eye does.
+      float sceneLuma = postProc.getSceneLuma();
+      if(sceneLuma > 0.0f) {
+        float target = fminf(AUTO_EXPOSURE_KEY / sceneLuma, 8.0f);
+        float current = fmaxf(state.ppConf.hdrFactor, 1.0f / 64.0f);
+        float speed = target < current ? AUTO_EXPOSURE_SPEED_BRIGHT : AUTO_EXPOSURE_SPEED_DARK;
+        float t = 1.0f - expf(-speed * deltaTime);
+        state.ppConf.hdrFactor = exp2f(log2f(current) + (log2f(target) - log2f(current)) * t);
       }
     }
 
-    postProc[frameIdx].setConf(state.ppConf);
-    postProc[frameIdx].beginFrame();
+    postProc.setConf(state.ppConf);
+    postProc.beginFrame();
 
     t3d_frame_start();
+    AllocGuard::arm("draw");
     rdpq_mode_antialias(AA_NONE);
     rdpq_mode_dithering(DITHER_NONE_NONE);
     rdpq_mode_fog(0);
 
-    state.activeScene->draw(deltaTime);
+    {
+      PROFILE_SCOPE("draw");
+      state.activeScene->draw(deltaTime);
+    }
 
-    postProc[frameIdx].endFrame();
-    auto surfBlur = postProc[frameIdxLast].applyEffects(*fb);
+    surface_t surfBlur;
+    {
+      PROFILE_SCOPE("post-fx");
+      auto &cam = state.activeScene->getCam();
+      postProc.setCamera(cam.getPos(), cam.getTarget());
+      surfBlur = postProc.applyEffects(*fb);
+      postProc.endFrame();
+    }
 
     rdpq_sync_pipe();
     rdpq_set_color_image(fb);
@@ -207,7 +225,10 @@ int main()
     Debug::printStart();
     if(showMenu) {
       DebugMenu::draw();
-      Debug::printf(20, 200, "%d%%", (int)(postProc[frameIdxLast].getBrightness() * 100));
+      Debug::printf(20, 200, "%d%%", (int)(postProc.getBrightness() * 100));
+      if(state.ppConf.bloomReuse) {
+        Debug::printf(60, 200, "reuse:%d%%", (int)(postProc.getBloomReuseRate() * 100));
+      }
       Debug::printf(SCREEN_WIDTH-64, SCREEN_HEIGHT-20, "fps:%.0f", display_get_fps());
     }
     if ( display_get_fps() < 30.0f ) {
@@ -219,8 +240,14 @@ int main()
     #if RSPQ_PROFILE
       Debug::printf(20, 220, "%.2fms", lastUcodeTime / 1000.0f);
     #endif
+    #if PROFILER_ENABLED
+      Profiler::draw(16, 16);
+    #endif
 
-    state.activeScene->draw2D(deltaTime);
+    {
+      PROFILE_SCOPE("draw-2d");
+      state.activeScene->draw2D(deltaTime);
+    }
 
     // Draw XP Bar
     const int barHeight = 10;
@@ -233,11 +260,15 @@ int main()
     rdpq_set_mode_fill(RGBA32(100, 200, 255, 255)); // Light blue color
     rdpq_fill_rectangle(0, SCREEN_HEIGHT - (barHeight * 2), barWidth, SCREEN_HEIGHT);
     rdpq_detach_show();
+    AllocGuard::disarm();
 
     #if RSPQ_PROFILE
       rspq_profile_next_frame();
       if(++profileData.frame_count == 30) {
         rspq_profile_get_data(&profileData);
+        #if PROFILER_ENABLED
+          Profiler::setRspData(profileData);
+        #endif
         //rspq_profile_dump();
         rspq_profile_reset();
 
@@ -251,7 +282,9 @@ int main()
       }
     #endif
 
-    frameIdx = (frameIdx+1) % BUFF_COUNT;
+    #if PROFILER_ENABLED
+      Profiler::endFrame();
+    #endif
   }
 }
 
@@ -0,0 +1,98 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <libdragon.h>
+
+/**
+ * Fixed-size slot allocator for actor pools.
+ * Free slots form an intrusive free-list (O(1) alloc/free), live slots are kept in a packed list
+ * with swap-remove so iteration only touches active entries.
+ * The actual per-actor data is owned by 'T' (e.g. as struct-of-arrays indexed by slot).
+ *
+ * Handles pair a slot with a generation counter, which is bumped on every free.
+ * This allows holding on to an actor across frames without aliasing a reused slot.
+ */
+template<typename T, uint32_t N>
+class ActorPool
+{
+  public:
+    constexpr static uint16_t INVALID_INDEX = 0xFFFF;
+    static_assert(N < INVALID_INDEX);
+
+    struct Handle {
+      uint16_t index{INVALID_INDEX};
+      uint16_t generation{0};
+    };
+
+  private:
+    uint16_t nextFree[N]{};   // free-list links, only valid for free slots
+    uint16_t liveList[N]{};   // packed list of live slots
+    uint16_t liveIndex[N]{};  // position of a slot in 'liveList', INVALID_INDEX if free
+    uint16_t generation[N]{};
+    uint16_t freeHead{INVALID_INDEX};
+    uint16_t count{0};
+
+  public:
+    ActorPool() { reset(); }
+
+    /// Frees all slots, existing handles stay invalid after this
+    void reset() {
+      for(uint32_t i=0; i<N; ++i) {
+        nextFree[i] = (i+1 < N) ? (i+1) : INVALID_INDEX;
+        liveIndex[i] = INVALID_INDEX;
+        ++generation[i];
+      }
+      freeHead = 0;
+      count = 0;
+    }
+
+    /// Allocates a slot, returns INVALID_INDEX if the pool is full
+    uint16_t alloc() {
+      uint16_t idx = freeHead;
+      if(idx == INVALID_INDEX)return INVALID_INDEX;
+      freeHead = nextFree[idx];
+
+      liveIndex[idx] = count;
+      liveList[count++] = idx;
+      return idx;
+    }
+
+    /**
+     * Frees a slot, moving the last live slot into its place.
+     * When freeing while iterating, iterate backwards to not skip entries.
+     */
+    void free(uint16_t idx) {
+      uint16_t pos = liveIndex[idx];
+      if(pos == INVALID_INDEX)return;
+
+      uint16_t last = liveList[--count];
+      liveList[pos] = last;
+      liveIndex[last] = pos;
+
+      liveIndex[idx] = INVALID_INDEX;
+      ++generation[idx];
+      nextFree[idx] = freeHead;
+      freeHead = idx;
+    }
+
+    [[nodiscard]] bool isActive(uint16_t idx) const { return liveIndex[idx] != INVALID_INDEX; }
+    [[nodiscard]] uint32_t getCount() const { return count; }
+    [[nodiscard]] bool isFull() const { return freeHead == INVALID_INDEX; }
+
+    /// Slot of the n-th live entry, valid for n < getCount()
+    [[nodiscard]] uint16_t getLive(uint32_t n) const { return liveList[n]; }
+
+    [[nodiscard]] Handle getHandle(uint16_t idx) const {
+      if(idx == INVALID_INDEX)return {};
+      return {idx, generation[idx]};
+    }
+
+    /// Checks if the handle still refers to the same (live) actor it was created for
+    [[nodiscard]] bool isAlive(Handle handle) const {
+      return handle.index != INVALID_INDEX
+        && generation[handle.index] == handle.generation
+        && isActive(handle.index);
+    }
+};
@@ -0,0 +1,59 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#include "allocGuard.h"
+
+#if ALLOC_TRIPWIRE
+#include <libdragon.h>
+#include <malloc.h>
+
+namespace {
+  constinit const char* armedSection{nullptr};
+
+  void check(const char* func, size_t size) {
+    if(!armedSection)return;
+    const char* section = armedSection;
+    armedSection = nullptr; // the assert itself may allocate
+    assertf(false, "%s(%u) during '%s'", func, (unsigned)size, section);
+  }
+}
+
+void AllocGuard::arm(const char* section) { armedSection = section; }
+void AllocGuard::disarm() { armedSection = nullptr; }
+
+// Linked with '--wrap=<func>', calls to 'func' end up here, '__real_func' is the original
+extern "C" {
+  void* __real_malloc(size_t size);
+  void __real_free(void *ptr);
+  void* __real_realloc(void *ptr, size_t size);
+  void* __real_calloc(size_t num, size_t size);
+  void* __real_memalign(size_t align, size_t size);
+
+  void* __wrap_malloc(size_t size) {
+    check("malloc", size);
+    return __real_malloc(size);
+  }
+
+  void __wrap_free(void *ptr) {
+    if(ptr)check("free", 0);
+    __real_free(ptr);
+  }
+
+  void* __wrap_realloc(void *ptr, size_t size) {
+    check("realloc", size);
+    return __real_realloc(ptr, size);
+  }
+
+  void* __wrap_calloc(size_t num, size_t size) {
+    check("calloc", num * size);
+    return __real_calloc(num, size);
+  }
+
+  void* __wrap_memalign(size_t align, size_t size) {
+    check("memalign", size);
+    return __real_memalign(align, size);
+  }
+}
+
+#endif
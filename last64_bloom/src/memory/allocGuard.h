@@ -0,0 +1,26 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#pragma once
+
+// Set to 1 (e.g. via 'make ALLOC_TRIPWIRE=1') to assert on heap allocations while the guard is armed.
+// This wraps malloc/free at link time, so it also catches 'new', 'std::vector' and libdragon itself.
+#ifndef ALLOC_TRIPWIRE
+  #define ALLOC_TRIPWIRE 0
+#endif
+
+/**
+ * Tripwire for heap usage inside the frame loop.
+ * Between 'arm' and 'disarm' any malloc/free/realloc/memalign asserts with the given section name.
+ */
+namespace AllocGuard
+{
+  #if ALLOC_TRIPWIRE
+    void arm(const char* section);
+    void disarm();
+  #else
+    inline void arm(const char*) {}
+    inline void disarm() {}
+  #endif
+}
@@ -0,0 +1,23 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#include "arena.h"
+
+void* Arena::alloc(uint32_t size, uint32_t align) {
+  uint32_t start = (offset + align - 1) & ~(align - 1);
+  assertf(start + size <= capacity, "Arena full: %ld + %ld > %ld bytes", start, size, capacity);
+
+  offset = start + size;
+  if(offset > peak)peak = offset;
+  return buffer + start;
+}
+
+void Arena::reset() {
+  while(dtors) {
+    DtorEntry *entry = dtors;
+    dtors = entry->prev;
+    entry->dtor(entry->obj);
+  }
+  offset = 0;
+}
@@ -0,0 +1,59 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <libdragon.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Bump allocator over a fixed buffer, for objects that all die at the same time (e.g. one round).
+ * Allocations are O(1) and never touch the heap, 'reset' releases everything at once.
+ * Objects made via 'create' get their destructors called by 'reset', newest first.
+ */
+class Arena
+{
+  private:
+    struct DtorEntry {
+      DtorEntry *prev;
+      void (*dtor)(void*);
+      void *obj;
+    };
+
+    uint8_t *buffer;
+    uint32_t capacity;
+    uint32_t offset{0};
+    uint32_t peak{0};
+    DtorEntry *dtors{nullptr};
+
+  public:
+    Arena(void *buffer, uint32_t capacity) : buffer{(uint8_t*)buffer}, capacity{capacity} {}
+    ~Arena() { reset(); }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // Asserts if the arena is full
+    void* alloc(uint32_t size, uint32_t align = 8);
+
+    template<typename T, typename... Args>
+    T* create(Args&&... args) {
+      void *mem = alloc(sizeof(T), alignof(T));
+      T *obj = new(mem) T(std::forward<Args>(args)...);
+      if constexpr(!std::is_trivially_destructible_v<T>) {
+        auto *entry = (DtorEntry*)alloc(sizeof(DtorEntry), alignof(DtorEntry));
+        *entry = {dtors, [](void *p) { static_cast<T*>(p)->~T(); }, obj};
+        dtors = entry;
+      }
+      return obj;
+    }
+
+    // Destroys all objects and rewinds the buffer
+    void reset();
+
+    uint32_t getUsed() const { return offset; }
+    uint32_t getPeak() const { return peak; }
+    uint32_t getCapacity() const { return capacity; }
+};
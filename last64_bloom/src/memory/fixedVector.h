@@ -0,0 +1,51 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <libdragon.h>
+
+/**
+ * Vector with inline storage for up to 'N' elements, never allocates.
+ * Meant for small lists on hot paths that would otherwise be a 'std::vector'.
+ * Only supports trivially copyable types, elements are moved with plain assignments.
+ */
+template<typename T, uint32_t N>
+class FixedVector
+{
+  private:
+    T data[N]{};
+    uint32_t count{0};
+
+  public:
+    constexpr static uint32_t CAPACITY = N;
+
+    T* begin() { return data; }
+    T* end() { return data + count; }
+    const T* begin() const { return data; }
+    const T* end() const { return data + count; }
+
+    T& operator[](uint32_t idx) { return data[idx]; }
+    const T& operator[](uint32_t idx) const { return data[idx]; }
+
+    uint32_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == N; }
+
+    void clear() { count = 0; }
+
+    void push_back(const T &value) {
+      assertf(count < N, "FixedVector full (%ld)", N);
+      data[count++] = value;
+    }
+
+    // Removes [first, last) while keeping the order, returns the element after the removed range
+    T* erase(T *first, T *last) {
+      T *dst = first;
+      for(T *src = last; src != end(); ++src, ++dst)*dst = *src;
+      count -= last - first;
+      return first;
+    }
+
+    T* erase(T *pos) { return erase(pos, pos + 1); }
+};
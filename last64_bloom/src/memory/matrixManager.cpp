@@ -9,56 +9,152 @@ namespace {
   constexpr uint32_t MATRIX_COUNT = 64 * 3;
 
   constexpr uint32_t FLAG_BITS = sizeof(uint32_t)*8;
+  constexpr uint32_t FLAG_WORDS = MATRIX_COUNT / FLAG_BITS;
   static_assert(MATRIX_COUNT % FLAG_BITS == 0);
+  static_assert(MATRIX_COUNT <= 256); // freelists store 8-bit indices
 
-  uint32_t usedFlags[MATRIX_COUNT / FLAG_BITS]{};
-  uint32_t laseIndex = 0;
+  // Recently freed spans of the common sizes, reused in O(1).
+  // Entries are only hints, a span may have been taken by a bigger request in the meantime,
+  // so they are checked against the flags before being handed out.
+  constexpr uint32_t FREELIST_SIZES[] = {1, RingMat4FP::COUNT};
+  constexpr uint32_t FREELIST_CLASSES = sizeof(FREELIST_SIZES) / sizeof(FREELIST_SIZES[0]);
+  constexpr uint32_t FREELIST_CAPACITY = 32;
+
+  struct FreeList {
+    uint8_t start[FREELIST_CAPACITY];
+    uint32_t count;
+  };
+
+  FreeList freeLists[FREELIST_CLASSES]{};
+
+  // mask of used matrices, each bit represents one matrix.
+  // Matrix 0 is the MSB of the first word, so 'clz' finds the lowest index first
+  uint32_t usedFlags[FLAG_WORDS]{};
+  uint32_t usedCount = 0;
+  uint32_t peakUsed = 0;
+  uint32_t failedAllocs = 0;
   T3DMat4FP *bufferPtr{nullptr};
 
-  T3DMat4FP buffer[MATRIX_COUNT]{}; // mask of used matrices, each bit represents one matrix
+  T3DMat4FP buffer[MATRIX_COUNT]{};
+
+  int getSizeClass(uint32_t count) {
+    for(uint32_t c=0; c<FREELIST_CLASSES; ++c) {
+      if(FREELIST_SIZES[c] == count)return c;
+    }
+    return -1;
+  }
+
+  // First index >= 'idx' that is free (or used), MATRIX_COUNT if there is none
+  uint32_t findNext(uint32_t idx, bool findFree) {
+    uint32_t w = idx / FLAG_BITS;
+    if(w >= FLAG_WORDS)return MATRIX_COUNT;
+
+    uint32_t invert = findFree ? 0xFFFF'FFFF : 0;
+    uint32_t bits = (usedFlags[w] ^ invert) & (0xFFFF'FFFFu >> (idx % FLAG_BITS));
+    while(bits == 0) {
+      if(++w == FLAG_WORDS)return MATRIX_COUNT;
+      bits = usedFlags[w] ^ invert;
+    }
+    return w * FLAG_BITS + __builtin_clz(bits);
+  }
+
+  // Sets or clears the flags of a span, which may cross word boundaries
+  void setRange(uint32_t idx, uint32_t count, bool used) {
+    while(count > 0) {
+      uint32_t bit = idx % FLAG_BITS;
+      uint32_t n = count < (FLAG_BITS - bit) ? count : (FLAG_BITS - bit);
+      uint32_t mask = (uint32_t)((0xFFFF'FFFFull >> bit) & ~(0xFFFF'FFFFull >> (bit + n)));
+      if(used) {
+        usedFlags[idx / FLAG_BITS] |= mask;
+      } else {
+        usedFlags[idx / FLAG_BITS] &= ~mask;
+      }
+      idx += n;
+      count -= n;
+    }
+  }
+
+  bool isRangeFree(uint32_t idx, uint32_t count) {
+    return findNext(idx, false) >= idx + count;
+  }
+
+  T3DMat4FP *take(uint32_t idx, uint32_t count) {
+    setRange(idx, count, true);
+    usedCount += count;
+    if(usedCount > peakUsed)peakUsed = usedCount;
+    return bufferPtr + idx;
+  }
 }
 
 void MatrixManager::reset() {
   data_cache_hit_writeback_invalidate(buffer, MATRIX_COUNT * sizeof(T3DMat4FP));
   bufferPtr = (T3DMat4FP*)UncachedAddr(buffer);
-  laseIndex = 0;
   memset(usedFlags, 0, sizeof(usedFlags));
+  memset(freeLists, 0, sizeof(freeLists));
+  usedCount = 0;
+  peakUsed = 0;
+  failedAllocs = 0;
   debugf("MatrixManager: count=%ld size=%ldkb\n", MATRIX_COUNT, sizeof(T3DMat4FP) * MATRIX_COUNT / 1024);
 }
 
 T3DMat4FP *MatrixManager::alloc(uint32_t count) {
-  uint32_t countMask = (1 << count) - 1;
-  for(uint32_t i=0; i<MATRIX_COUNT/FLAG_BITS; ++i) {
-    uint32_t idx = (laseIndex + i) % (MATRIX_COUNT / FLAG_BITS);
-
-    // we only consider contiguous blocks of free matrices
-    for(uint32_t b=0; b<FLAG_BITS-count; ++b)
-    {
-      uint32_t mask = countMask << b;
-      if((usedFlags[idx] & mask) == 0) {
-        usedFlags[idx] |= mask;
-        laseIndex = idx;
-        return bufferPtr + (idx * FLAG_BITS + b);
-      }
+  if(count == 0)return nullptr;
+
+  int sizeClass = getSizeClass(count);
+  if(sizeClass >= 0) {
+    FreeList &list = freeLists[sizeClass];
+    while(list.count > 0) {
+      uint32_t idx = list.start[--list.count];
+      if(isRangeFree(idx, count))return take(idx, count);
     }
   }
 
-  debugf("##### MatrixManager: Out of matrices!\n");
+  // first-fit, jumping from one free range to the next
+  uint32_t idx = findNext(0, true);
+  while(idx < MATRIX_COUNT) {
+    uint32_t end = findNext(idx, false);
+    if(end - idx >= count)return take(idx, count);
+    idx = findNext(end, true);
+  }
+
+  ++failedAllocs;
+  debugf("##### MatrixManager: Out of matrices! (count=%ld, used=%ld)\n", count, usedCount);
   return nullptr;
 }
 
 void MatrixManager::free(T3DMat4FP *mat, uint32_t count) {
-  uint32_t idx = (mat - bufferPtr) / FLAG_BITS;
-  uint32_t countMask = (1 << count) - 1;
-  uint32_t b = (mat - bufferPtr) % FLAG_BITS;
-  usedFlags[idx] &= ~(countMask << b);
+  if(!mat)return;
+  uint32_t idx = mat - bufferPtr;
+  assertf(idx + count <= MATRIX_COUNT, "Matrix not owned by MatrixManager: %p", mat);
+
+  setRange(idx, count, false);
+  usedCount -= count;
+
+  int sizeClass = getSizeClass(count);
+  if(sizeClass >= 0) {
+    FreeList &list = freeLists[sizeClass];
+    if(list.count < FREELIST_CAPACITY) {
+      list.start[list.count++] = idx;
+    }
+  }
 }
 
 bool MatrixManager::isUsed(uint32_t index) {
-  return usedFlags[index / FLAG_BITS] & (1 << (index % FLAG_BITS));
+  return usedFlags[index / FLAG_BITS] & (0x8000'0000u >> (index % FLAG_BITS));
 }
 
 uint32_t MatrixManager::getTotalCapacity() {
   return MATRIX_COUNT;
 }
 
+MatrixManager::Stats MatrixManager::getStats() {
+  Stats stats{usedCount, peakUsed, 0, 0, failedAllocs};
+  uint32_t idx = findNext(0, true);
+  while(idx < MATRIX_COUNT) {
+    uint32_t end = findNext(idx, false);
+    ++stats.freeSpans;
+    if(end - idx > stats.largestFreeSpan)stats.largestFreeSpan = end - idx;
+    idx = findNext(end, true);
+  }
+  return stats;
+}
@@ -6,13 +6,27 @@
 #include <t3d/t3d.h>
 
 namespace MatrixManager {
+  struct Stats {
+    uint32_t used;
+    uint32_t peakUsed;
+    uint32_t freeSpans;       // number of contiguous free ranges
+    uint32_t largestFreeSpan; // biggest request that can still succeed
+    uint32_t failedAllocs;
+  };
+
   void reset();
 
+  /**
+   * Allocates 'count' contiguous matrices, returns nullptr if no big enough span is free.
+   * Spans of 1 and 3 matrices (e.g. 'RingMat4FP') are recycled through freelists,
+   * other sizes do a first-fit search over the free ranges.
+   */
   T3DMat4FP* alloc(uint32_t count = 1);
   void free(T3DMat4FP* mat, uint32_t count = 1);
 
   uint32_t getTotalCapacity();
   bool isUsed(uint32_t index);
+  Stats getStats();
 }
 
 struct BuffMat4FP {
@@ -1,82 +1,115 @@
 #include "postProcess.h"
 #include "rsp/rspFX.h"
+#include "profiler.h"
 #include <utility>
 
 namespace {
-  constexpr bool MEASURE_PERF = false;
-
-  constexpr int SCREEN_WIDTH = 320;
-  constexpr int SCREEN_HEIGHT = 240;
   constexpr int SCALE_FACTOR = 4;
+  // histogram range used for the scene luminance, see 'getSceneLuma'
+  constexpr float LUMA_PERCENTILE_LOW = 0.50f;
+  constexpr float LUMA_PERCENTILE_HIGH = 0.95f;
+
+  // Bloom reuse: frames a bloom may be reused for, max. relative change of luminance/exposure,
+  // and how much the camera may move (relative to the distance to its target) or turn
+  constexpr uint32_t BLOOM_REUSE_MAX_AGE = 1;
+  constexpr float BLOOM_REUSE_LUMA_DELTA = 0.05f;
+  constexpr float BLOOM_REUSE_CAM_POS_DELTA = 0.01f;
+  constexpr float BLOOM_REUSE_CAM_DIR_DOT = 0.9998f; // ~1.1deg
 
-  uint64_t t{};
+  bool relDiffAbove(float value, float ref, float threshold) {
+    return fabsf(value - ref) > threshold * fmaxf(ref, 1.0f / 256.0f);
+  }
 }
 
 PostProcess::PostProcess()
 {
-  assertf(display_get_width() == SCREEN_WIDTH, "Ucode can only handle 320x240 resolution");
-  assertf(display_get_height() == SCREEN_HEIGHT, "Ucode can only handle 320x240 resolution");
+  int width = display_get_width();
+  int height = display_get_height();
+  assertf(width % 32 == 0 && width <= RspFX::BLUR_MAX_WIDTH * SCALE_FACTOR, "Unsupported width for the ucode: %d", width);
+  assertf(height % SCALE_FACTOR == 0, "Unsupported height for the ucode: %d", height);
 
-  int sizeLowX = display_get_width() / SCALE_FACTOR;
-  int sizeLowY = display_get_height() / SCALE_FACTOR;
+  int sizeLowX = width / SCALE_FACTOR;
+  int sizeLowY = height / SCALE_FACTOR;
 
-  surfHDR = surface_alloc(FMT_RGBA32, display_get_width(), display_get_height() + 4);
+  for(int i=0; i<HDR_COUNT; ++i) {
+    surfHDR[i] = surface_alloc(FMT_RGBA32, width, height + 4);
+    surfHDRSafe[i] = surface_make_sub(&surfHDR[i], 0, 2, width, height);
+    // no histogram exists before the first frame was processed
+    memset((char*)surfHDRSafe[i].buffer + surfHDRSafe[i].stride * height, 0, surfHDRSafe[i].stride);
+  }
   surfBlurA = surface_alloc(FMT_RGBA32, sizeLowX, sizeLowY + 4);
   surfBlurB = surface_alloc(FMT_RGBA32, sizeLowX, sizeLowY + 4);
 
-  surfHDRSafe = surface_make_sub(&surfHDR, 0, 2, surfHDR.width, display_get_height());
   surfBlurASafe = surface_make_sub(&surfBlurA, 0, 2, surfBlurA.width, sizeLowY);
   surfBlurBSafe = surface_make_sub(&surfBlurB, 0, 2, surfBlurB.width, sizeLowY);
+
+  // recorded upfront, so that switching on 'scalingUseRDP' doesn't allocate inside the frame loop
+  for(int i=0; i<HDR_COUNT; ++i) {
+    blockRDPScale[i][0] = recordRDPScale(surfHDRSafe[i], surfBlurASafe);
+    blockRDPScale[i][1] = recordRDPScale(surfHDRSafe[i], surfBlurBSafe);
+  }
 }
 
 PostProcess::~PostProcess()
 {
   surface_free(&surfBlurB);
   surface_free(&surfBlurA);
-  surface_free(&surfHDR);
-  if(blockRDPScale)rspq_block_free(blockRDPScale);
+  for(int i=0; i<HDR_COUNT; ++i) {
+    surface_free(&surfHDR[i]);
+    for(auto block : blockRDPScale[i])rspq_block_free(block);
+  }
 }
 
 void PostProcess::beginFrame()
 {
-  rdpq_set_color_image(&surfHDRSafe);
+  // Sync point for the shared buffers: the RSP only continues once the RDP has finished the last frame.
+  // 'applyEffects' reads the last HDR buffer (scene) and its downscale (queued in the last 'endFrame'),
+  // and writes the blur buffers the debug view of the last frame may still read from.
+  // The fence has to come before 'applyEffects', and this is the cheapest spot for it:
+  // it only waits for the 2D/debug tail of the last frame, any later fence would also wait for this scene.
+  // The cost is an RSP stall while the RDP is still behind, plus an idle RDP until the first
+  // triangles of this frame arrive. Both show up as RDP wait/busy time in the profiler overlay.
+  rdpq_fence();
+  rdpq_set_color_image(&surfHDRSafe[hdrIdx]);
 }
 
-void PostProcess::endFrame()
+rspq_block_t* PostProcess::recordRDPScale(surface_t &src, surface_t &dst)
 {
-  if(!conf.scalingUseRDP)return;
+  rspq_block_begin();
+  rdpq_sync_pipe();
+  rdpq_sync_load();
+  rdpq_set_mode_standard();
+
+  rdpq_mode_begin();
+    rdpq_mode_filter(FILTER_MEDIAN);
+    rdpq_mode_antialias(AA_NONE);
+    rdpq_mode_dithering(DITHER_NONE_NONE);
+    rdpq_mode_blender(0);
 
-  if(!blockRDPScale)
+    rdpq_mode_combiner(RDPQ_COMBINER2(
+      (TEX0,TEX1,PRIM_ALPHA,TEX1), (0,0,0,1),
+      (0,0,0,COMBINED),            (0,0,0,1)
+    ));
+  rdpq_mode_end();
+
+  rdpq_texparms_t texParam0{};
+  texParam0.s.scale_log = -2;
+  texParam0.s.translate = 1.5f;
+  texParam0.t.translate = 0.5f;
+  auto texParam1 = texParam0;
+  texParam1.s.translate += 2.0f;
+
+  rdpq_set_prim_color({0,0,0, 0x100/2});
+  rdpq_set_color_image(&dst);
+  for(int y=0; y<dst.height; ++y)
   {
-    rspq_block_begin();
-    rdpq_sync_pipe();
-    rdpq_sync_load();
-    rdpq_set_mode_standard();
-
-    rdpq_mode_begin();
-      rdpq_mode_filter(FILTER_MEDIAN);
-      rdpq_mode_antialias(AA_NONE);
-      rdpq_mode_dithering(DITHER_NONE_NONE);
-      rdpq_mode_blender(0);
-
-      rdpq_mode_combiner(RDPQ_COMBINER2(
-        (TEX0,TEX1,PRIM_ALPHA,TEX1), (0,0,0,1),
-        (0,0,0,COMBINED),            (0,0,0,1)
-      ));
-    rdpq_mode_end();
-
-    rdpq_texparms_t texParam0{};
-    texParam0.s.scale_log = -2;
-    texParam0.s.translate = 1.5f;
-    texParam0.t.translate = 0.5f;
-    auto texParam1 = texParam0;
-    texParam1.s.translate += 2.0f;
-
-    rdpq_set_prim_color({0,0,0, 0x100/2});
-    rdpq_set_color_image(&surfBlurASafe);
-    for(int y=0; y<surfBlurASafe.height; ++y)
+    // two RGBA32 lines of more than 320 pixels won't fit into TMEM, so split them up
+    for(int x=0; x<src.width; x += RspFX::TILE_WIDTH)
     {
-      auto surfSub = surface_make_sub(&surfHDRSafe, 0, y*4, surfHDRSafe.width, 2);
+      int tileWidth = src.width - x;
+      if(tileWidth > RspFX::TILE_WIDTH)tileWidth = RspFX::TILE_WIDTH;
+
+      auto surfSub = surface_make_sub(&src, x, y*4, tileWidth, 2);
       surfSub.stride *= 2; // load every other line
 
       rdpq_tex_multi_begin();
@@ -84,63 +117,153 @@ void PostProcess::endFrame()
         rdpq_tex_reuse(TILE1, &texParam1);
       rdpq_tex_multi_end();
 
-      rdpq_texture_rectangle(TILE0, 0, y, surfBlurASafe.width, y+1, 1, 1);
+      rdpq_texture_rectangle(TILE0, x / SCALE_FACTOR, y, (x + tileWidth) / SCALE_FACTOR, y+1, 1, 1);
     }
-    blockRDPScale = rspq_block_end();
   }
+  return rspq_block_end();
+}
 
-  rspq_block_run(blockRDPScale);
+bool PostProcess::bloomConfMatches() const
+{
+  // exposure and blur settings are baked into the bloom
+  return conf.blurSteps == bloomConf.blurSteps
+    && conf.blurBrightness == bloomConf.blurBrightness
+    && conf.bloomThreshold == bloomConf.bloomThreshold
+    && !relDiffAbove(conf.hdrFactor, bloomConf.hdrFactor, BLOOM_REUSE_LUMA_DELTA);
 }
 
-surface_t& PostProcess::applyEffects(surface_t &dst)
+bool PostProcess::canReuseBloom() const
 {
-  if constexpr (MEASURE_PERF) {
-    rspq_wait();
-    rspq_highpri_begin();
-    t = get_ticks();
-  }
+  if(!conf.bloomReuse || !blurResult || bloomAge >= BLOOM_REUSE_MAX_AGE)return false;
+  if(!bloomConfMatches())return false;
 
-  surface_t *input = &surfBlurBSafe;
-  surface_t *output = &surfBlurASafe;
+  // the histogram of the new image is only known after its HDR pass, so use the change between the last two
+  if(relDiffAbove(lumaAvg, lumaLast, BLOOM_REUSE_LUMA_DELTA))return false;
 
-  float bloomFactor = conf.hdrFactor * 0.5f * conf.blurBrightness;
+  // the bloom would be combined with the image drawn in this frame, with a moving camera it would visibly trail behind
+  const T3DVec3 &pos = camPos[hdrIdx];
+  T3DVec3 dir = camTarget[hdrIdx] - pos;
+  T3DVec3 dirBloom = bloomCamTarget - bloomCamPos;
+  float dist = t3d_vec3_len(dir);
+  float distBloom = t3d_vec3_len(dirBloom);
+  if(t3d_vec3_distance(pos, bloomCamPos) > dist * BLOOM_REUSE_CAM_POS_DELTA)return false;
+  return t3d_vec3_dot(dir, dirBloom) >= dist * distBloom * BLOOM_REUSE_CAM_DIR_DOT;
+}
 
-  int blurSteps = conf.blurSteps;
-  if(blurSteps > 0 && bloomFactor <= 0.0f) {
-    blurSteps = 1;
-  }
+void PostProcess::endFrame()
+{
+  // decided here already, since a reused bloom doesn't need the RDP downscale either
+  reuseBloom = canReuseBloom();
 
-  // First Pass, downscale image 4:1 with interpolation
-  if(!conf.scalingUseRDP) {
-    RspFX::downscale(surfHDRSafe.buffer, output->buffer);
+  blurScaled = nullptr;
+  if(conf.scalingUseRDP && !reuseBloom)
+  {
+    // keep the last blur result intact, it may still be shown by the debug view
+    int target = (blurResult == &surfBlurASafe) ? 1 : 0;
+    blurScaled = target ? &surfBlurBSafe : &surfBlurASafe;
+    rspq_block_run(blockRDPScale[hdrIdx][target]);
   }
 
-  // Now blur the smaller image N amount of times by ping-ponging the buffers
-  for(int i=0; i<blurSteps; ++i) {
-    std::swap(input, output);
-    RspFX::blur(
-      input->buffer, output->buffer,
-      (i == blurSteps-1) ? bloomFactor : 1.0f,
-      (i == 0) ? conf.bloomThreshold : 0.0f
-    );
+  hdrIdx = (hdrIdx + 1) % HDR_COUNT;
+}
+
+surface_t& PostProcess::applyEffects(surface_t &dst)
+{
+  // RSP time of the effects is reported by the 'rsp_fx' slot of the profiler
+  PROFILE_SCOPE("apply-fx");
+
+  int hdrIdxLast = (hdrIdx + HDR_COUNT - 1) % HDR_COUNT;
+  surface_t &surfHDRLast = surfHDRSafe[hdrIdxLast];
+
+  // the exposure of this frame was not known when reuse was decided, the bloom must match the one used below
+  if(reuseBloom && !bloomConfMatches())reuseBloom = false;
+
+  surface_t *output = blurResult;
+  if(reuseBloom) {
+    // keep the bloom of the last frame, only the HDR pass runs
+    ++bloomAge;
+  } else {
+    // the downscaled image is the input for the first blur
+    output = blurScaled ? blurScaled : &surfBlurASafe;
+    surface_t *input = (output == &surfBlurASafe) ? &surfBlurBSafe : &surfBlurASafe;
+
+    float bloomFactor = conf.hdrFactor * 0.5f * conf.blurBrightness;
+
+    int blurSteps = conf.blurSteps;
+    if(blurSteps > 0 && bloomFactor <= 0.0f) {
+      blurSteps = 1;
+    }
+
+    // First Pass, downscale image 4:1 with interpolation
+    if(!blurScaled) {
+      RspFX::downscale(surfHDRLast, *output);
+    }
+
+    // Now blur the smaller image N amount of times by ping-ponging the buffers
+    for(int i=0; i<blurSteps; ++i) {
+      std::swap(input, output);
+      RspFX::blur(
+        *input, *output,
+        (i == blurSteps-1) ? bloomFactor : 1.0f,
+        (i == 0) ? conf.bloomThreshold : 0.0f
+      );
+    }
+
+    bloomAge = 0;
+    bloomConf = conf;
+    bloomCamPos = camPos[hdrIdxLast];
+    bloomCamTarget = camTarget[hdrIdxLast];
   }
+  bloomReuseRate += ((reuseBloom ? 1.0f : 0.0f) - bloomReuseRate) * 0.05f;
 
   // Combine original image and blurred image in a combined HDR+Bloom pass
-  RspFX::hdrBlit(surfHDRSafe.buffer, dst.buffer, output->buffer, conf.hdrFactor);
-
-  // Read back image brightness, this is not synced here since we can live with a delay
-  uint32_t *imgBrightness = (uint32_t*)(((char*)surfHDRSafe.buffer) + surfHDRSafe.stride * (surfHDRSafe.height));
-  //debugf("imgBrightness: %08lX\n", *imgBrightness);
-  relBrightness = (float)(*imgBrightness >> 8) / (float)0x94BA;
-
-  if constexpr (MEASURE_PERF) {
-    rspq_highpri_end();
-    rspq_flush();
-    rspq_highpri_sync();
-    t = get_ticks() - t;
-    double ticksMS = (double)t / (double)TICKS_PER_SECOND * 1000.0f;
-    debugf("RSP-FX: %.4fms (%.4f)\n", ticksMS, ticksMS - 8.748);
+  RspFX::hdrBlit(surfHDRLast, dst, *output, conf.hdrFactor);
+
+  // Read back the luminance histogram, this is not synced here since we can live with a delay
+  // Each strip stores its own histogram below the image, at the column it started in
+  char *rowBelow = (char*)surfHDRLast.buffer + surfHDRLast.stride * surfHDRLast.height;
+  for(auto &count : lumaHistogram)count = 0;
+  for(int x=0; x<surfHDRLast.width; x += RspFX::TILE_WIDTH) {
+    auto *stripHistogram = (uint32_t*)(rowBelow + x * 4);
+    for(int b=0; b<RspFX::LUMA_BIN_COUNT; ++b) {
+      lumaHistogram[b] += stripHistogram[b];
+    }
   }
+  lumaLast = lumaAvg;
+  updateLumaStats();
 
+  blurResult = output;
   return *output;
 }
+
+void PostProcess::updateLumaStats()
+{
+  uint32_t total = 0;
+  for(auto count : lumaHistogram)total += count;
+  if(total == 0)return;
+
+  float rangeStart = total * LUMA_PERCENTILE_LOW;
+  float rangeEnd = total * LUMA_PERCENTILE_HIGH;
+
+  float sumLuma = 0.0f;
+  float sumLog = 0.0f;
+  float sumWeight = 0.0f;
+  float binStart = 0.0f;
+
+  for(int b=0; b<RspFX::LUMA_BIN_COUNT; ++b) {
+    float count = (float)lumaHistogram[b];
+    float binLuma = RspFX::lumaBinValue(b);
+    sumLuma += count * binLuma;
+
+    // only the part of the bin inside the percentile range counts
+    float weight = fminf(binStart + count, rangeEnd) - fmaxf(binStart, rangeStart);
+    if(weight > 0.0f) {
+      sumLog += weight * log2f(binLuma);
+      sumWeight += weight;
+    }
+    binStart += count;
+  }
+
+  lumaAvg = sumLuma / total;
+  if(sumWeight > 0.0f)lumaKey = exp2f(sumLog / sumWeight);
+}
\ No newline at end of file
@@ -4,6 +4,7 @@
 */
 #pragma once
 #include <libdragon.h>
+#include "rsp/rspFX.h"
 
 struct PostProcessConf {
   int blurSteps{}; // how often to blur the low-res image
@@ -11,33 +12,83 @@ struct PostProcessConf {
   float hdrFactor{}; // HDR exposure factor, 1.0 to get standard color range
   float bloomThreshold{}; // threshold to ignore pixels before blurring
   bool scalingUseRDP{}; // if true, use RDP for initial downscaling
+  bool bloomReuse{}; // if true, skip the downscale & blur every other frame while the scene stays similar
 };
 
+/**
+ * HDR rendering with bloom, effects are applied with one frame of delay.
+ * The scene is drawn into one of two HDR buffers while the other one (last frame) is processed,
+ * all intermediate buffers are shared between frames.
+ */
 class PostProcess
 {
   private:
-    surface_t surfHDR{};
+    static constexpr int HDR_COUNT = 2;
+
+    surface_t surfHDR[HDR_COUNT]{};
     surface_t surfBlurA{};
     surface_t surfBlurB{};
 
     // subsection of the above to allow OOB access in the ucode
-    surface_t surfHDRSafe{};
+    surface_t surfHDRSafe[HDR_COUNT]{};
     surface_t surfBlurASafe{};
     surface_t surfBlurBSafe{};
-    rspq_block_t *blockRDPScale{nullptr};
+    rspq_block_t *blockRDPScale[HDR_COUNT][2]{}; // per HDR buffer and blur target
 
     PostProcessConf conf{};
-    float relBrightness{0.0f};
+    uint32_t lumaHistogram[RspFX::LUMA_BIN_COUNT]{};
+    float lumaAvg{0.0f};
+    float lumaKey{0.0f};
+
+    uint32_t hdrIdx{0}; // buffer the current frame is drawn into
+    surface_t *blurScaled{nullptr}; // RDP downscale of the last frame, if any
+    surface_t *blurResult{nullptr}; // output of the last 'applyEffects'
+
+    // state of the current bloom, to check if it can be reused
+    bool reuseBloom{false};
+    uint32_t bloomAge{0};
+    PostProcessConf bloomConf{};
+    T3DVec3 bloomCamPos{}; // camera of the HDR image the bloom was made from
+    T3DVec3 bloomCamTarget{};
+    T3DVec3 camPos[HDR_COUNT]{}; // camera each HDR buffer was drawn with
+    T3DVec3 camTarget[HDR_COUNT]{};
+    float lumaLast{0.0f}; // 'lumaAvg' of the frame before
+    float bloomReuseRate{0.0f};
+
+    rspq_block_t* recordRDPScale(surface_t &src, surface_t &dst);
+    void updateLumaStats();
+    bool bloomConfMatches() const;
+    bool canReuseBloom() const;
 
   public:
     PostProcess();
     ~PostProcess();
 
     void setConf(const PostProcessConf &config) { conf = config; }
+    // Camera the current frame was drawn with, movement forces a bloom update if 'bloomReuse' is set
+    void setCamera(const T3DVec3 &pos, const T3DVec3 &target) {
+      camPos[hdrIdx] = pos;
+      camTarget[hdrIdx] = target;
+    }
 
+    // Sets the HDR buffer as the render target, call before drawing the scene.
+    // Also waits for the RDP to finish the last frame, since the buffers are shared.
     void beginFrame();
-    void endFrame();
+    // Processes the last frame into 'dst', call after drawing the scene
     surface_t &applyEffects(surface_t& dst);
+    // Finishes the current frame, call after 'applyEffects'
+    void endFrame();
+
+    // Average brightness of the last frame after exposure (0.0 - 1.0)
+    float getBrightness() const { return lumaAvg * conf.hdrFactor; }
+
+    /**
+     * Luminance (0.0 - 1.0) of the last frame before exposure, used for auto-exposure.
+     * This is the log-average between the 50th and 95th percentile of the histogram,
+     * so dark areas and small highlights don't pull it around. Zero if nothing was sampled yet.
+     */
+    float getSceneLuma() const { return lumaKey; }
 
-    float getBrightness() const { return relBrightness; }
+    // Share of recent frames that skipped the downscale & blur (0.0 - 1.0)
+    float getBloomReuseRate() const { return bloomReuseRate; }
 };
@@ -0,0 +1,244 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#include "profiler.h"
+#include "render/debugDraw.h"
+#include <string.h>
+
+#if PROFILER_ENABLED
+
+namespace
+{
+  constexpr uint32_t INVALID_ZONE = 0xFFFF'FFFF;
+  constexpr float FRAME_BUDGET_MS = 1000.0f / 30.0f;
+  constexpr uint32_t BAR_CHARS = 20;
+  constexpr uint32_t MAX_RSP_SLOTS = 8;
+
+  struct Zone
+  {
+    const char* name;
+    uint32_t start;
+    uint32_t ticks;
+    uint32_t depth;
+  };
+
+  struct Frame
+  {
+    Zone zones[Profiler::MAX_ZONES];
+    uint32_t zoneCount;
+    uint32_t start;
+    uint32_t ticks;
+  };
+
+  struct RspSlot
+  {
+    const char* name;
+    float timeMs;
+  };
+
+  constinit Frame frames[Profiler::FRAME_HISTORY]{};
+  constinit uint32_t frameIdx{0};
+  constinit uint32_t frameCount{0};
+
+  constinit uint32_t zoneStack[Profiler::MAX_DEPTH]{};
+  constinit uint32_t depth{0};
+
+  constinit RspSlot rspSlots[MAX_RSP_SLOTS]{};
+  constinit uint32_t rspSlotCount{0};
+  constinit float rspTotalMs{0.0f};
+  constinit float rdpBusyMs{0.0f};
+
+  constinit Profiler::ZoneTotal totals[Profiler::MAX_ZONES]{};
+  constinit uint32_t totalCount{0};
+  constinit uint64_t totalFrameTicks{0};
+  constinit uint32_t totalFrames{0};
+
+  constinit bool showOverlay{false};
+  constinit bool logCSV{false};
+
+  float ticksToMs(uint64_t ticks) {
+    return (float)ticks * (1000.0f / (float)TICKS_PER_SECOND);
+  }
+
+  float rcpTicksToMs(uint64_t ticks, uint64_t frames) {
+    if(frames == 0)return 0.0f;
+    return (float)(((ticks * 1000000ULL) / RCP_FREQUENCY) / frames) / 1000.0f;
+  }
+
+  /**
+   * Average time of a zone over the history.
+   * Zones usually appear in the same order each frame, so the same index is checked first.
+   */
+  float getAverageMs(uint32_t zoneIdx, const Zone &zone)
+  {
+    uint64_t ticks = 0;
+    uint32_t count = frameCount < Profiler::FRAME_HISTORY ? frameCount : Profiler::FRAME_HISTORY;
+    if(count == 0)return 0.0f;
+
+    for(uint32_t f=0; f<count; ++f) {
+      const Frame &frame = frames[f];
+      if(zoneIdx < frame.zoneCount && frame.zones[zoneIdx].name == zone.name) {
+        ticks += frame.zones[zoneIdx].ticks;
+        continue;
+      }
+      for(uint32_t z=0; z<frame.zoneCount; ++z) {
+        if(frame.zones[z].name == zone.name && frame.zones[z].depth == zone.depth) {
+          ticks += frame.zones[z].ticks;
+          break;
+        }
+      }
+    }
+    return ticksToMs(ticks) / count;
+  }
+
+  void addToTotals(const Frame &frame)
+  {
+    for(uint32_t z=0; z<frame.zoneCount; ++z) {
+      const Zone &zone = frame.zones[z];
+      uint32_t t = 0;
+      while(t < totalCount && (totals[t].name != zone.name || totals[t].depth != zone.depth))++t;
+      if(t == totalCount) {
+        if(totalCount == Profiler::MAX_ZONES)continue;
+        totals[totalCount++] = {zone.name, zone.depth, 0, 0};
+      }
+      totals[t].ticks += zone.ticks;
+      ++totals[t].calls;
+    }
+    totalFrameTicks += frame.ticks;
+    ++totalFrames;
+  }
+
+  void printBar(float posX, float posY, const char* name, uint32_t nameIndent, float timeMs)
+  {
+    char bar[BAR_CHARS + 1];
+    uint32_t len = (uint32_t)(timeMs / FRAME_BUDGET_MS * BAR_CHARS);
+    if(len > BAR_CHARS)len = BAR_CHARS;
+    memset(bar, '#', len);
+    bar[len] = '\0';
+
+    Debug::printf(posX + nameIndent * 7, posY, "%s", name);
+    Debug::printf(posX + 96, posY, "%5.2f %s", timeMs, bar);
+  }
+}
+
+void Profiler::beginFrame()
+{
+  Frame &frame = frames[frameIdx];
+  frame.zoneCount = 0;
+  frame.start = TICKS_READ();
+  depth = 0;
+}
+
+void Profiler::endFrame()
+{
+  Frame &frame = frames[frameIdx];
+  frame.ticks = TICKS_DISTANCE(frame.start, TICKS_READ());
+  addToTotals(frame);
+
+  ++frameCount;
+  frameIdx = (frameIdx + 1) % FRAME_HISTORY;
+  if(logCSV && frameIdx == 0)dumpCSV();
+}
+
+uint32_t Profiler::pushZone(const char* name)
+{
+  Frame &frame = frames[frameIdx];
+  if(frame.zoneCount == MAX_ZONES || depth == MAX_DEPTH)return INVALID_ZONE;
+
+  uint32_t idx = frame.zoneCount++;
+  frame.zones[idx] = {name, TICKS_READ(), 0, depth};
+  zoneStack[depth++] = idx;
+  return idx;
+}
+
+void Profiler::popZone(uint32_t zoneIdx)
+{
+  if(zoneIdx == INVALID_ZONE)return;
+  Zone &zone = frames[frameIdx].zones[zoneIdx];
+  zone.ticks = TICKS_DISTANCE(zone.start, TICKS_READ());
+  assertf(depth > 0 && zoneStack[depth-1] == zoneIdx, "Profiler zone '%s' popped out of order", zone.name);
+  --depth;
+}
+
+void Profiler::setRspData(const rspq_profile_data_t &data)
+{
+  rspSlotCount = 0;
+  for(auto &slot : data.slots) {
+    if(!slot.name || slot.sample_count == 0)continue;
+    if(rspSlotCount == MAX_RSP_SLOTS)break;
+    rspSlots[rspSlotCount++] = {slot.name, rcpTicksToMs(slot.total_ticks, data.frame_count)};
+  }
+  rspTotalMs = rcpTicksToMs(data.total_ticks, data.frame_count);
+  rdpBusyMs = rcpTicksToMs(data.rdp_busy_ticks, data.frame_count);
+}
+
+void Profiler::draw(float posX, float posY)
+{
+  if(!showOverlay || frameCount == 0)return;
+
+  // last completed frame defines the zone layout
+  const Frame &last = frames[(frameIdx + FRAME_HISTORY - 1) % FRAME_HISTORY];
+  Debug::printf(posX, posY, "CPU %5.2fms", ticksToMs(last.ticks));
+  posY += 10;
+
+  for(uint32_t z=0; z<last.zoneCount; ++z) {
+    const Zone &zone = last.zones[z];
+    printBar(posX, posY, zone.name, zone.depth, getAverageMs(z, zone));
+    posY += 8;
+  }
+
+  if(rspSlotCount == 0)return;
+  posY += 4;
+  printBar(posX, posY, "RSP", 0, rspTotalMs);
+  posY += 8;
+  for(uint32_t s=0; s<rspSlotCount; ++s) {
+    printBar(posX, posY, rspSlots[s].name, 1, rspSlots[s].timeMs);
+    posY += 8;
+  }
+  printBar(posX, posY, "RDP", 0, rdpBusyMs);
+}
+
+void Profiler::dumpCSV()
+{
+  uint32_t count = frameCount < FRAME_HISTORY ? frameCount : FRAME_HISTORY;
+  uint32_t firstFrame = frameCount - count;
+
+  debugf("frame,zone,depth,us\n");
+  for(uint32_t f=0; f<count; ++f) {
+    const Frame &frame = frames[(frameIdx + FRAME_HISTORY - count + f) % FRAME_HISTORY];
+    unsigned long frameNum = firstFrame + f;
+    debugf("%lu,frame,0,%lu\n", frameNum, (unsigned long)TICKS_TO_US(frame.ticks));
+    for(uint32_t z=0; z<frame.zoneCount; ++z) {
+      const Zone &zone = frame.zones[z];
+      debugf("%lu,%s,%lu,%lu\n", frameNum, zone.name, (unsigned long)zone.depth + 1, (unsigned long)TICKS_TO_US(zone.ticks));
+    }
+  }
+  for(uint32_t s=0; s<rspSlotCount; ++s) {
+    debugf("%lu,rsp:%s,0,%lu\n", (unsigned long)frameCount, rspSlots[s].name, (unsigned long)(rspSlots[s].timeMs * 1000.0f));
+  }
+  if(rspSlotCount) {
+    debugf("%lu,rdp,0,%lu\n", (unsigned long)frameCount, (unsigned long)(rdpBusyMs * 1000.0f));
+  }
+}
+
+const Profiler::ZoneTotal* Profiler::getTotals(uint32_t &count)
+{
+  count = totalCount;
+  return totals;
+}
+
+uint64_t Profiler::getTotalFrameTicks() { return totalFrameTicks; }
+uint32_t Profiler::getTotalFrames() { return totalFrames; }
+
+void Profiler::resetTotals()
+{
+  totalCount = 0;
+  totalFrameTicks = 0;
+  totalFrames = 0;
+}
+
+bool* Profiler::getShowOverlay() { return &showOverlay; }
+bool* Profiler::getLogCSV() { return &logCSV; }
+
+#endif
@@ -0,0 +1,75 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <libdragon.h>
+#include <rspq_profile.h>
+
+// Set to 1 (e.g. via N64_CXXFLAGS += -DPROFILER_ENABLED=1) to record CPU zones.
+// When disabled, 'PROFILE_SCOPE' compiles to nothing.
+#ifndef PROFILER_ENABLED
+  #define PROFILER_ENABLED 0
+#endif
+
+/**
+ * Hierarchical frame profiler.
+ * CPU time is measured with 'PROFILE_SCOPE("name")' zones which can be nested,
+ * the last FRAME_HISTORY frames are kept in a ring-buffer.
+ * RSP/RDP times are taken from the 'rspq_profile' data if RSPQ_PROFILE is enabled.
+ */
+namespace Profiler
+{
+  constexpr uint32_t FRAME_HISTORY = 32;
+  constexpr uint32_t MAX_ZONES = 32;
+  constexpr uint32_t MAX_DEPTH = 8;
+
+  struct Scope;
+
+  void beginFrame();
+  void endFrame();
+
+  // Zone names must be string literals, they are compared by address
+  uint32_t pushZone(const char* name);
+  void popZone(uint32_t zoneIdx);
+
+  // Stores the per-frame averages of a finished 'rspq_profile' measurement
+  void setRspData(const rspq_profile_data_t &data);
+
+  // Draws the averaged zones as a bar graph, expects 'Debug::printStart' to be called
+  void draw(float posX, float posY);
+  // Writes all frames in the history as CSV to the debug log (ISViewer/USB)
+  void dumpCSV();
+
+  struct ZoneTotal
+  {
+    const char* name;
+    uint32_t depth;
+    uint64_t ticks;
+    uint32_t calls;
+  };
+
+  // Zone times accumulated over all frames since the last 'resetTotals', used by the benchmark
+  const ZoneTotal* getTotals(uint32_t &count);
+  uint64_t getTotalFrameTicks();
+  uint32_t getTotalFrames();
+  void resetTotals();
+
+  bool* getShowOverlay();
+  bool* getLogCSV();
+
+  struct Scope
+  {
+    uint32_t zone;
+    explicit Scope(const char* name) : zone{pushZone(name)} {}
+    ~Scope() { popZone(zone); }
+  };
+}
+
+#if PROFILER_ENABLED
+  #define PROFILE_CONCAT_INNER(a, b) a##b
+  #define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+  #define PROFILE_SCOPE(name) Profiler::Scope PROFILE_CONCAT(profScope_, __LINE__){name}
+#else
+  #define PROFILE_SCOPE(name) ((void)0)
+#endif
@@ -0,0 +1,37 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#include "ptBatch.h"
+#include <libdragon.h>
+
+PTBatch::PTBatch(uint32_t maxSize, const T3DVec3 &center)
+  : countMax{(maxSize + 1) & ~1u}, center{center}
+{
+  particles = static_cast<TPXParticle*>(malloc_uncached(countMax * FRAME_COUNT * sizeof(TPXParticle) / 2));
+  mat = (T3DMat4FP*)malloc_uncached(sizeof(T3DMat4FP));
+  t3d_mat4fp_identity(mat);
+  t3d_mat4fp_from_scale_translate(mat, POS_STEP, center);
+}
+
+PTBatch::~PTBatch() {
+  free_uncached(particles);
+  free_uncached(mat);
+}
+
+void PTBatch::begin() {
+  frame = (frame + 1) % FRAME_COUNT;
+  count = 0;
+}
+
+void PTBatch::draw() {
+  if(count == 0)return;
+  // particles are drawn in pairs, hide the unused half of the last one
+  if(count & 1) {
+    *tpx_buffer_get_size(getFrameParticles(), count) = 0;
+  }
+
+  tpx_matrix_push(mat);
+  tpx_particle_draw(getFrameParticles(), (count + 1) & ~1u);
+  tpx_matrix_pop(1);
+}
@@ -0,0 +1,58 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <t3d/t3d.h>
+#include <t3d/tpx.h>
+
+/**
+ * TPX counterpart to 'QuadBatch': collects flat-colored sprites in world-space
+ * and draws all of them with a single 'tpx_particle_draw'.
+ * Positions are quantized into the 8-bit particle space spanning the play-field,
+ * so this is only meant for the screen-sized Last64 arena.
+ */
+struct PTBatch
+{
+  constexpr static uint32_t FRAME_COUNT = 3;
+  // world-units per particle-unit, +-127 must cover the arena around 'center'
+  constexpr static float POS_STEP = 1.28f;
+  // particle size per world-unit of half-size, approximates the triangle path
+  constexpr static float SIZE_PER_UNIT = 8.0f;
+
+  T3DMat4FP *mat{};
+  TPXParticle *particles{};
+  uint32_t countMax{};
+  uint32_t count{};
+  uint32_t frame{};
+
+  PTBatch(uint32_t maxSize, const T3DVec3 &center);
+  ~PTBatch();
+
+  PTBatch(const PTBatch&) = delete;
+  PTBatch& operator=(const PTBatch&) = delete;
+
+  // Switches to the next particle buffer and clears it, call once per frame before adding sprites
+  void begin();
+
+  void add(const T3DVec3 &pos, float halfSize, uint32_t color) {
+    if(count == countMax)return;
+    TPXParticle *pt = getFrameParticles();
+    int8_t *p = tpx_buffer_get_pos(pt, count);
+    p[0] = (int8_t)((pos.x - center.x) * (1.0f / POS_STEP));
+    p[1] = (int8_t)((pos.y - center.y) * (1.0f / POS_STEP));
+    p[2] = (int8_t)((pos.z - center.z) * (1.0f / POS_STEP));
+
+    float size = halfSize * SIZE_PER_UNIT;
+    *tpx_buffer_get_size(pt, count) = size > 127.0f ? 127 : (int8_t)size;
+    *tpx_buffer_get_color(pt, count) = color;
+    ++count;
+  }
+
+  // Draws all sprites added since 'begin', expects the TPX state and RDP mode to be set up
+  void draw();
+
+  private:
+    T3DVec3 center{};
+    [[nodiscard]] TPXParticle* getFrameParticles() const { return particles + frame * (countMax / 2); }
+};
@@ -0,0 +1,51 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#include "quadBatch.h"
+#include <libdragon.h>
+
+QuadBatch::QuadBatch(uint32_t maxQuads)
+  : countMax{maxQuads}
+{
+  T3DVec3 normalVec = {{0.0f, 0.0f, 1.0f}};
+  uint16_t norm = t3d_vert_pack_normal(&normalVec);
+
+  uint32_t vertCount = countMax * 2 * FRAME_COUNT;
+  verts = (T3DVertPacked*)malloc_uncached(sizeof(T3DVertPacked) * vertCount);
+  for(uint32_t i=0; i<vertCount; ++i) {
+    verts[i] = (T3DVertPacked){};
+    verts[i].normA = norm;
+    verts[i].normB = norm;
+  }
+
+  mat = (T3DMat4FP*)malloc_uncached(sizeof(T3DMat4FP));
+  t3d_mat4fp_identity(mat);
+  t3d_mat4fp_from_scale_translate(mat, 1.0f / POS_SCALE, (T3DVec3){{0.0f, 0.0f, 0.0f}});
+}
+
+QuadBatch::~QuadBatch() {
+  free_uncached(verts);
+  free_uncached(mat);
+}
+
+void QuadBatch::begin() {
+  frame = (frame + 1) % FRAME_COUNT;
+  count = 0;
+}
+
+void QuadBatch::draw() const {
+  if(count == 0)return;
+  T3DVertPacked *frameVerts = getFrameVerts();
+
+  t3d_matrix_push(mat);
+  for(uint32_t q=0; q<count; q += BATCH_QUADS) {
+    uint32_t batchCount = count - q;
+    if(batchCount > BATCH_QUADS)batchCount = BATCH_QUADS;
+
+    t3d_vert_load(frameVerts + q*2, 0, batchCount * 4);
+    // un-indexed draws already wait for their triangles, no extra 't3d_tri_sync' needed
+    t3d_quad_draw_unindexed(0, batchCount);
+  }
+  t3d_matrix_pop(1);
+}
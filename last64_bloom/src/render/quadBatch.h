@@ -0,0 +1,61 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <t3d/t3d.h>
+
+/**
+ * Collects flat-colored, screen-aligned quads in world-space and draws them in batches.
+ * Each batch is a single vertex load followed by one un-indexed quad draw,
+ * instead of a matrix push, load, draw and sync per quad.
+ * Vertex buffers are triple-buffered since the RSP may still read the previous frames.
+ */
+struct QuadBatch
+{
+  constexpr static uint32_t FRAME_COUNT = 3;
+  // 4 verts. per quad, 64 of the 70 slots of the vertex cache
+  constexpr static uint32_t BATCH_QUADS = 16;
+  // Positions are stored as integers, scaled up to keep sub-unit precision
+  constexpr static float POS_SCALE = 4.0f;
+
+  T3DMat4FP *mat{};
+  T3DVertPacked *verts{};
+  uint32_t countMax{};
+  uint32_t count{};
+  uint32_t frame{};
+
+  QuadBatch(uint32_t maxQuads);
+  ~QuadBatch();
+
+  QuadBatch(const QuadBatch&) = delete;
+  QuadBatch& operator=(const QuadBatch&) = delete;
+
+  // Switches to the next vertex buffer and clears it, call once per frame before adding quads
+  void begin();
+
+  void add(const T3DVec3 &pos, float halfSize, uint32_t color) {
+    if(count == countMax)return;
+    T3DVertPacked *v = getFrameVerts() + count*2;
+    ++count;
+
+    int16_t x = (int16_t)(pos.x * POS_SCALE);
+    int16_t y = (int16_t)(pos.y * POS_SCALE);
+    int16_t z = (int16_t)(pos.z * POS_SCALE);
+    int16_t h = (int16_t)(halfSize * POS_SCALE);
+
+    // order matches the quad pattern of 't3d_quad_draw_unindexed': 0,1,2 3,2,1
+    v[0].posA[0] = x - h; v[0].posA[1] = y - h; v[0].posA[2] = z;
+    v[0].posB[0] = x + h; v[0].posB[1] = y - h; v[0].posB[2] = z;
+    v[1].posA[0] = x - h; v[1].posA[1] = y + h; v[1].posA[2] = z;
+    v[1].posB[0] = x + h; v[1].posB[1] = y + h; v[1].posB[2] = z;
+    v[0].rgbaA = color; v[0].rgbaB = color;
+    v[1].rgbaA = color; v[1].rgbaB = color;
+  }
+
+  // Draws all quads added since 'begin', expects the scene matrix to be active
+  void draw() const;
+
+  private:
+    [[nodiscard]] T3DVertPacked* getFrameVerts() const { return verts + frame * countMax * 2; }
+};
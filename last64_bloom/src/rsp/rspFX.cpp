@@ -24,13 +24,21 @@ extern "C" {
 }
 
 namespace {
-  constexpr uint32_t BLUR_STRIDE = 80*4;
-
   constexpr uint32_t CMD_HDR_BLIT   = 0x00;
   constexpr uint32_t CMD_BLUR       = 0x01;
   constexpr uint32_t CMD_DOWN_SCALE = 0x02;
 
   uint32_t rspIdFX{0};
+
+  // Sizes are packed into the unused upper 8 bits of RDRAM addresses
+  uint32_t packAddr(const void* addr, uint32_t size) {
+    assertf(size <= 0xFF, "Size out of range: %ld", size);
+    return ((uint32_t)addr & 0xFFFFFF) | (size << 24);
+  }
+
+  void assertUnpadded(const surface_t &surf, uint32_t bytesPerPixel) {
+    assertf(surf.stride == surf.width * bytesPerPixel, "Image rows must not be padded");
+  }
 }
 
 void RspFX::init()
@@ -40,36 +48,73 @@ void RspFX::init()
   }
 }
 
-void RspFX::hdrBlit(void* rgba32In, void *rgba16Out, void* rgba32BloomIn, float factor)
+void RspFX::hdrBlit(const surface_t &rgba32In, const surface_t &rgba16Out, const surface_t &rgba32BloomIn, float factor)
 {
-  uint32_t factorInt = (uint32_t)(factor * 0xFFFF);
-  rspq_write_4(rspIdFX, CMD_HDR_BLIT,
-     (uint32_t)rgba32In & 0xFFFFFF,
-     (uint32_t)rgba16Out & 0xFFFFFF,
-     (uint32_t)rgba32BloomIn & 0xFFFFFF,
-     factorInt
-  );
+  uint32_t width = rgba32In.width;
+  uint32_t height = rgba32In.height;
+  assertf(width % 32 == 0 && height % 4 == 0, "Invalid HDR size: %ldx%ld", width, height);
+  assertf(rgba16Out.width == width && rgba32BloomIn.width == width / 4, "HDR buffer size mismatch");
+  assertUnpadded(rgba32In, 4);
+  assertUnpadded(rgba16Out, 2);
+  assertUnpadded(rgba32BloomIn, 4);
+
+  uint32_t factorInt = (uint32_t)(factor * 0xFFFF) & 0xFFFFFF;
+  factorInt |= (height / 4) << 24;
+
+  for(uint32_t x=0; x<width; x += TILE_WIDTH) {
+    uint32_t tileWidth = width - x;
+    if(tileWidth > TILE_WIDTH)tileWidth = TILE_WIDTH;
+    // the last strip has no bloom pixel to the right, the ucode repeats its last one instead
+    uint32_t lastStripFlag = (x + tileWidth == width) ? 0x80 : 0;
+
+    rspq_write_4(rspIdFX, CMD_HDR_BLIT,
+       packAddr((char*)rgba32In.buffer + x * 4, 0),
+       packAddr((char*)rgba16Out.buffer + x * 2, width / 8),
+       packAddr((char*)rgba32BloomIn.buffer + x, (tileWidth / 8) | lastStripFlag),
+       factorInt
+    );
+  }
 }
 
-void RspFX::downscale(void* rgba32In, void* rgba32Out)
+void RspFX::downscale(const surface_t &rgba32In, const surface_t &rgba32Out)
 {
-  rspq_write_2(rspIdFX, CMD_DOWN_SCALE,
-     (uint32_t)rgba32In & 0xFFFFFF,
-     (uint32_t)rgba32Out & 0xFFFFFF
-  );
+  uint32_t width = rgba32In.width;
+  assertf(width % 32 == 0 && rgba32In.height % 4 == 0, "Invalid downscale size: %ldx%d", width, rgba32In.height);
+  assertf(rgba32Out.width == width / 4, "Downscale buffer size mismatch");
+  assertUnpadded(rgba32In, 4);
+  assertUnpadded(rgba32Out, 4);
+
+  for(uint32_t x=0; x<width; x += TILE_WIDTH) {
+    uint32_t tileWidth = width - x;
+    if(tileWidth > TILE_WIDTH)tileWidth = TILE_WIDTH;
+
+    rspq_write_4(rspIdFX, CMD_DOWN_SCALE,
+       packAddr((char*)rgba32In.buffer + x * 4, 0),
+       packAddr((char*)rgba32Out.buffer + x, 0),
+       ((tileWidth * 4) << 16) | (rgba32In.height / 4),
+       rgba32In.stride
+    );
+  }
 }
 
-void RspFX::blur(void* rgba32In, void* rgba32Out, float brightness, float threshold)
+void RspFX::blur(const surface_t &rgba32In, const surface_t &rgba32Out, float brightness, float threshold)
 {
   constexpr float quantFactor = (1 << 12) * 0.99f;
 
+  assertf(rgba32In.width <= BLUR_MAX_WIDTH && rgba32In.width % 4 == 0, "Invalid blur width: %d", rgba32In.width);
+  assertf(rgba32In.height >= 3, "Invalid blur height: %d", rgba32In.height);
+  assertf(rgba32Out.width == rgba32In.width && rgba32Out.height == rgba32In.height, "Blur buffer size mismatch");
+  assertUnpadded(rgba32In, 4);
+  assertUnpadded(rgba32Out, 4);
+
   uint32_t factors = (uint32_t)(threshold * 0x7FFF) & 0xFFFF;
   factors <<= 16;
   factors |= (uint32_t)(brightness * quantFactor) & 0xFFFF;
 
-  rspq_write_3(rspIdFX, CMD_BLUR,
-    (uint32_t)rgba32In & 0xFFFFFF,
-    ((uint32_t)rgba32Out - BLUR_STRIDE) & 0xFFFFFF,
-    factors
+  rspq_write_4(rspIdFX, CMD_BLUR,
+    packAddr(rgba32In.buffer, 0),
+    packAddr((char*)rgba32Out.buffer - rgba32Out.stride, 0),
+    factors,
+    ((uint32_t)rgba32In.width << 16) | rgba32In.height
   );
-}
\ No newline at end of file
+}
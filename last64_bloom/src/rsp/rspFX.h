@@ -8,8 +8,31 @@
 
 namespace RspFX
 {
+  // Max. width processed in one go, wider images are split into strips (see 'rsp_fx.rspl')
+  constexpr int TILE_WIDTH = 320;
+  // Max. width of the blur, it works on whole rows which all need to fit into DMEM
+  constexpr int BLUR_MAX_WIDTH = 192;
+  // Bins of the luminance histogram written by 'hdrBlit', log-spaced with 2.5 bins per stop
+  constexpr int LUMA_BIN_COUNT = 16;
+
+  // Input luminance (0.0 - 1.0) in the middle of a histogram bin, matches 'LUMA_BIN_LUT' in the ucode
+  inline float lumaBinValue(int bin) {
+    return (exp2f((bin + 0.5f) / 2.5f) * 4.0f - 2.0f) / 255.0f;
+  }
+
   void init();
-  void hdrBlit(void* rgba32In, void *rgba16Out, void* rgba32BloomIn, float factor);
-  void downscale(void* rgba32In, void* rgba32Out);
-  void blur(void* rgba32In, void* rgba32Out, float brightness, float threshold);
+
+  /**
+   * Applies HDR and bloom, width must be a multiple of 32 and height one of 4.
+   * All images are expected to be unpadded, 'rgba32BloomIn' is 4:1 of the input size.
+   * Each strip samples 1 of 8 input pixels into a histogram of LUMA_BIN_COUNT u32 counters,
+   * which is written after the last row of 'rgba32In' at the column the strip starts in.
+   */
+  void hdrBlit(const surface_t &rgba32In, const surface_t &rgba16Out, const surface_t &rgba32BloomIn, float factor);
+
+  // Downscales 'rgba32In' 4:1 into 'rgba32Out', same size restrictions as 'hdrBlit'
+  void downscale(const surface_t &rgba32In, const surface_t &rgba32Out);
+
+  // Blurs the image, needs one writable row before 'rgba32Out'
+  void blur(const surface_t &rgba32In, const surface_t &rgba32Out, float brightness, float threshold);
 }
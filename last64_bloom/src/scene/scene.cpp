@@ -6,6 +6,23 @@
 #include "../main.h"
 #include <t3d/tpx.h>
 
+bool Scene::runLoadStep()
+{
+  uint32_t ticks = get_ticks();
+  bool done = loadStep();
+  ticks = TICKS_SINCE(ticks);
+
+  loadTicks += ticks;
+  loadPhaseTicks += ticks;
+  return done;
+}
+
+void Scene::endLoadPhase(const char *name)
+{
+  debugf("  %s: %.2fms\n", name, TICKS_TO_US(loadPhaseTicks) / 1000.0f);
+  loadPhaseTicks = 0;
+}
+
 void Scene::update(float deltaTime)
 {
   updateScene(deltaTime);
@@ -11,6 +11,8 @@
 class Scene
 {
   private:
+    uint32_t loadTicks{};
+    uint32_t loadPhaseTicks{};
 
   protected:
     std::vector<Actor::Base*> actors{};
@@ -19,6 +21,15 @@ class Scene
     virtual void updateScene(float deltaTime) = 0;
     virtual void draw3D(float deltaTime) = 0;
 
+    /**
+     * Performs a small slice of the loading work, called once or more per frame until it returns true.
+     * Scenes that load everything in their constructor can keep the default.
+     */
+    virtual bool loadStep() { return true; }
+
+    // Logs the time spent in all load-steps since the last call
+    void endLoadPhase(const char *name);
+
   public:
 
     virtual ~Scene() {
@@ -30,6 +41,10 @@ class Scene
     void update(float deltaTime);
     void draw(float deltaTime);
 
+    // Runs & times one 'loadStep', returns true once the scene is fully loaded
+    bool runLoadStep();
+    float getLoadTimeMs() const { return TICKS_TO_US(loadTicks) / 1000.0f; }
+
     virtual void draw2D(float deltaTime) {}
 
     Camera &getCam() { return camera; }
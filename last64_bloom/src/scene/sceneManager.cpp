@@ -13,11 +13,21 @@
 #include "scenes/sceneEnv.h"
 #include "scenes/scenePixel.h"
 #include "scenes/sceneLast64.h"
+#include "scenes/sceneLoading.h"
 
 namespace {
+  // Max. time per frame spent on loading steps, at least one step is always done
+  constexpr uint32_t LOAD_BUDGET_US = 10'000;
+
   constinit int requestSceneId{-1};
   constinit heap_stats_t heapStats{};
 
+  // Scene that is still loading, 'state.activeScene' shows the loading scene until it's done
+  Scene* pendingScene{};
+  int pendingSceneId{-1};
+  uint32_t pendingFrames{0};
+  SceneLoading* loadingScene{};
+
   int32_t getHeapDiff()
   {
     auto oldStats = heapStats;
@@ -37,24 +47,51 @@ void SceneManager::update()
   if(requestSceneId >= 0) {
     rspq_wait();
 
-    MatrixManager::reset();
     DebugMenu::reset();
 
-    if(state.activeScene) {
+    // Note: the old scene is freed before the new one loads, there is not enough RAM to hold both
+    delete pendingScene;
+    if(state.activeScene != loadingScene) {
       delete state.activeScene;
     }
+    if(!loadingScene)loadingScene = new SceneLoading();
+    state.activeScene = loadingScene;
+
+    // after the old scene is gone, its destructors still return their matrices
+    MatrixManager::reset();
     debugf("Loading scene %d (heap-diff: %ld)\n", requestSceneId, getHeapDiff());
 
+    uint32_t ticksCtor = get_ticks();
     switch(requestSceneId) {
-      case 0: state.activeScene = new SceneLast64(); break; // Make SceneLast64 index 0
-      case 1: state.activeScene = new SceneEnv(); break;
-      case 2: state.activeScene = new SceneMagic(); break;
-      case 3: state.activeScene = new ScenePixel(); break;
-      case 4: state.activeScene = new SceneBunker(); break;
+      case 0: pendingScene = new SceneLast64(); break; // Make SceneLast64 index 0
+      case 1: pendingScene = new SceneEnv(); break;
+      case 2: pendingScene = new SceneMagic(); break;
+      case 3: pendingScene = new ScenePixel(); break;
+      case 4: pendingScene = new SceneBunker(); break;
 
       default: assertf(false, "Invalid scene-id: %d", requestSceneId);
     }
 
+    debugf("  init: %.2fms\n", TICKS_TO_US(TICKS_SINCE(ticksCtor)) / 1000.0f);
+    pendingSceneId = requestSceneId;
+    pendingFrames = 0;
     requestSceneId = -1;
   }
-}
\ No newline at end of file
+
+  if(pendingScene) {
+    ++pendingFrames;
+    uint32_t ticksStart = get_ticks();
+    bool done;
+    do {
+      done = pendingScene->runLoadStep();
+    } while(!done && TICKS_TO_US(TICKS_SINCE(ticksStart)) < LOAD_BUDGET_US);
+
+    if(done) {
+      debugf("Loaded scene %d: %.2fms of steps in %ld frames\n",
+        pendingSceneId, pendingScene->getLoadTimeMs(), pendingFrames
+      );
+      state.activeScene = pendingScene;
+      pendingScene = nullptr;
+    }
+  }
+}
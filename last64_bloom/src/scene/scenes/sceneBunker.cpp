@@ -12,8 +12,13 @@
 namespace {
   constexpr uint8_t colorAmbient[4] = {0x2A, 0x2A, 0x2A, 0x00};
   constexpr float modelScale = 0.15f;
-  
-  
+
+  // Work done per load-step, one step takes ~1-2ms
+  constexpr uint32_t LOAD_READ_BYTES = 16 * 1024;
+  constexpr uint32_t LOAD_PATCH_CHUNKS = 8;
+
+  constexpr uint32_t LAYER_COUNT = 6;
+  constexpr uint32_t MAX_VISIBLE_OBJECTS = 128;
 
   struct ObjectLayer
   {
@@ -21,7 +26,11 @@ namespace {
     uint32_t objCount{0};
   };
 
-  ObjectLayer objLayers[6]{};
+  // visible objects of the current frame, sorted into their layers for drawing
+  ObjectLayer objLayers[LAYER_COUNT]{};
+  T3DObject *visibleObjects[MAX_VISIBLE_OBJECTS]{};
+  uint32_t visibleCount{0};
+  bool portalCulled{false}; // visibility came from the portals of the map, not just the BVH
   uint32_t triCount{0};
 }
 
@@ -45,7 +54,8 @@ SceneBunker::SceneBunker()
   flyCam.camRotX = T3D_DEG_TO_RAD(45.0f); // Match the static camera angle
   flyCam.camRotY = 0.0f;
 
-  mapModel = t3d_model_load("rom://scene.t3dm");
+  // model, display-lists and actors are loaded over multiple frames in 'loadStep'
+  t3d_model_load_async_begin(&modelLoader, "rom://scene.t3dm");
   mapMatFP = (T3DMat4FP*)malloc_uncached(sizeof(T3DMat4FP));
 
   t3d_mat4fp_from_srt_euler(mapMatFP,
@@ -54,38 +64,76 @@ SceneBunker::SceneBunker()
     (float[3]){0,0,0}
   );
 
-  for(auto &l : objLayers)l = {};
+  visibleCount = 0;
+}
 
-  auto it = t3d_model_iter_create(mapModel, T3D_CHUNK_TYPE_OBJECT);
-  while(t3d_model_iter_next(&it)) {
-    rspq_block_begin();
-    auto mat = it.object->material;
+bool SceneBunker::loadStep()
+{
+  switch(loadPhase)
+  {
+    case LoadPhase::MODEL: {
+      bool wasReading = !t3d_model_load_async_read_done(&modelLoader);
+      mapModel = t3d_model_load_async_step(&modelLoader, LOAD_READ_BYTES, LOAD_PATCH_CHUNKS);
+      if(wasReading && t3d_model_load_async_read_done(&modelLoader)) {
+        endLoadPhase("model-read");
+      }
+      if(!mapModel)return false;
+
+      endLoadPhase("model-patch");
+      objIter = t3d_model_iter_create(mapModel, T3D_CHUNK_TYPE_OBJECT);
+      loadPhase = LoadPhase::BLOCKS;
+      return false;
+    }
 
-    mat->otherModeMask |= SOM_Z_WRITE | SOM_Z_COMPARE;
+    case LoadPhase::BLOCKS: {
+      // one object per step, recording a block is the most expensive part of loading
+      if(!t3d_model_iter_next(&objIter)) {
+        endLoadPhase("blocks");
+        loadPhase = LoadPhase::ACTORS;
+        return false;
+      }
 
-    // Some workaround for missing imported settings from fast64
-    uint8_t layerIdx = it.object->name[0] - '0';
+      rspq_block_begin();
+      auto mat = objIter.object->material;
 
-    it.object->userValue0 = 0;
-    it.object->userValue0 |= (it.object->name[2] == 'R') ? SOM_Z_COMPARE : 0;
-    it.object->userValue0 |= (it.object->name[3] == 'W') ? SOM_Z_WRITE : 0;
+      mat->otherModeMask |= SOM_Z_WRITE | SOM_Z_COMPARE;
 
-    std::string_view name{it.object->name};
-    it.object->userValue1 = name.ends_with("Bottom");
+      // Some workaround for missing imported settings from fast64
+      assertf((uint32_t)(objIter.object->name[0] - '0') < LAYER_COUNT, "Invalid layer: %s", objIter.object->name);
 
-    t3d_model_draw_object(it.object, NULL);
-    it.object->userBlock = rspq_block_end();
+      objIter.object->userValue0 = 0;
+      objIter.object->userValue0 |= (objIter.object->name[2] == 'R') ? SOM_Z_COMPARE : 0;
+      objIter.object->userValue0 |= (objIter.object->name[3] == 'W') ? SOM_Z_WRITE : 0;
 
-    auto &layer = objLayers[layerIdx];
-    layer.objects[layer.objCount++] = it.object;
-  }
+      std::string_view name{objIter.object->name};
+      objIter.object->userValue1 = name.ends_with("Bottom");
+
+      t3d_model_draw_object(objIter.object, NULL);
+      objIter.object->userBlock = rspq_block_end();
+      return false;
+    }
+
+    case LoadPhase::ACTORS:
+      // the globe reads a texture and generates its particles over multiple steps
+      if(!pointGlobe) {
+        pointGlobe = new Actor::PointGlobe({0, 20, -560}, {.scale = 0.8f});
+        actors.push_back(pointGlobe);
+      }
+      if(!pointGlobe->loadStep())return false;
+      endLoadPhase("actors");
+      loadPhase = LoadPhase::DONE;
+      return true;
 
-  actors.push_back(new Actor::PointGlobe({0, 20, -560}, {.scale = 0.8f}));
+    case LoadPhase::DONE: return true;
+  }
+  return true;
 }
 
 SceneBunker::~SceneBunker()
 {
-  t3d_model_free(mapModel);
+  // may get deleted while still loading
+  t3d_model_load_async_cancel(&modelLoader);
+  if(mapModel)t3d_model_free(mapModel);
   free_uncached(mapMatFP);
 }
 
@@ -100,9 +148,30 @@ void SceneBunker::updateScene(float deltaTime)
   auto frustum = camera.getFrustum();
   t3d_frustum_scale(&frustum, modelScale);
 
+  // maps with cells & portals (see '--help' of the gltf importer) only draw what is seen through them
+  portalCulled = false;
+  if(t3d_model_portal_get(mapModel)) {
+    T3DVec3 camPosModel = camera.pos / modelScale;
+    auto it = t3d_model_iter_create(mapModel, T3D_CHUNK_TYPE_OBJECT);
+    while(t3d_model_iter_next(&it))it.object->isVisible = false;
+
+    if(t3d_model_portal_query(mapModel, &frustum, &camPosModel) >= 0) {
+      visibleCount = 0;
+      it = t3d_model_iter_create(mapModel, T3D_CHUNK_TYPE_OBJECT);
+      while(t3d_model_iter_next(&it)) {
+        if(it.object->isVisible && visibleCount < MAX_VISIBLE_OBJECTS) {
+          visibleObjects[visibleCount++] = it.object;
+        }
+      }
+      portalCulled = true;
+      return;
+    }
+  }
+
+  // otherwise (or if the camera is outside all cells) fall back to the BVH
   const T3DBvh *bvh = t3d_model_bvh_get(mapModel); // BVHs are optional, use '--bvh' in the gltf importer (see Makefile) 
   assert(bvh != nullptr);
-  t3d_model_bvh_query_frustum(bvh, &frustum);
+  visibleCount = t3d_model_bvh_query_frustum_list(bvh, &frustum, visibleObjects, MAX_VISIBLE_OBJECTS);
 }
 
 void SceneBunker::draw3D(float deltaTime)
@@ -120,26 +189,32 @@ void SceneBunker::draw3D(float deltaTime)
 
   T3DModelState modelState = t3d_model_state_create();
 
+  for(auto &layer : objLayers)layer.objCount = 0;
+  for(uint32_t i=0; i<visibleCount; ++i) {
+    auto &layer = objLayers[visibleObjects[i]->name[0] - '0'];
+    layer.objects[layer.objCount++] = visibleObjects[i];
+  }
+
   triCount = 0;
   int layerIdx = -1;
   for(auto &layer : objLayers)
   {
     ++layerIdx;
 
-    // outer sides of the long hallway
-    if(layerIdx == 2 && camera.pos.z < -200.0f) {
-      continue;
-    }
-    // black plane to hide long hallway when outside
-    if(layerIdx == 4 && camera.pos.z > -260.0f) {
-      continue;
+    if(!portalCulled) {
+      // outer sides of the long hallway
+      if(layerIdx == 2 && camera.pos.z < -200.0f) {
+        continue;
+      }
+      // black plane to hide long hallway when outside
+      if(layerIdx == 4 && camera.pos.z > -260.0f) {
+        continue;
+      }
     }
 
     for(uint32_t i=0; i<layer.objCount; ++i)
     {
       auto &obj = *layer.objects[i];
-      if(!obj.isVisible)continue;
-      obj.isVisible = false;
 
       // Note: we do this each time here since materials are shared, and this may differ per object
       obj.material->otherModeValue &= ~(SOM_Z_COMPARE | SOM_Z_WRITE);
@@ -10,9 +10,18 @@
 #include <t3d/t3d.h>
 #include <t3d/t3dmodel.h>
 
+namespace Actor { class PointGlobe; }
+
 class SceneBunker : public Scene
 {
   private:
+    enum class LoadPhase : uint8_t { MODEL, BLOCKS, ACTORS, DONE };
+
+    LoadPhase loadPhase{LoadPhase::MODEL};
+    T3DModelLoader modelLoader{};
+    T3DModelIter objIter{};
+    Actor::PointGlobe *pointGlobe{};
+
     T3DModel *mapModel{};
     T3DMat4FP* mapMatFP{};
     T3DMat4FP* skyMatFP{};
@@ -22,6 +31,7 @@ class SceneBunker : public Scene
 
     void updateScene(float deltaTime) final;
     void draw3D(float deltaTime) final;
+    bool loadStep() final;
 
   public:
     bool useFlyCam{true};
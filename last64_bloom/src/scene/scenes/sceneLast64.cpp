@@ -9,11 +9,11 @@
 #include "../../systems/experience.h"
 #include "../../systems/upgrade_system.h"
 #include "../../systems/spawn_manager.h"
+#include "../../systems/simulation.h"
 #include <t3d/t3d.h>
 #include <t3d/tpx.h>
 #include <t3d/t3dmath.h>
 #include <libdragon.h>
-#include <vector>
 #include <string.h>
 #include "../../audio.h"
 
@@ -54,17 +54,18 @@ SceneLast64::SceneLast64()
     player4 = nullptr;
     
     // Initialize systems (without players for now)
+    Actor::Player::initializePlayer();
     Actor::Enemy::initialize();
     Actor::Projectile::initialize();
     SpawnManager::initialize();
+
+    DebugMenu::addEntry({"PTX  ", DebugMenu::EntryType::BOOL, &drawAsParticles});
 }
 
 SceneLast64::~SceneLast64()
 {
-    delete player1;
-    delete player2;
-    delete player3;
-    delete player4;
+    // Destroys all players and their weapons
+    Simulation::getRoundArena().reset();
     Actor::Enemy::cleanup();
     Actor::Projectile::cleanup();
     Experience::shutdown();
@@ -102,19 +103,19 @@ void SceneLast64::updateScene(float deltaTime)
                         T3DVec3 startPos;
                         bool DEBUG_SPAWN_ALL = false; // Debug spawn all players
                         if (DEBUG_SPAWN_ALL) {
-                            startPos = {{120.0f, 100.0f, 0.0f}}; player1 = new Actor::Player(startPos, JOYPAD_PORT_1);
-                            startPos = {{140.0f, 100.0f, 0.0f}}; player2 = new Actor::Player(startPos, JOYPAD_PORT_2);
-                            startPos = {{160.0f, 100.0f, 0.0f}}; player3 = new Actor::Player(startPos, JOYPAD_PORT_3);
-                            startPos = {{180.0f, 100.0f, 0.0f}}; player4 = new Actor::Player(startPos, JOYPAD_PORT_4);
+                            startPos = {{120.0f, 100.0f, 0.0f}}; player1 = Simulation::getRoundArena().create<Actor::Player>(startPos, JOYPAD_PORT_1);
+                            startPos = {{140.0f, 100.0f, 0.0f}}; player2 = Simulation::getRoundArena().create<Actor::Player>(startPos, JOYPAD_PORT_2);
+                            startPos = {{160.0f, 100.0f, 0.0f}}; player3 = Simulation::getRoundArena().create<Actor::Player>(startPos, JOYPAD_PORT_3);
+                            startPos = {{180.0f, 100.0f, 0.0f}}; player4 = Simulation::getRoundArena().create<Actor::Player>(startPos, JOYPAD_PORT_4);
                             activePlayerCount = 4; // All players joined
                         }
                         else
                         {
                             switch (i) {
-                                case 0: startPos = {{120.0f, 100.0f, 0.0f}}; player1 = new Actor::Player(startPos, JOYPAD_PORT_1); break;
-                                case 1: startPos = {{140.0f, 100.0f, 0.0f}}; player2 = new Actor::Player(startPos, JOYPAD_PORT_2); break;
-                                case 2: startPos = {{160.0f, 100.0f, 0.0f}}; player3 = new Actor::Player(startPos, JOYPAD_PORT_3); break;
-                                case 3: startPos = {{180.0f, 100.0f, 0.0f}}; player4 = new Actor::Player(startPos, JOYPAD_PORT_4); break;
+                                case 0: startPos = {{120.0f, 100.0f, 0.0f}}; player1 = Simulation::getRoundArena().create<Actor::Player>(startPos, JOYPAD_PORT_1); break;
+                                case 1: startPos = {{140.0f, 100.0f, 0.0f}}; player2 = Simulation::getRoundArena().create<Actor::Player>(startPos, JOYPAD_PORT_2); break;
+                                case 2: startPos = {{160.0f, 100.0f, 0.0f}}; player3 = Simulation::getRoundArena().create<Actor::Player>(startPos, JOYPAD_PORT_3); break;
+                                case 3: startPos = {{180.0f, 100.0f, 0.0f}}; player4 = Simulation::getRoundArena().create<Actor::Player>(startPos, JOYPAD_PORT_4); break;
                             }
                             activePlayerCount++;
                         }
@@ -159,10 +160,10 @@ void SceneLast64::updateScene(float deltaTime)
                         T3DVec3 startPos;
                         Actor::Player* newPlayer = nullptr;
                         switch (i) {
-                            case 0: startPos = {{120.0f, 100.0f, 0.0f}}; player1 = new Actor::Player(startPos, JOYPAD_PORT_1); newPlayer = player1; break;
-                            case 1: startPos = {{140.0f, 100.0f, 0.0f}}; player2 = new Actor::Player(startPos, JOYPAD_PORT_2); newPlayer = player2; break;
-                            case 2: startPos = {{160.0f, 100.0f, 0.0f}}; player3 = new Actor::Player(startPos, JOYPAD_PORT_3); newPlayer = player3; break;
-                            case 3: startPos = {{180.0f, 100.0f, 0.0f}}; player4 = new Actor::Player(startPos, JOYPAD_PORT_4); newPlayer = player4; break;
+                            case 0: startPos = {{120.0f, 100.0f, 0.0f}}; player1 = Simulation::getRoundArena().create<Actor::Player>(startPos, JOYPAD_PORT_1); newPlayer = player1; break;
+                            case 1: startPos = {{140.0f, 100.0f, 0.0f}}; player2 = Simulation::getRoundArena().create<Actor::Player>(startPos, JOYPAD_PORT_2); newPlayer = player2; break;
+                            case 2: startPos = {{160.0f, 100.0f, 0.0f}}; player3 = Simulation::getRoundArena().create<Actor::Player>(startPos, JOYPAD_PORT_3); newPlayer = player3; break;
+                            case 3: startPos = {{180.0f, 100.0f, 0.0f}}; player4 = Simulation::getRoundArena().create<Actor::Player>(startPos, JOYPAD_PORT_4); newPlayer = player4; break;
                         }
                         activePlayerCount++;
                         gSFXManager.play(SFXManager::SFX_JOIN);
@@ -192,59 +193,10 @@ void SceneLast64::updateScene(float deltaTime)
                 }
             }
 
-            // Update players (this will also update their weapons)
-            if (player1) player1->update(deltaTime);
-            if (player2) player2->update(deltaTime);
-            if (player3) player3->update(deltaTime);
-            if (player4) player4->update(deltaTime);
-            
-            // Update spawn manager with player references
-            SpawnManager::setPlayers(player1, player2, player3, player4);
-            
-            // Update spawn manager
-            SpawnManager::update(deltaTime, roundTimer);
-            
-            // Update all enemies
-            Actor::Enemy::updateAll(deltaTime);
-            
-            // Update all projectiles
-            Actor::Projectile::updateAll(deltaTime);
-
-            // --- Collision Detection ---
-            // Enemy-Projectile Collision
-            for (uint32_t i = 0; i < MAX_ENEMIES; ++i) {
-                if (!Actor::Enemy::isActive(i)) continue;
-                Actor::Enemy* enemy = Actor::Enemy::getEnemy(i);
-                if (!enemy || !enemy->isActive()) continue;
-
-                for (uint32_t j = 0; j < MAX_PROJECTILES; ++j) {
-                    Actor::Projectile* proj = Actor::Projectile::getProjectile(j);
-                    if (!proj || !proj->isActive()) continue;
-
-                    if (enemy->collidesWith(proj)) {
-                        enemy->takeDamage(proj->getDamage()); // Use projectile's damage value
-                        proj->deactivate(); // Projectile disappears on hit
-                        // Play hit sound effect
-                        gSFXManager.play(SFXManager::SFX_HIT);
-                    }
-                }
-            }
-
-            // Player-Enemy Collision
-            Actor::Player* players[4] = {player1, player2, player3, player4};
-            for (int p = 0; p < 4; ++p) {
-                Actor::Player* currentPlayer = players[p];
-                if (!currentPlayer || currentPlayer->getIsDead()) continue; // Only check active, alive players
-
-                for (uint32_t i = 0; i < MAX_ENEMIES; ++i) {
-                    Actor::Enemy* enemy = Actor::Enemy::getEnemy(i);
-                    if (!enemy || !enemy->isActive()) continue;
-
-                    if (currentPlayer->collidesWith(enemy)) {
-                        currentPlayer->takeDamage(1);
-                        // gSFXManager.play(SFXManager::SFX_PLAYER_HIT); // Assuming a player hit sound effect
-                    }
-                }
+            // Advance players, spawning, enemies, projectiles and collisions
+            {
+                Actor::Player* players[Simulation::MAX_PLAYERS] = {player1, player2, player3, player4};
+                Simulation::update(players, deltaTime, roundTimer);
             }
 
             // Recalculate active players for game over check
@@ -310,14 +262,32 @@ void SceneLast64::draw3D(float deltaTime)
     if (player3) player3->draw3D(deltaTime);
     if (player4) player4->draw3D(deltaTime);
     
-    // Draw all enemies
-    Actor::Enemy::drawAll(deltaTime);
+    if (!drawAsParticles) {
+        // Draw all enemies
+        Actor::Enemy::drawAll(deltaTime);
 
-    // Draw all projectiles
-    Actor::Projectile::drawAll(deltaTime);
+        // Draw all projectiles
+        Actor::Projectile::drawAll(deltaTime);
+    }
 
     // Pop scene matrix
     t3d_matrix_pop(1);
+
+    if (drawAsParticles) {
+        rdpq_sync_pipe();
+
+        rdpq_mode_begin();
+          rdpq_mode_zbuf(true, true);
+          rdpq_mode_zoverride(true, 0, 0);
+          rdpq_mode_persp(false);
+          rdpq_mode_combiner(RDPQ_COMBINER1((0,0,0,PRIM), (0,0,0,1)));
+        rdpq_mode_end();
+
+        tpx_state_from_t3d();
+        tpx_state_set_scale(1.0f, 1.0f);
+        Actor::Enemy::drawAllParticles();
+        Actor::Projectile::drawAllParticles();
+    }
 }
 
 void SceneLast64::draw2D(float deltaTime)
@@ -34,6 +34,7 @@ class SceneLast64 : public Scene
     Actor::Player* player4;
     int activePlayerCount;
     bool restartRequested; // Flag to signal restart to main loop
+    bool drawAsParticles{false}; // Render enemies/projectiles via TPX instead of triangles
                                                                                                                                                                                                                                                         
     StaticCam staticCam{camera};                                                                                                                                                                                                                        
                                                                                                                                                                                                                                                         
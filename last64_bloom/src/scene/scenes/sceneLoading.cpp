@@ -0,0 +1,33 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#include "sceneLoading.h"
+#include "../../main.h"
+#include "../../render/debugDraw.h"
+
+SceneLoading::SceneLoading()
+{
+  camera.fov = T3D_DEG_TO_RAD(70.0f);
+  camera.near = 1.0f;
+  camera.far = 10.0f;
+  camera.pos = {0, 0, -1};
+  camera.target = {0, 0, 0};
+}
+
+void SceneLoading::updateScene(float deltaTime)
+{
+  time += deltaTime;
+}
+
+void SceneLoading::draw3D(float deltaTime)
+{
+  t3d_screen_clear_color({0,0,0,0xFF});
+  t3d_screen_clear_depth();
+}
+
+void SceneLoading::draw2D(float deltaTime)
+{
+  constexpr const char* DOTS[4] = {"", ".", "..", "..."};
+  Debug::printf(SCREEN_WIDTH/2 - 28, SCREEN_HEIGHT/2 - 4, "Loading%s", DOTS[(int)(time * 3.0f) % 4]);
+}
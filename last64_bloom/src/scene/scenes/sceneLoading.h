@@ -0,0 +1,24 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include "../scene.h"
+
+/**
+ * Placeholder shown while another scene loads over multiple frames.
+ * Doesn't load any assets itself, so it can stay alive for the whole game.
+ */
+class SceneLoading : public Scene
+{
+  private:
+    float time{};
+
+    void updateScene(float deltaTime) final;
+    void draw3D(float deltaTime) final;
+
+  public:
+    void draw2D(float deltaTime) final;
+
+    SceneLoading();
+};
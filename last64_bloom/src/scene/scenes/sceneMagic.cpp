@@ -18,6 +18,21 @@ namespace {
       -posBlender.y * 64 * modelScale,
     };
   }
+
+  // objects are tagged in 'userValue0', the sky is drawn on its own with a scrolling material
+  enum DrawLayer : uint8_t { LAYER_MAP = 0, LAYER_SKY };
+
+  bool filterLayer(void* userData, const T3DObject *obj) {
+    return obj->userValue0 == (uint8_t)(uintptr_t)userData;
+  }
+
+  T3DModelDrawConf layerConf(DrawLayer layer) {
+    return {
+      .userData = (void*)(uintptr_t)layer,
+      .filterCb = filterLayer,
+      .skipMaterials = layer == LAYER_SKY,
+    };
+  }
 }
 
 SceneMagic::SceneMagic()
@@ -40,23 +55,17 @@ SceneMagic::SceneMagic()
   );
 
   auto it = t3d_model_iter_create(mapModel, T3D_CHUNK_TYPE_OBJECT);
-  auto matState = t3d_model_state_create();
-  rspq_block_begin();
   while(t3d_model_iter_next(&it)) {
+    it.object->userValue0 = LAYER_MAP;
     if(std::string_view{it.object->name} == "Sky") {
       objSky = it.object;
-      continue;
+      objSky->userValue0 = LAYER_SKY;
     }
-    t3d_model_draw_material(it.object->material, &matState);
-    t3d_model_draw_object(it.object, NULL);
   }
-  t3d_state_set_vertex_fx(T3D_VERTEX_FX_NONE, 0, 0);
-  mapModel->userBlock = rspq_block_end();
 
   assertf(objSky, "Sky object not found in model!");
-  rspq_block_begin();
-    t3d_model_draw_object(objSky, nullptr);
-  objSky->userBlock = rspq_block_end();
+  t3d_model_cache_record(mapModel, layerConf(LAYER_MAP));
+  t3d_model_cache_record(mapModel, layerConf(LAYER_SKY));
 
   constexpr fm_vec3_t posSp{0, 29, 0};
   actors.push_back(new Actor::MagicSphere(posSp, {.scale = 1.20f, .color = {0x67,0x00,0x80,0xFF}}));
@@ -106,14 +115,14 @@ void SceneMagic::draw3D(float deltaTime)
   }
   t3d_model_draw_material(objSky->material, nullptr);
   rdpq_mode_zbuf(false, false);
-  rspq_block_run(objSky->userBlock);
+  t3d_model_draw_cached(mapModel, layerConf(LAYER_SKY));
 
   // Main map mesh
   rdpq_sync_pipe();
   rdpq_mode_zbuf(true, true);
 
   t3d_matrix_set(mapMatFP, true);
-  rspq_block_run(mapModel->userBlock);
+  t3d_model_draw_cached(mapModel, layerConf(LAYER_MAP));
 
   t3d_matrix_pop(1);
 }
\ No newline at end of file
@@ -22,6 +22,21 @@ namespace {
     {0x22, 0xFF, 0x22, 0xFF}, // green
     {0x22, 0x22, 0xFF, 0xFF}  // blue
   };
+
+  // objects are tagged in 'userValue0', the sky is drawn on its own with a scrolling material
+  enum DrawLayer : uint8_t { LAYER_MAP = 0, LAYER_SKY, LAYER_SKY_TOP };
+
+  bool filterLayer(void* userData, const T3DObject *obj) {
+    return obj->userValue0 == (uint8_t)(uintptr_t)userData;
+  }
+
+  T3DModelDrawConf layerConf(DrawLayer layer) {
+    return {
+      .userData = (void*)(uintptr_t)layer,
+      .filterCb = filterLayer,
+      .skipMaterials = layer != LAYER_MAP,
+    };
+  }
 }
 
 ScenePixel::ScenePixel()
@@ -44,33 +59,29 @@ ScenePixel::ScenePixel()
   T3DObject *objSkyTop{};
 
   auto it = t3d_model_iter_create(model, T3D_CHUNK_TYPE_OBJECT);
-  auto matState = t3d_model_state_create();
-  rspq_block_begin();
   while(t3d_model_iter_next(&it)) {
     if(std::string_view{it.object->name} == "Sky") {
       objSky = it.object;
+      objSky->userValue0 = LAYER_SKY;
       continue;
     }
     if(std::string_view{it.object->name} == "SkyTop") {
       objSkyTop = it.object;
+      objSkyTop->userValue0 = LAYER_SKY_TOP;
       continue;
     }
 
+    it.object->userValue0 = LAYER_MAP;
     it.object->material->fogMode = 0;
     it.object->material->setColorFlags = 0;
-    t3d_model_draw_material(it.object->material, &matState);
-    t3d_model_draw_object(it.object, NULL);
   }
-  t3d_state_set_vertex_fx(T3D_VERTEX_FX_NONE, 0, 0);
-  model->userBlock = rspq_block_end();
 
   assertf(objSky, "Sky object not found in model!");
   assertf(objSkyTop, "SkyTop object not found in model!");
 
-  rspq_block_begin();
-    t3d_model_draw_object(objSkyTop, nullptr);
-    t3d_model_draw_object(objSky, nullptr);
-  objSky->userBlock = rspq_block_end();
+  for(auto layer : {LAYER_MAP, LAYER_SKY_TOP, LAYER_SKY}) {
+    t3d_model_cache_record(model, layerConf(layer));
+  }
 
   actors.push_back(new Actor::LightBlock({0,0,0}, {{0xFF, 0xFF, 0x77, 0xFF}, 1}));
 
@@ -132,7 +143,8 @@ void ScenePixel::draw3D(float deltaTime)
 
   t3d_model_draw_material(objSky->material, nullptr);
   rdpq_mode_zbuf(false, false);
-  rspq_block_run(objSky->userBlock);
+  t3d_model_draw_cached(model, layerConf(LAYER_SKY_TOP));
+  t3d_model_draw_cached(model, layerConf(LAYER_SKY));
 
    // Main map mesh
   rdpq_sync_pipe();
@@ -156,7 +168,7 @@ void ScenePixel::draw3D(float deltaTime)
   t3d_light_set_count(doCutout ? 3 : 2);
 
   t3d_matrix_set(matFP.get(), true);
-  rspq_block_run(model->userBlock);
+  t3d_model_draw_cached(model, layerConf(LAYER_MAP));
 
   t3d_matrix_pop(1);
 }
@@ -0,0 +1,45 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#include "collision_grid.h"
+
+namespace CollisionGrid {
+    uint16_t cellStart[CELL_COUNT + 1]{};
+    uint16_t cellItems[MAX_ENEMIES]{};
+
+    namespace {
+        uint16_t enemyCell[MAX_ENEMIES]{};
+    }
+
+    void build() {
+        memset(cellStart, 0, sizeof(cellStart));
+
+        uint32_t count = Actor::Enemy::getActiveCount();
+
+        // Counting sort: first count entries per cell...
+        for (uint32_t n = 0; n < count; ++n) {
+            uint16_t i = Actor::Enemy::getLiveIndex(n);
+            const T3DVec3 &pos = Actor::Enemy::getPosition(i);
+            int cell = cellCoord(pos.y, GRID_HEIGHT) * GRID_WIDTH + cellCoord(pos.x, GRID_WIDTH);
+            enemyCell[i] = cell;
+            ++cellStart[cell + 1];
+        }
+
+        // ...turn the counts into start offsets...
+        for (int c = 0; c < CELL_COUNT; ++c) {
+            cellStart[c + 1] += cellStart[c];
+        }
+
+        // ...and scatter the indices, this moves each 'cellStart[c]' to the end of its cell,
+        // so shifting everything by one restores the start offsets
+        for (uint32_t n = 0; n < count; ++n) {
+            uint16_t i = Actor::Enemy::getLiveIndex(n);
+            cellItems[cellStart[enemyCell[i]]++] = i;
+        }
+        for (int c = CELL_COUNT; c > 0; --c) {
+            cellStart[c] = cellStart[c - 1];
+        }
+        cellStart[0] = 0;
+    }
+}
@@ -0,0 +1,59 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include "../main.h"
+#include "../actors/enemy.h"
+#include <t3d/t3d.h>
+
+// Uniform grid over the play-field, rebuilt once per frame from the enemy pool.
+// Enemies are bucketed by their center, queries then only visit the 3x3 cells around a point.
+namespace CollisionGrid {
+    constexpr int CELL_SIZE = 16;
+    constexpr int GRID_WIDTH = SCREEN_WIDTH / CELL_SIZE;
+    constexpr int GRID_HEIGHT = SCREEN_HEIGHT / CELL_SIZE;
+    constexpr int CELL_COUNT = GRID_WIDTH * GRID_HEIGHT;
+
+    // Largest enemy radius (8) + largest query radius (player/projectile, 3) must fit into one cell,
+    // otherwise the 3x3 neighborhood would miss overlaps.
+    constexpr float MAX_QUERY_DISTANCE = 8.0f + 3.0f;
+
+    static_assert(SCREEN_WIDTH % CELL_SIZE == 0 && SCREEN_HEIGHT % CELL_SIZE == 0);
+    static_assert(MAX_QUERY_DISTANCE <= (float)CELL_SIZE);
+    static_assert(MAX_ENEMIES <= UINT16_MAX);
+
+    // Bucketed enemy indices, 'cellStart[c]' to 'cellStart[c+1]' are the entries of cell 'c'
+    extern uint16_t cellStart[CELL_COUNT + 1];
+    extern uint16_t cellItems[MAX_ENEMIES];
+
+    constexpr int cellCoord(float v, int max) {
+        int c = (int)v / CELL_SIZE;
+        return c < 0 ? 0 : (c >= max ? max-1 : c);
+    }
+
+    // Rebuild the grid from all active enemies (after movement, and by TargetingSystem at frame start)
+    void build();
+
+    /**
+     * Calls 'fn(enemyIndex)' for each enemy that may overlap a circle at 'pos'.
+     * If 'fn' returns true, the query stops early.
+     */
+    template<typename F>
+    inline void queryEnemies(const T3DVec3 &pos, F &&fn) {
+        int cx = cellCoord(pos.x, GRID_WIDTH);
+        int cy = cellCoord(pos.y, GRID_HEIGHT);
+
+        int yEnd = cy < GRID_HEIGHT-1 ? cy+1 : cy;
+        int xEnd = cx < GRID_WIDTH-1 ? cx+1 : cx;
+
+        for(int y = cy > 0 ? cy-1 : cy; y <= yEnd; ++y) {
+            for(int x = cx > 0 ? cx-1 : cx; x <= xEnd; ++x) {
+                int cell = y * GRID_WIDTH + x;
+                for(uint32_t i = cellStart[cell]; i < cellStart[cell+1]; ++i) {
+                    if(fn(cellItems[i]))return;
+                }
+            }
+        }
+    }
+}
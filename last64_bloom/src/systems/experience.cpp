@@ -1,10 +1,9 @@
 #include "experience.h"
 #include "upgrade_system.h"
+#include "random.h"
 #include "../systems/weapon_base.h"
 #include <libdragon.h>
 #include <cmath>
-#include <rdpq.h>
-#include "../render/debugDraw.h"
 #include "../audio.h"
 
 namespace {
@@ -72,16 +71,8 @@ void Experience::addXP(int amount) {
                 
                 // If we have options, apply a random one
                 if (!upgradeOptions.empty()) {
-                    int randomIndex = rand() % upgradeOptions.size();
+                    int randomIndex = Random::range(upgradeOptions.size());
                     UpgradeSystem::applyUpgrade(activePlayers[i], upgradeOptions[randomIndex]);
-                    
-                    // Clean up any new weapon options that weren't selected
-                    for (auto& option : upgradeOptions) {
-                        if (option.type == UpgradeSystem::UpgradeType::NEW_WEAPON && 
-                            option.weapon != upgradeOptions[randomIndex].weapon) {
-                            delete option.weapon;
-                        }
-                    }
                 }
             }
         }
@@ -108,23 +99,4 @@ int Experience::getAlivePlayerCount() {
         }
     }
     return count;
-}
-
-Actor::Player* Experience::getRandomAlivePlayer() {
-    // Create a temporary array of alive players
-    Actor::Player* alivePlayers[MAX_PLAYERS];
-    int aliveCount = 0;
-    
-    for (int i = 0; i < activePlayerCount; ++i) {
-        if (activePlayers[i] && !activePlayers[i]->getIsDead()) {
-            alivePlayers[aliveCount++] = activePlayers[i];
-        }
-    }
-    
-    // Return a random alive player or nullptr if none are alive
-    if (aliveCount > 0) {
-        return alivePlayers[rand() % aliveCount];
-    }
-    
-    return nullptr;
 }
\ No newline at end of file
@@ -14,7 +14,4 @@ namespace Experience {
     
     // Get number of alive players
     int getAlivePlayerCount();
-    
-    // Get a random alive player (returns nullptr if none are alive)
-    Actor::Player* getRandomAlivePlayer();
 };
\ No newline at end of file
@@ -0,0 +1,23 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#include "random.h"
+
+namespace {
+    uint32_t rngState = 0x12345678;
+}
+
+void Random::seed(uint32_t value) {
+    // xorshift gets stuck at zero
+    rngState = value ? value : 0x12345678;
+}
+
+uint32_t Random::next() {
+    uint32_t x = rngState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rngState = x;
+    return x;
+}
@@ -0,0 +1,19 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <stdint.h>
+
+/**
+ * Seeded RNG for all gameplay code (xorshift32).
+ * Unlike 'rand()', the sequence only depends on the seed,
+ * so a simulation can be replayed exactly, e.g. by the headless benchmark.
+ */
+namespace Random {
+    void seed(uint32_t value);
+    uint32_t next();
+
+    // Random value in [0, max)
+    inline uint32_t range(uint32_t max) { return next() % max; }
+}
@@ -0,0 +1,96 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#include "simulation.h"
+#include "spawn_manager.h"
+#include "collision_grid.h"
+#include "targeting_system.h"
+#include "../actors/enemy.h"
+#include "../actors/projectile.h"
+#include "../profiler.h"
+#include "../audio.h"
+
+namespace {
+    constexpr uint32_t ROUND_ARENA_SIZE = 16 * 1024;
+
+    alignas(16) uint8_t roundArenaBuffer[ROUND_ARENA_SIZE];
+    Arena roundArena{roundArenaBuffer, ROUND_ARENA_SIZE};
+}
+
+Arena& Simulation::getRoundArena()
+{
+    return roundArena;
+}
+
+void Simulation::update(Actor::Player* const players[MAX_PLAYERS], float deltaTime, float roundTimer)
+{
+    // Enemy lookup and alive players for this frame, weapons fire from inside the player update
+    TargetingSystem::update(players);
+
+    // Update players (this will also update their weapons)
+    {
+        PROFILE_SCOPE("players");
+        for (int p = 0; p < MAX_PLAYERS; ++p) {
+            if (players[p]) players[p]->update(deltaTime);
+        }
+    }
+
+    // Update spawn manager with player references
+    SpawnManager::setPlayers(players[0], players[1], players[2], players[3]);
+
+    // Update spawn manager
+    {
+        PROFILE_SCOPE("spawn");
+        SpawnManager::update(deltaTime, roundTimer);
+    }
+
+    // Update all enemies
+    Actor::Enemy::updateAll(deltaTime);
+
+    // Update all projectiles
+    Actor::Projectile::updateAll(deltaTime);
+
+    resolveCollisions(players);
+}
+
+void Simulation::resolveCollisions(Actor::Player* const players[MAX_PLAYERS])
+{
+    PROFILE_SCOPE("collision");
+
+    // Bucket all enemies once, both passes below only look at neighboring cells
+    CollisionGrid::build();
+
+    // Enemy-Projectile Collision
+    // Iterate backwards, a hit swap-removes the projectile from the live list
+    for (uint32_t n = Actor::Projectile::getActiveCount(); n-- > 0;) {
+        uint16_t proj = Actor::Projectile::getLiveIndex(n);
+        const T3DVec3 &projPos = Actor::Projectile::getPosition(proj);
+
+        CollisionGrid::queryEnemies(projPos, [proj, &projPos](uint16_t enemy) {
+            if (!Actor::Enemy::collidesWith(enemy, projPos, Actor::Projectile::RADIUS)) return false;
+
+            Actor::Enemy::takeDamage(enemy, Actor::Projectile::getDamage(proj)); // Use projectile's damage value
+            Actor::Projectile::deactivate(proj); // Projectile disappears on hit
+            // Play hit sound effect
+            gSFXManager.play(SFXManager::SFX_HIT);
+            return true;
+        });
+    }
+
+    // Player-Enemy Collision
+    for (int p = 0; p < MAX_PLAYERS; ++p) {
+        Actor::Player* currentPlayer = players[p];
+        if (!currentPlayer || currentPlayer->getIsDead()) continue; // Only check active, alive players
+
+        CollisionGrid::queryEnemies(currentPlayer->getPosition(), [currentPlayer](uint16_t enemy) {
+            if (Actor::Enemy::isActive(enemy) &&
+                currentPlayer->collidesWith(Actor::Enemy::getPosition(enemy), Actor::Enemy::getRadius(enemy)))
+            {
+                currentPlayer->takeDamage(1);
+                // gSFXManager.play(SFXManager::SFX_PLAYER_HIT); // Assuming a player hit sound effect
+            }
+            return false;
+        });
+    }
+}
@@ -0,0 +1,25 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include "../actors/player.h"
+#include "../memory/arena.h"
+
+/**
+ * Gameplay update of an active round, independent of any scene or rendering.
+ * This is shared by 'SceneLast64' and the headless benchmark in 'bench/'.
+ */
+namespace Simulation {
+    constexpr int MAX_PLAYERS = 4;
+
+    // Players and weapons of the current round, so joining and level-ups never touch the heap.
+    // Reset once the round is over.
+    Arena& getRoundArena();
+
+    // Updates players, spawning, enemies and projectiles, then resolves collisions.
+    // Unused player slots are nullptr.
+    void update(Actor::Player* const players[MAX_PLAYERS], float deltaTime, float roundTimer);
+
+    void resolveCollisions(Actor::Player* const players[MAX_PLAYERS]);
+}
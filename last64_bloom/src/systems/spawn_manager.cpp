@@ -4,8 +4,9 @@
 */
 #include "spawn_manager.h"
 #include "../main.h"
+#include "random.h"
+#include "targeting_system.h"
 #include <libdragon.h>
-#include <vector>
 #include <algorithm>
 
 namespace SpawnManager {
@@ -129,37 +130,28 @@ namespace SpawnManager {
         // Handle boss wave specially
         if (currentWave >= 3 && !bossSpawned) {
             // Spawn the boss
-            Actor::Player* targetPlayer = nullptr;
-            std::vector<Actor::Player*> alivePlayers;
-            for (int i = 0; i < 4; i++) {
-                if (players[i] && !players[i]->getIsDead()) {
-                    alivePlayers.push_back(players[i]);
-                }
-            }
-            
-            if (!alivePlayers.empty()) {
-                targetPlayer = alivePlayers[rand() % alivePlayers.size()];
-                
+            Actor::Player* targetPlayer = TargetingSystem::getRandomAlivePlayer();
+            if (targetPlayer) {
                 // Spawn boss at a random edge
                 float spawnX, spawnY;
-                int edge = rand() % 4; // 0=top, 1=right, 2=bottom, 3=left
+                int edge = Random::range(4); // 0=top, 1=right, 2=bottom, 3=left
                 
                 switch (edge) {
                     case 0: // Top
-                        spawnX = SCREEN_LEFT + (rand() % (int)SCREEN_WIDTH);
+                        spawnX = SCREEN_LEFT + Random::range(SCREEN_WIDTH);
                         spawnY = SCREEN_TOP;
                         break;
                     case 1: // Right
                         spawnX = SCREEN_RIGHT;
-                        spawnY = SCREEN_TOP + (rand() % (int)SCREEN_HEIGHT);
+                        spawnY = SCREEN_TOP + Random::range(SCREEN_HEIGHT);
                         break;
                     case 2: // Bottom
-                        spawnX = SCREEN_LEFT + (rand() % (int)SCREEN_WIDTH);
+                        spawnX = SCREEN_LEFT + Random::range(SCREEN_WIDTH);
                         spawnY = SCREEN_BOTTOM;
                         break;
                     case 3: // Left
                         spawnX = SCREEN_LEFT;
-                        spawnY = SCREEN_TOP + (rand() % (int)SCREEN_HEIGHT);
+                        spawnY = SCREEN_TOP + Random::range(SCREEN_HEIGHT);
                         break;
                     default:
                         spawnX = 0;
@@ -171,8 +163,7 @@ namespace SpawnManager {
                 float speed = 15.0f * config.speedMultiplier;
                 
                 // Spawn enemy with the selected target player and parameters
-                // Spawn enemy with the selected target player and parameters
-                Actor::Enemy* boss = Actor::Enemy::spawn(pos, speed, targetPlayer, config.enemySize, config.enemyColor, config.xpReward, 8 * config.healthMultiplier);
+                Actor::Enemy::spawn(pos, speed, targetPlayer, config.enemySize, config.enemyColor, config.xpReward, 8 * config.healthMultiplier);
                 
                 bossSpawned = true;
             }
@@ -185,37 +176,28 @@ namespace SpawnManager {
             spawnTimer = 0.0f;
             
             // Randomly select a target player from alive players
-            Actor::Player* targetPlayer = nullptr;
-            std::vector<Actor::Player*> alivePlayers;
-            for (int i = 0; i < 4; i++) {
-                if (players[i] && !players[i]->getIsDead()) {
-                    alivePlayers.push_back(players[i]);
-                }
-            }
-            
-            if (!alivePlayers.empty()) {
-                targetPlayer = alivePlayers[rand() % alivePlayers.size()];
-                
+            Actor::Player* targetPlayer = TargetingSystem::getRandomAlivePlayer();
+            if (targetPlayer) {
                 // Spawn a new enemy at a random edge of the screen
                 float spawnX, spawnY;
-                int edge = rand() % 4; // 0=top, 1=right, 2=bottom, 3=left
+                int edge = Random::range(4); // 0=top, 1=right, 2=bottom, 3=left
                 
                 switch (edge) {
                     case 0: // Top
-                        spawnX = SCREEN_LEFT + (rand() % (int)SCREEN_WIDTH);
+                        spawnX = SCREEN_LEFT + Random::range(SCREEN_WIDTH);
                         spawnY = SCREEN_TOP;
                         break;
                     case 1: // Right
                         spawnX = SCREEN_RIGHT;
-                        spawnY = SCREEN_TOP + (rand() % (int)SCREEN_HEIGHT);
+                        spawnY = SCREEN_TOP + Random::range(SCREEN_HEIGHT);
                         break;
                     case 2: // Bottom
-                        spawnX = SCREEN_LEFT + (rand() % (int)SCREEN_WIDTH);
+                        spawnX = SCREEN_LEFT + Random::range(SCREEN_WIDTH);
                         spawnY = SCREEN_BOTTOM;
                         break;
                     case 3: // Left
                         spawnX = SCREEN_LEFT;
-                        spawnY = SCREEN_TOP + (rand() % (int)SCREEN_HEIGHT);
+                        spawnY = SCREEN_TOP + Random::range(SCREEN_HEIGHT);
                         break;
                     default:
                         spawnX = 0;
@@ -227,8 +209,7 @@ namespace SpawnManager {
                 float speed = 20.0f * config.speedMultiplier;
                 
                 // Spawn enemy with the selected target player and parameters
-                Actor::Enemy* enemy =
-                        Actor::Enemy::spawn(pos, speed, targetPlayer, config.enemySize, config.enemyColor, config.xpReward, 8 * config.healthMultiplier);
+                Actor::Enemy::spawn(pos, speed, targetPlayer, config.enemySize, config.enemyColor, config.xpReward, 8 * config.healthMultiplier);
             }
         }
     }
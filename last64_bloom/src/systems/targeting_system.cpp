@@ -0,0 +1,108 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#include "targeting_system.h"
+#include "random.h"
+
+namespace TargetingSystem {
+    namespace {
+        Actor::Player* alivePlayers[Simulation::MAX_PLAYERS]{};
+        uint32_t alivePlayerCount = 0;
+
+        // Keeps 'dists'/'items' sorted, dropping the farthest entry once 'k' are taken
+        void insertSorted(float *dists, uint16_t *items, uint32_t &count, uint32_t k, float distSq, uint16_t item) {
+            uint32_t i = count < k ? count++ : k - 1;
+            for (; i > 0 && dists[i - 1] > distSq; --i) {
+                dists[i] = dists[i - 1];
+                items[i] = items[i - 1];
+            }
+            dists[i] = distSq;
+            items[i] = item;
+        }
+    }
+
+    void update(Actor::Player* const players[Simulation::MAX_PLAYERS]) {
+        alivePlayerCount = 0;
+        for (int p = 0; p < Simulation::MAX_PLAYERS; ++p) {
+            if (players[p] && !players[p]->getIsDead()) {
+                alivePlayers[alivePlayerCount++] = players[p];
+            }
+        }
+
+        CollisionGrid::build();
+    }
+
+    uint16_t findNearestEnemy(const T3DVec3 &pos, float maxDist) {
+        uint16_t res = Actor::Enemy::INVALID_INDEX;
+        findNearestEnemies(pos, maxDist, &res, 1);
+        return res;
+    }
+
+    uint32_t findNearestEnemies(const T3DVec3 &pos, float maxDist, uint16_t *out, uint32_t k) {
+        using namespace CollisionGrid;
+        assertf(k > 0 && k <= MAX_K, "Invalid target count: %ld", k);
+
+        float bestDistSq[MAX_K];
+        uint32_t count = 0;
+        float maxDistSq = maxDist * maxDist;
+
+        int cx = cellCoord(pos.x, GRID_WIDTH);
+        int cy = cellCoord(pos.y, GRID_HEIGHT);
+
+        for (int r = 0; ; ++r) {
+            if (cx - r < 0 && cy - r < 0 && cx + r >= GRID_WIDTH && cy + r >= GRID_HEIGHT)break;
+
+            // Every cell in ring 'r' lies outside the square of rings [0, r-1],
+            // so the distance to that square's border is a lower bound for anything left
+            float worstSq = count == k ? bestDistSq[k - 1] : maxDistSq;
+            if (r > 0) {
+                float border = fminf(
+                    fminf(pos.x - (float)((cx - r + 1) * CELL_SIZE), (float)((cx + r) * CELL_SIZE) - pos.x),
+                    fminf(pos.y - (float)((cy - r + 1) * CELL_SIZE), (float)((cy + r) * CELL_SIZE) - pos.y)
+                );
+                if (border > 0.0f && border * border >= worstSq)break;
+            }
+
+            int yStart = cy - r < 0 ? 0 : cy - r;
+            int yEnd = cy + r >= GRID_HEIGHT ? GRID_HEIGHT - 1 : cy + r;
+            for (int y = yStart; y <= yEnd; ++y) {
+                // Inner rows only have the two cells on the left and right edge of the ring
+                bool fullRow = r == 0 || y == cy - r || y == cy + r;
+                int step = fullRow ? 1 : 2 * r;
+
+                for (int x = cx - r; x <= cx + r; x += step) {
+                    if (x < 0 || x >= GRID_WIDTH)continue;
+
+                    int cell = y * GRID_WIDTH + x;
+                    for (uint32_t i = cellStart[cell]; i < cellStart[cell + 1]; ++i) {
+                        uint16_t enemy = cellItems[i];
+                        const T3DVec3 &enemyPos = Actor::Enemy::getPosition(enemy);
+                        float dx = enemyPos.x - pos.x;
+                        float dy = enemyPos.y - pos.y;
+                        float distSq = dx * dx + dy * dy;
+
+                        worstSq = count == k ? bestDistSq[k - 1] : maxDistSq;
+                        if (distSq < worstSq) {
+                            insertSorted(bestDistSq, out, count, k, distSq, enemy);
+                        }
+                    }
+                }
+            }
+        }
+        return count;
+    }
+
+    uint32_t getAlivePlayerCount() {
+        return alivePlayerCount;
+    }
+
+    Actor::Player* getAlivePlayer(uint32_t idx) {
+        return idx < alivePlayerCount ? alivePlayers[idx] : nullptr;
+    }
+
+    Actor::Player* getRandomAlivePlayer() {
+        if (alivePlayerCount == 0) return nullptr;
+        return alivePlayers[Random::range(alivePlayerCount)];
+    }
+}
@@ -0,0 +1,64 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include "collision_grid.h"
+#include "simulation.h"
+
+/**
+ * Target lookups for weapons and enemies, refreshed once at the start of each frame.
+ * Enemies are bucketed into the collision grid, nearest/k-nearest queries then walk rings of
+ * cells outwards and stop as soon as no unvisited cell can be closer than the current result.
+ * Enemies don't move until after the player update, so all weapon queries see exact positions.
+ */
+namespace TargetingSystem {
+    constexpr uint32_t MAX_K = 8;
+
+    // Rebuilds the enemy grid and the alive-player set, unused player slots are nullptr
+    void update(Actor::Player* const players[Simulation::MAX_PLAYERS]);
+
+    // Closest live enemy on the XY plane within 'maxDist', or 'Enemy::INVALID_INDEX'
+    uint16_t findNearestEnemy(const T3DVec3 &pos, float maxDist);
+
+    /**
+     * Writes up to 'k' (<= MAX_K) enemies within 'maxDist' into 'out', closest first.
+     * Returns the number of enemies found.
+     */
+    uint32_t findNearestEnemies(const T3DVec3 &pos, float maxDist, uint16_t *out, uint32_t k);
+
+    // Alive players as of the start of the frame, in port order
+    uint32_t getAlivePlayerCount();
+    Actor::Player* getAlivePlayer(uint32_t idx);
+
+    // Random alive player (nullptr if none are alive)
+    Actor::Player* getRandomAlivePlayer();
+
+    /**
+     * Calls 'fn(enemyIndex, distSq)' for each enemy within 'radius' of 'pos' on the XY plane.
+     * If 'fn' returns true, the query stops early.
+     */
+    template<typename F>
+    inline void queryRadius(const T3DVec3 &pos, float radius, F &&fn) {
+        using namespace CollisionGrid;
+        int xStart = cellCoord(pos.x - radius, GRID_WIDTH);
+        int xEnd   = cellCoord(pos.x + radius, GRID_WIDTH);
+        int yStart = cellCoord(pos.y - radius, GRID_HEIGHT);
+        int yEnd   = cellCoord(pos.y + radius, GRID_HEIGHT);
+        float radiusSq = radius * radius;
+
+        for(int y = yStart; y <= yEnd; ++y) {
+            for(int x = xStart; x <= xEnd; ++x) {
+                int cell = y * GRID_WIDTH + x;
+                for(uint32_t i = cellStart[cell]; i < cellStart[cell+1]; ++i) {
+                    uint16_t enemy = cellItems[i];
+                    const T3DVec3 &enemyPos = Actor::Enemy::getPosition(enemy);
+                    float dx = enemyPos.x - pos.x;
+                    float dy = enemyPos.y - pos.y;
+                    float distSq = dx * dx + dy * dy;
+                    if(distSq <= radiusSq && fn(enemy, distSq))return;
+                }
+            }
+        }
+    }
+}
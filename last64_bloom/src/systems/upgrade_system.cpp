@@ -7,19 +7,18 @@
 #include "weapon_homing.h"
 #include "weapon_circular.h"
 #include "weapon_spiral.h"
-#include <cstdlib>
-#include <algorithm>
-#include <typeinfo>
+#include "random.h"
+#include "simulation.h"
 
 namespace UpgradeSystem {
-    std::vector<UpgradeOption> generateUpgradeOptions(Actor::Player* player) {
-        std::vector<UpgradeOption> options;
+    OptionList generateUpgradeOptions(Actor::Player* player) {
+        OptionList options;
         
         // Get player's weapons
         auto& weapons = player->getWeapons();
         
         // Find all weapons that can be upgraded
-        std::vector<Actor::WeaponBase*> upgradableWeapons;
+        Actor::Player::WeaponList upgradableWeapons;
         for (auto& weapon : weapons) {
             if (weapon && canUpgradeWeapon(weapon)) {
                 upgradableWeapons.push_back(weapon);
@@ -28,8 +27,8 @@ namespace UpgradeSystem {
         
         // If there are upgradable weapons, randomly select one
         if (!upgradableWeapons.empty()) {
-            int randomIndex = rand() % upgradableWeapons.size();
-            UpgradeOption upgradeOption;
+            int randomIndex = Random::range(upgradableWeapons.size());
+            UpgradeOption upgradeOption{};
             upgradeOption.type = UpgradeType::WEAPON_UPGRADE;
             upgradeOption.weapon = upgradableWeapons[randomIndex];
             options.push_back(upgradeOption);
@@ -38,19 +37,15 @@ namespace UpgradeSystem {
         // Check if player can get a new weapon (different from current)
         // Try up to 10 times to find a valid new weapon (increased from 3)
         for (int i = 0; i < 10; i++) {
-            int weaponType = rand() % 4;
-            Actor::WeaponBase* newWeapon = createWeapon(weaponType);
+            auto weaponType = (Actor::WeaponType)Random::range(4);
             
-            if (newWeapon && canAddWeapon(player, newWeapon)) {
-                UpgradeOption newWeaponOption;
+            if (canAddWeapon(player, weaponType)) {
+                UpgradeOption newWeaponOption{};
                 newWeaponOption.type = UpgradeType::NEW_WEAPON;
-                newWeaponOption.weapon = newWeapon;
+                newWeaponOption.newWeapon = weaponType;
                 options.push_back(newWeaponOption);
                 break; // Only add one new weapon option
             }
-            
-            // Clean up the temporary weapon
-            delete newWeapon;
         }
         
         return options;
@@ -63,10 +58,11 @@ namespace UpgradeSystem {
                 option.weapon->upgrade();
             }
         } else if (option.type == UpgradeType::NEW_WEAPON) {
-            // Add the new weapon to the player
-            if (option.weapon && player) {
-                option.weapon->setPlayer(player);
-                player->addWeapon(option.weapon);
+            // Create the new weapon only now, the options that were not picked never allocate
+            Actor::WeaponBase* weapon = player ? createWeapon(option.newWeapon) : nullptr;
+            if (weapon) {
+                weapon->setPlayer(player);
+                player->addWeapon(weapon);
             }
         }
     }
@@ -76,34 +72,31 @@ namespace UpgradeSystem {
         return weapon->getUpgradeLevel() < weapon->getMaxUpgradeLevel();
     }
     
-    bool canAddWeapon(Actor::Player* player, Actor::WeaponBase* newWeapon) {
-        if (!player || !newWeapon) return false;
+    bool canAddWeapon(Actor::Player* player, Actor::WeaponType newWeapon) {
+        if (!player) return false;
         
         // Check if player already has this type of weapon
         auto& weapons = player->getWeapons();
         for (auto& weapon : weapons) {
-            if (weapon) {
-                // Compare types - this is a simplified approach
-                // In a real implementation, you might want a better way to identify weapon types
-                if (typeid(*weapon) == typeid(*newWeapon)) {
-                    return false;
-                }
+            if (weapon && weapon->getWeaponType() == newWeapon) {
+                return false;
             }
         }
         
-        return true;
+        return !weapons.full();
     }
     
-    Actor::WeaponBase* createWeapon(int weaponType) {
-            switch (weaponType) {
-            case 0:
-                return new Actor::WeaponProjectile();
-            case 1:
-                return new Actor::WeaponHoming();
-            case 2:
-                return new Actor::WeaponCircular();
-            case 3:
-                return new Actor::WeaponSpiral();
+    Actor::WeaponBase* createWeapon(Actor::WeaponType weaponType) {
+        Arena &arena = Simulation::getRoundArena();
+        switch (weaponType) {
+            case Actor::WeaponType::PROJECTILE:
+                return arena.create<Actor::WeaponProjectile>();
+            case Actor::WeaponType::HOMING:
+                return arena.create<Actor::WeaponHoming>();
+            case Actor::WeaponType::CIRCULAR:
+                return arena.create<Actor::WeaponCircular>();
+            case Actor::WeaponType::SPIRAL:
+                return arena.create<Actor::WeaponSpiral>();
             default:
                 return nullptr;
         }
@@ -5,7 +5,7 @@
 #pragma once
 #include "../actors/player.h"
 #include "weapon_base.h"
-#include <vector>
+#include "../memory/fixedVector.h"
 
 namespace UpgradeSystem {
     enum class UpgradeType {
@@ -15,12 +15,16 @@ namespace UpgradeSystem {
     
     struct UpgradeOption {
         UpgradeType type;
-        Actor::WeaponBase* weapon;  // For weapon upgrades, this is the weapon to upgrade
-                                    // For new weapons, this is the new weapon type
+        Actor::WeaponBase* weapon;    // For weapon upgrades, this is the weapon to upgrade
+        Actor::WeaponType newWeapon;  // For new weapons, the type to create once the option is applied
     };
+
+    // At most one weapon upgrade and one new weapon
+    constexpr uint32_t MAX_OPTIONS = 2;
+    using OptionList = FixedVector<UpgradeOption, MAX_OPTIONS>;
     
     // Generate upgrade options for a player
-    std::vector<UpgradeOption> generateUpgradeOptions(Actor::Player* player);
+    OptionList generateUpgradeOptions(Actor::Player* player);
     
     // Apply an upgrade option to a player
     void applyUpgrade(Actor::Player* player, const UpgradeOption& option);
@@ -29,8 +33,8 @@ namespace UpgradeSystem {
     bool canUpgradeWeapon(Actor::WeaponBase* weapon);
     
     // Check if a player can receive a new weapon (doesn't already have it)
-    bool canAddWeapon(Actor::Player* player, Actor::WeaponBase* newWeapon);
+    bool canAddWeapon(Actor::Player* player, Actor::WeaponType newWeapon);
     
-    // Create a new weapon of a specific type
-    Actor::WeaponBase* createWeapon(int weaponType);
+    // Create a new weapon of a specific type, owned by the round arena
+    Actor::WeaponBase* createWeapon(Actor::WeaponType weaponType);
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 */
 #include "weapon_homing.h"
 #include "../actors/player.h"
+#include "targeting_system.h"
 #include <libdragon.h>
 #include <cmath>
 #include <algorithm>
@@ -73,36 +74,14 @@ namespace Actor {
         }};
         
         // Find the closest enemy
-        Actor::Enemy* closestEnemy = nullptr;
-        float closestDistanceSq = detectionRange * detectionRange;
-        
-        // Iterate through all enemies to find the closest one
-        for (uint32_t i = 0; i < MAX_ENEMIES; i++) {
-            if (Actor::Enemy::isActive(i)) {
-                Actor::Enemy* enemy = Actor::Enemy::getEnemy(i);
-                if (enemy && enemy->isActive()) {
-                    T3DVec3 enemyPos = enemy->getPosition();
-                    
-                    // Calculate squared distance to avoid sqrt
-                    float dx = enemyPos.x - spawnPos.x;
-                    float dy = enemyPos.y - spawnPos.y;
-                    float distanceSq = dx * dx + dy * dy;
-                    
-                    // Check if this enemy is closer
-                    if (distanceSq < closestDistanceSq) {
-                        closestDistanceSq = distanceSq;
-                        closestEnemy = enemy;
-                    }
-                }
-            }
-        }
+        uint16_t closestEnemy = TargetingSystem::findNearestEnemy(spawnPos, detectionRange);
         
         // Determine firing direction
         T3DVec3 fireDirection = direction;
         
         // If we found a close enemy, aim toward it
-        if (closestEnemy != nullptr) {
-            T3DVec3 enemyPos = closestEnemy->getPosition();
+        if (closestEnemy != Actor::Enemy::INVALID_INDEX) {
+            const T3DVec3 &enemyPos = Actor::Enemy::getPosition(closestEnemy);
             
             // Calculate direction to enemy
             fireDirection.x = enemyPos.x - spawnPos.x;
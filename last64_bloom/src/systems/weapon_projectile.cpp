@@ -3,6 +3,7 @@
 * @license MIT
 */
 #include "weapon_projectile.h"
+#include "random.h"
 #include <libdragon.h>
 #include <cmath>
 
@@ -97,7 +98,7 @@ namespace Actor {
         if(!player)return;
 
         // Fire in a random direction
-        float randomAngle = (float)(rand() % 360) * (M_PI / 180.0f);
+        float randomAngle = (float)Random::range(360) * (M_PI / 180.0f);
         T3DVec3 direction = {{
             sinf(randomAngle),
             cosf(randomAngle),
@@ -8,7 +8,7 @@
 #include "../actors/projectile.h"
 #include <libdragon.h>
 #include <cmath>
-#include <vector>
+#include "../memory/fixedVector.h"
 #include <algorithm>
 
 #ifndef M_PI
@@ -21,7 +21,7 @@
 namespace Actor {
     // Store orbiting projectile data
     struct OrbitingProjectile {
-        Projectile* projectile;
+        Projectile::Handle projectile;
         float angleOffset;
         float distance;
         float rotationSpeed;
@@ -31,8 +31,8 @@ namespace Actor {
     };
     
     // Static storage for orbiting projectiles
-    static std::vector<OrbitingProjectile> orbitingProjectiles;
     static const int MAX_ORBITING_PROJECTILES = 20;
+    static FixedVector<OrbitingProjectile, MAX_ORBITING_PROJECTILES> orbitingProjectiles;
     
     WeaponSpiral::WeaponSpiral() : WeaponBase(WeaponType::SPIRAL) {
         // Set weapon-specific properties
@@ -63,7 +63,7 @@ namespace Actor {
         }
         
         // Auto-fire logic - create new orbiting projectiles
-        if (fireCooldown <= 0 && player && orbitingProjectiles.size() < MAX_ORBITING_PROJECTILES) {
+        if (fireCooldown <= 0 && player && !orbitingProjectiles.full()) {
             fireCooldown = fireRate;
             
             T3DVec3 playerPos = player->getPosition();
@@ -78,7 +78,7 @@ namespace Actor {
             OrbitingProjectile& orbit = *it;
             
             // Check if projectile is still active
-            if (!orbit.projectile || !orbit.projectile->isActive()) {
+            if (!Projectile::isAlive(orbit.projectile)) {
                 it = orbitingProjectiles.erase(it);
                 continue;
             }
@@ -86,7 +86,7 @@ namespace Actor {
             // Update lifetime
             orbit.lifetime -= deltaTime;
             if (orbit.lifetime <= 0) {
-                orbit.projectile->deactivate();
+                Projectile::deactivate(orbit.projectile.index);
                 it = orbitingProjectiles.erase(it);
                 continue;
             }
@@ -102,13 +102,7 @@ namespace Actor {
             }};
             
             // Update projectile position directly
-            orbit.projectile->setPosition(newPos);
-            
-            // Update projectile matrix for rendering
-            if (orbit.projectile->isActive()) {
-                // This would require access to the projectile's matrix, which we don't have
-                // We'll need to work within the existing system
-            }
+            Projectile::setPosition(orbit.projectile.index, newPos);
             
             ++it;
         }
@@ -128,7 +122,7 @@ namespace Actor {
         
         for (int i = 0; i < projectileCount; i++) {
             // Skip if we've reached the maximum
-            if (orbitingProjectiles.size() >= MAX_ORBITING_PROJECTILES) {
+            if (orbitingProjectiles.full()) {
                 break;
             }
             
@@ -146,7 +140,7 @@ namespace Actor {
             }};
             
             // Spawn a stationary projectile (velocity = 0)
-            Projectile* projectile = Projectile::spawn(
+            Projectile::Handle projectile = Projectile::spawn(
                 spawnPos, 
                 {{0, 0, 0}}, 
                 0.0f, 
@@ -157,7 +151,7 @@ namespace Actor {
             );
             
             // Store projectile for orbiting
-            if (projectile) {
+            if (Projectile::isAlive(projectile)) {
                 OrbitingProjectile orbitProj;
                 orbitProj.projectile = projectile;
                 orbitProj.angleOffset = angle;
@@ -9,6 +9,28 @@
 #define SQRT_2_INV 0.70710678118f
 #define KF_TIME_TICK (1.0f / 60.0f)
 
+#define STREAM_QUEUE_SIZE 32
+#define STREAM_BUFF_SIZE ((T3D_ANIM_STREAM_PAGE_SIZE + T3D_ANIM_STREAM_PAGE_PAD + 15) & ~15)
+
+enum {
+  STREAM_STATE_EMPTY = 0,
+  STREAM_STATE_QUEUED,
+  STREAM_STATE_LOADING,
+  STREAM_STATE_READY,
+};
+
+typedef struct {
+  T3DAnimStream *stream;
+  uint8_t buffIdx;
+} T3DAnimStreamReq;
+
+// All streams share this queue, the PI can only run one DMA at a time anyway.
+// The first entry is the one currently loading (if 'isLoading' is set).
+static T3DAnimStreamReq streamQueue[STREAM_QUEUE_SIZE];
+static uint32_t streamQueueStart = 0;
+static uint32_t streamQueueCount = 0;
+static bool streamQueueIsLoading = false;
+
 // Maps the input data streamed from the animation data file
 typedef struct {
   uint16_t nextTime;
@@ -16,6 +38,176 @@ typedef struct {
   uint16_t data[2]; // can be either 1 or 2 16-bit values (scalar / quat)
 } T3DAnimKF;
 
+// Bytes to load for 'pageCount' pages starting at 'page', including the overlap into the next one
+static inline uint32_t stream_load_size(const T3DAnimStream *stream, uint32_t page, uint32_t pageCount) {
+  uint32_t size = stream->size - page * T3D_ANIM_STREAM_PAGE_SIZE;
+  uint32_t maxSize = pageCount * T3D_ANIM_STREAM_PAGE_SIZE + T3D_ANIM_STREAM_PAGE_PAD;
+  return size > maxSize ? maxSize : size;
+}
+
+static void stream_queue_pop() {
+  streamQueueStart = (streamQueueStart + 1) % STREAM_QUEUE_SIZE;
+  --streamQueueCount;
+}
+
+/**
+ * Finishes the running DMA if it's done and starts the next one.
+ * With 'block' set, this waits for the running DMA instead of returning early.
+ */
+static void stream_queue_poll(bool block) {
+  if(streamQueueIsLoading) {
+    if(block) {
+      dma_wait();
+    } else if(dma_busy()) {
+      return;
+    }
+
+    T3DAnimStreamReq *req = &streamQueue[streamQueueStart];
+    req->stream->buffState[req->buffIdx] = STREAM_STATE_READY;
+    streamQueueIsLoading = false;
+    stream_queue_pop();
+  }
+
+  if(streamQueueCount == 0)return;
+
+  T3DAnimStreamReq *req = &streamQueue[streamQueueStart];
+  T3DAnimStream *stream = req->stream;
+  uint32_t page = stream->buffPage[req->buffIdx];
+  uint8_t *buff = stream->buff[req->buffIdx];
+
+  // page may have been changed while queued, so the address is only resolved here
+  data_cache_hit_writeback_invalidate(buff, STREAM_BUFF_SIZE);
+  dma_read_async(buff, stream->romAddr + page * T3D_ANIM_STREAM_PAGE_SIZE, stream_load_size(stream, page, 1));
+  stream->buffState[req->buffIdx] = STREAM_STATE_LOADING;
+  streamQueueIsLoading = true;
+}
+
+// Returns the buffer holding (or loading) 'page', -1 if there is none
+static inline int stream_find_buff(const T3DAnimStream *stream, uint32_t page) {
+  for(int i=0; i<2; ++i) {
+    if(stream->buffPage[i] == (int32_t)page && stream->buffState[i] != STREAM_STATE_EMPTY)return i;
+  }
+  return -1;
+}
+
+// Requests 'page' to be loaded into 'buffIdx', replacing whatever was there
+static void stream_request_page(T3DAnimStream *stream, uint32_t page, uint32_t buffIdx) {
+  if(stream->buffPage[buffIdx] == (int32_t)page && stream->buffState[buffIdx] != STREAM_STATE_EMPTY)return;
+
+  // can't redirect a running DMA, let it finish first
+  while(stream->buffState[buffIdx] == STREAM_STATE_LOADING)stream_queue_poll(true);
+
+  stream->buffPage[buffIdx] = page;
+  if(stream->buffState[buffIdx] == STREAM_STATE_QUEUED)return; // queued entry picks up the new page
+
+  while(streamQueueCount == STREAM_QUEUE_SIZE)stream_queue_poll(true);
+
+  streamQueue[(streamQueueStart + streamQueueCount) % STREAM_QUEUE_SIZE] = (T3DAnimStreamReq){stream, buffIdx};
+  ++streamQueueCount;
+  stream->buffState[buffIdx] = STREAM_STATE_QUEUED;
+  if(!streamQueueIsLoading)stream_queue_poll(false);
+}
+
+// Returns the buffer containing 'page', waits for it if it wasn't prefetched in time
+static const uint8_t* stream_get_page(T3DAnimStream *stream, uint32_t page) {
+  if(page < stream->residentPages) {
+    return stream->resident + page * T3D_ANIM_STREAM_PAGE_SIZE;
+  }
+
+  int buffIdx = stream_find_buff(stream, page);
+  if(buffIdx < 0) {
+    buffIdx = stream->lastBuff ^ 1;
+    stream_request_page(stream, page, buffIdx);
+  }
+  stream->lastBuff = buffIdx;
+
+  while(stream->buffState[buffIdx] != STREAM_STATE_READY)stream_queue_poll(true);
+  return stream->buff[buffIdx];
+}
+
+// Loads the page after the one currently read into the other buffer, wrapping around at the end
+static void stream_prefetch(T3DAnimStream *stream) {
+  if(!stream->buff[0])return;
+
+  uint32_t currPage = stream->readPos == 0 ? 0 : (stream->readPos - 1) / T3D_ANIM_STREAM_PAGE_SIZE;
+  uint32_t nextPage = currPage + 1;
+  if(nextPage < stream->residentPages || nextPage * T3D_ANIM_STREAM_PAGE_SIZE >= stream->size) {
+    nextPage = stream->residentPages;
+  }
+  if(stream_find_buff(stream, nextPage) >= 0)return;
+
+  int currBuff = stream_find_buff(stream, currPage);
+  stream_request_page(stream, nextPage, currBuff >= 0 ? (currBuff ^ 1) : (stream->lastBuff ^ 1));
+}
+
+static T3DAnimStream* stream_create(const char *filePath, uint32_t channelCount) {
+  // DMA needs the raw ROM address, the path is always 'rom:/...' when coming from the importer
+  assertf(strncmp(filePath, "rom:/", 5) == 0, "Animation data must be in the ROM: %s", filePath);
+
+  int size = 0;
+  FILE *file = asset_fopen(filePath, &size);
+
+  T3DAnimStream *stream = malloc(sizeof(T3DAnimStream));
+  *stream = (T3DAnimStream){
+    .romAddr = dfs_rom_addr(filePath + 4),
+    .size = size,
+    .buffPage = {-1, -1},
+  };
+  assertf(stream->romAddr, "Animation data not found: %s", filePath);
+
+  // DMAs would read the compressed bytes, only the asset reader can decompress it
+  int dfsHandle = dfs_open(filePath + 4);
+  bool isCompressed = dfs_size(dfsHandle) != size;
+  dfs_close(dfsHandle);
+
+  if(isCompressed) {
+    stream->residentPages = (size + T3D_ANIM_STREAM_PAGE_SIZE - 1) / T3D_ANIM_STREAM_PAGE_SIZE;
+    stream->resident = memalign(16, (size + 15) & ~15);
+    int readSize = fread(stream->resident, 1, size, file);
+    assertf(readSize == size, "Failed to read animation data: %s", filePath);
+    fclose(file);
+    return stream;
+  }
+  fclose(file);
+
+  // the start is kept around for loops, short animations don't need any other buffers.
+  // The extra page covers the rest of the update that loops, while the next page is prefetched.
+  uint32_t burstSize = channelCount * sizeof(T3DAnimKF);
+  stream->residentPages = (burstSize + T3D_ANIM_STREAM_PAGE_SIZE - 1) / T3D_ANIM_STREAM_PAGE_SIZE + 1;
+
+  uint32_t residentSize = stream_load_size(stream, 0, stream->residentPages);
+  stream->resident = memalign(16, (residentSize + 15) & ~15);
+  data_cache_hit_writeback_invalidate(stream->resident, (residentSize + 15) & ~15);
+  dma_read(stream->resident, stream->romAddr, residentSize);
+
+  if(stream->size > stream->residentPages * T3D_ANIM_STREAM_PAGE_SIZE) {
+    stream->buff[0] = memalign(16, STREAM_BUFF_SIZE * 2);
+    stream->buff[1] = stream->buff[0] + STREAM_BUFF_SIZE;
+    stream_prefetch(stream);
+  }
+  return stream;
+}
+
+static void stream_destroy(T3DAnimStream *stream) {
+  if(streamQueueIsLoading && streamQueue[streamQueueStart].stream == stream) {
+    stream_queue_poll(true); // DMA would otherwise write into freed memory
+  }
+
+  // drop all other requests of this stream, keeping the order
+  uint32_t newCount = 0;
+  for(uint32_t i=0; i<streamQueueCount; ++i) {
+    T3DAnimStreamReq req = streamQueue[(streamQueueStart + i) % STREAM_QUEUE_SIZE];
+    if(req.stream != stream) {
+      streamQueue[(streamQueueStart + newCount++) % STREAM_QUEUE_SIZE] = req;
+    }
+  }
+  streamQueueCount = newCount;
+
+  free(stream->resident);
+  if(stream->buff[0])free(stream->buff[0]);
+  free(stream);
+}
+
 T3DAnim t3d_anim_create(const T3DModel *model, const char *name) {
   T3DChunkAnim* animDef = t3d_model_get_animation(model, name);
   assertf(animDef, "Animation '%s' not found in model", name);
@@ -27,7 +219,7 @@ T3DAnim t3d_anim_create(const T3DModel *model, const char *name) {
     .time = 0.0f,
     .speed = 1.0f,
     .nextKfSize = sizeof(T3DAnimKF),
-    .file = asset_fopen(animDef->filePath, NULL),
+    .stream = stream_create(animDef->filePath, animDef->channelsQuat + animDef->channelsScalar),
     .isPlaying = 1,
     .isLooping = 1
   };
@@ -42,7 +234,7 @@ static void rewind_anim(T3DAnim *anim)
     anim->targetsQuat[c].base.timeEnd = 0;
   }
   anim->nextKfSize = sizeof(T3DAnimKF);
-  rewind(anim->file);
+  anim->stream->readPos = 0;
 }
 
 void t3d_anim_attach(T3DAnim *anim, const T3DSkeleton *skeleton) {
@@ -137,9 +329,15 @@ static inline T3DAnimTargetBase* get_base_target(T3DAnim *anim, uint64_t channel
 }
 
 static inline bool load_keyframe(T3DAnim *anim) {
+  T3DAnimStream *stream = anim->stream;
+  if(stream->readPos + anim->nextKfSize > stream->size)return false;
+
+  uint32_t page = stream->readPos / T3D_ANIM_STREAM_PAGE_SIZE;
+  const uint8_t *pageData = stream_get_page(stream, page);
+
   T3DAnimKF kf;
-  size_t readBytes = fread(&kf, anim->nextKfSize, 1, anim->file);
-  if(readBytes == 0)return false;
+  memcpy(&kf, pageData + (stream->readPos - page * T3D_ANIM_STREAM_PAGE_SIZE), anim->nextKfSize);
+  stream->readPos += anim->nextKfSize;
 
   bool isLarge = kf.nextTime & 0x8000;
   anim->nextKfSize = isLarge ? sizeof(T3DAnimKF) : (sizeof(T3DAnimKF)-2);
@@ -168,6 +366,7 @@ static inline bool load_keyframe(T3DAnim *anim) {
 }
 
 void t3d_anim_update(T3DAnim *anim, float deltaTime) {
+  stream_queue_poll(false);
   if(!anim->isPlaying)return;
   int32_t updateFlag = 1;
   anim->time += deltaTime * anim->speed;
@@ -206,14 +405,18 @@ void t3d_anim_update(T3DAnim *anim, float deltaTime) {
       *t->targetScalar = t3d_lerp(t->kfCurr, t->kfNext, interp);
     }
   }
+
+  // the keyframes took a while, a DMA may have finished in the meantime
+  stream_queue_poll(false);
+  stream_prefetch(anim->stream);
 }
 
 void t3d_anim_destroy(T3DAnim *anim) {
   if(anim->targetsQuat)free(anim->targetsQuat); // 'targetsScalar' is part of this memory-block
-  if(anim->file)fclose(anim->file);
+  if(anim->stream)stream_destroy(anim->stream);
   anim->targetsQuat = NULL;
   anim->targetsScalar = NULL;
-  anim->file = NULL;
+  anim->stream = NULL;
 }
 
 void t3d_anim_set_time(T3DAnim *anim, float time) {
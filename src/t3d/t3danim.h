@@ -38,6 +38,28 @@ typedef struct {
   float kfNext;
 } T3DAnimTargetScalar;
 
+#define T3D_ANIM_STREAM_PAGE_SIZE 512 // bytes of keyframes per DMA
+#define T3D_ANIM_STREAM_PAGE_PAD 8 // pages overlap by one keyframe, so a keyframe never spans two
+
+/**
+ * Keyframe stream of an animation instance, read from ROM via PI DMA.
+ * The start of the stream stays resident, so rewinds and loops never hit ROM again.
+ * It holds one keyframe per channel, which are all read at once after a rewind, plus one page for the rest of that update.
+ * All later pages go through two buffers, while one is read the next page is already loading into the other one.
+ * Files compressed by mkasset can't be read with DMAs, they are kept resident in full instead.
+ */
+typedef struct {
+  uint8_t *resident;
+  uint8_t *buff[2];
+  uint32_t residentPages; // number of pages in 'resident'
+  uint32_t romAddr;
+  uint32_t size; // total size of the stream in bytes
+  uint32_t readPos; // byte offset of the next keyframe
+  int32_t buffPage[2]; // page loaded or requested in each buffer, -1 if none
+  uint8_t buffState[2]; // internal loading state of each buffer
+  uint8_t lastBuff; // buffer keyframes were last read from
+} T3DAnimStream;
+
 typedef struct {
   T3DChunkAnim *animRef;
   T3DAnimTargetQuat *targetsQuat;
@@ -46,7 +68,7 @@ typedef struct {
   float speed;
   float time;
 
-  FILE *file;
+  T3DAnimStream *stream;
   int nextKfSize;
   uint8_t isPlaying;
   uint8_t isLooping;
@@ -0,0 +1,132 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#include "t3danimlod.h"
+
+#define LOD_SLOT_COUNT (1 << T3D_ANIM_LOD_LEVELS)
+#define LOD_NO_PALETTE 0xFF
+
+T3DAnimLod t3d_anim_lod_create(const T3DAnimLodConf *conf) {
+  return (T3DAnimLod){
+    .conf = *conf,
+  };
+}
+
+T3DAnimLodInst t3d_anim_lod_inst_create(T3DAnimLod *lod, const T3DSkeleton *skel) {
+  T3DAnimLodInst inst = {
+    .slot = lod->nextSlot,
+    .latestPalette = LOD_NO_PALETTE,
+  };
+  lod->nextSlot = (lod->nextSlot + 1) % LOD_SLOT_COUNT;
+
+  if(lod->conf.interpolate) {
+    inst.palettes = malloc(sizeof(T3DMat4FP) * skel->skeletonRef->boneCount * 2);
+  }
+  return inst;
+}
+
+void t3d_anim_lod_begin_frame(T3DAnimLod *lod) {
+  ++lod->frame;
+  lod->updatedBones = 0;
+  lod->skippedBones = 0;
+}
+
+uint32_t t3d_anim_lod_get_level(const T3DAnimLod *lod, float distance, float screenSize) {
+  uint32_t level = 0;
+  for(uint32_t i=0; i<T3D_ANIM_LOD_LEVELS; ++i) {
+    float minDist = lod->conf.distance[i];
+    float minSize = lod->conf.screenSize[i];
+    if(minDist > 0.0f && distance >= minDist)level = i + 1;
+    if(minSize > 0.0f && screenSize > 0.0f && screenSize < minSize)level = i + 1;
+  }
+  return level;
+}
+
+bool t3d_anim_lod_should_update(T3DAnimLod *lod, T3DAnimLodInst *inst, float *deltaTime, float distance, float screenSize) {
+  inst->level = t3d_anim_lod_get_level(lod, distance, screenSize);
+  inst->pendingTime += *deltaTime;
+
+  uint32_t intervalMask = (1 << inst->level) - 1;
+  if(((lod->frame + inst->slot) & intervalMask) != 0)return false;
+
+  *deltaTime = inst->pendingTime;
+  inst->pendingTime = 0.0f;
+  return true;
+}
+
+// Interpolates each 16.16 value of the matrices, 'factor' is in 1/256 steps
+static void palette_lerp(T3DMat4FP *res, const T3DMat4FP *matA, const T3DMat4FP *matB, uint32_t count, int32_t factor) {
+  for(uint32_t m=0; m<count; ++m) {
+    for(uint32_t y=0; y<4; ++y) {
+      const T3DVec4FP *rowA = &matA[m].m[y];
+      const T3DVec4FP *rowB = &matB[m].m[y];
+      T3DVec4FP *rowRes = &res[m].m[y];
+
+      for(uint32_t x=0; x<4; ++x) {
+        int32_t valA = (int32_t)(((uint32_t)(uint16_t)rowA->i[x] << 16) | rowA->f[x]);
+        int32_t valB = (int32_t)(((uint32_t)(uint16_t)rowB->i[x] << 16) | rowB->f[x]);
+        int32_t val = valA + (int32_t)(((int64_t)valB - valA) * factor >> 8);
+        rowRes->i[x] = (int16_t)(val >> 16);
+        rowRes->f[x] = (uint16_t)val;
+      }
+    }
+  }
+}
+
+void t3d_anim_lod_update_skeleton(T3DAnimLod *lod, T3DAnimLodInst *inst, T3DSkeleton *skel, bool wasUpdated) {
+  uint32_t boneCount = skel->skeletonRef->boneCount;
+
+  // full rate is never interpolated, the next lower rate starts over from the pose at that time
+  bool interpolate = inst->palettes && inst->level != 0;
+  if(!interpolate && inst->latestPalette != LOD_NO_PALETTE) {
+    // the interpolation wrote all buffers without the skeleton knowing, so all bones have to be written again
+    for(uint32_t i=0; i<boneCount; ++i)skel->bones[i].pendingBuffers = skel->bufferCount;
+    inst->latestPalette = LOD_NO_PALETTE;
+  }
+
+  if(wasUpdated) {
+    t3d_skeleton_update(skel);
+    lod->updatedBones += boneCount;
+  } else {
+    lod->skippedBones += boneCount;
+  }
+
+  if(!interpolate)return;
+
+  if(wasUpdated) {
+    // bone matrices of the skeleton are always complete, unlike the buffered fixed-point ones
+    uint32_t newIdx = inst->latestPalette == LOD_NO_PALETTE ? 0 : (inst->latestPalette ^ 1);
+    T3DMat4FP *palette = &inst->palettes[newIdx * boneCount];
+    for(uint32_t i=0; i<boneCount; ++i) {
+      t3d_mat4_to_fixed_3x4(&palette[i], &skel->bones[i].matrix);
+    }
+    if(inst->latestPalette == LOD_NO_PALETTE) {
+      memcpy(&inst->palettes[boneCount], palette, sizeof(T3DMat4FP) * boneCount);
+    }
+    inst->latestPalette = newIdx;
+    inst->framesSinceUpdate = 0;
+  } else {
+    if(inst->latestPalette == LOD_NO_PALETTE)return; // nothing to interpolate yet, keep the old matrices
+    skel->currentBufferIdx = (skel->currentBufferIdx + 1) % skel->bufferCount;
+    ++inst->framesSinceUpdate;
+  }
+
+  // the animation lags one update behind, so it can move from the previous pose towards the latest one
+  int32_t factor = (inst->framesSinceUpdate << 8) >> inst->level;
+  if(factor > 256)factor = 256;
+
+  palette_lerp(
+    &skel->boneMatricesFP[skel->currentBufferIdx * boneCount],
+    &inst->palettes[(inst->latestPalette ^ 1) * boneCount],
+    &inst->palettes[inst->latestPalette * boneCount],
+    boneCount, factor
+  );
+}
+
+void t3d_anim_lod_inst_destroy(T3DAnimLodInst *inst) {
+  if(inst->palettes) {
+    free(inst->palettes);
+    inst->palettes = NULL;
+  }
+}
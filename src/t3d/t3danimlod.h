@@ -0,0 +1,134 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#ifndef TINY3D_T3DANIMLOD_H
+#define TINY3D_T3DANIMLOD_H
+
+#include "t3danim.h"
+#include "t3dskeleton.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define T3D_ANIM_LOD_LEVELS 3 // 1/2, 1/4 and 1/8 rate
+
+typedef struct {
+  float distance[T3D_ANIM_LOD_LEVELS]; // distance from which 1/2, 1/4, 1/8 rate is used, 0 to disable
+  float screenSize[T3D_ANIM_LOD_LEVELS]; // screen size (e.g. height in pixels) below which 1/2, 1/4, 1/8 rate is used, 0 to disable
+  bool interpolate; // interpolate the matrices between updates, this delays the animation by one update
+} T3DAnimLodConf;
+
+/**
+ * Animation update-rate LOD, shared by all instances of a model.
+ * Distant or small skeletons are only evaluated every 2nd, 4th or 8th frame.
+ * Each instance gets a different slot, so the updates of a crowd are spread evenly across frames.
+ */
+typedef struct {
+  T3DAnimLodConf conf;
+  uint32_t frame;
+  uint32_t nextSlot;
+  uint32_t updatedBones; // bones evaluated in the current frame
+  uint32_t skippedBones; // bones skipped (or interpolated) in the current frame
+} T3DAnimLod;
+
+/**
+ * LOD state of a single animated instance.
+ */
+typedef struct {
+  T3DMat4FP *palettes; // last two evaluated poses, only allocated if interpolating
+  float pendingTime; // time not yet applied to the animations
+  uint8_t slot; // frame offset in the round-robin
+  uint8_t level; // current rate as a shift (0 = every frame)
+  uint8_t framesSinceUpdate;
+  uint8_t latestPalette; // index of the newer pose in 'palettes'
+} T3DAnimLodInst;
+
+/**
+ * Creates a LOD policy.
+ * @param conf thresholds, can be shared with other models
+ * @return LOD policy
+ */
+T3DAnimLod t3d_anim_lod_create(const T3DAnimLodConf *conf);
+
+/**
+ * Creates the LOD state of an instance, and assigns it the next slot in the round-robin.
+ * @param lod LOD policy
+ * @param skel skeleton of the instance
+ * @return instance state
+ */
+T3DAnimLodInst t3d_anim_lod_inst_create(T3DAnimLod *lod, const T3DSkeleton *skel);
+
+/**
+ * Starts a new frame, call this once per frame before updating any instance.
+ * @param lod LOD policy
+ */
+void t3d_anim_lod_begin_frame(T3DAnimLod *lod);
+
+/**
+ * Returns the rate for an instance as a shift, so it gets evaluated every '1 << level' frames.
+ * @param lod LOD policy
+ * @param distance distance to the camera
+ * @param screenSize size on screen, in the same unit as the thresholds, 0 to ignore
+ * @return level, 0 to T3D_ANIM_LOD_LEVELS
+ */
+uint32_t t3d_anim_lod_get_level(const T3DAnimLod *lod, float distance, float screenSize);
+
+/**
+ * Checks if an instance should be evaluated in this frame.
+ * Skipped time is never lost, it's collected and applied in full on the next update.
+ * So loops and rolled-over flags still happen, and root motion covers the same distance, just in larger steps.
+ * If this returns true, update all animations of the instance by 'deltaTime', then call 't3d_anim_lod_update_skeleton'.
+ *
+ * @param lod LOD policy
+ * @param inst instance state
+ * @param deltaTime in: time since the last frame, out: time to update the animations by
+ * @param distance distance to the camera
+ * @param screenSize size on screen, 0 to ignore
+ * @return true if the animations should be updated
+ */
+bool t3d_anim_lod_should_update(T3DAnimLod *lod, T3DAnimLodInst *inst, float *deltaTime, float distance, float screenSize);
+
+/**
+ * Updates the skeleton of an instance, call this every frame after 't3d_anim_lod_should_update'.
+ * If the instance was not updated, the matrices are either kept or interpolated.
+ * @param lod LOD policy
+ * @param inst instance state
+ * @param skel skeleton to update
+ * @param wasUpdated return value of 't3d_anim_lod_should_update'
+ */
+void t3d_anim_lod_update_skeleton(T3DAnimLod *lod, T3DAnimLodInst *inst, T3DSkeleton *skel, bool wasUpdated);
+
+/**
+ * Updates a single animation and its skeleton, respecting the LOD.
+ * For multiple (blended) animations, use 't3d_anim_lod_should_update' and 't3d_anim_lod_update_skeleton' instead.
+ * @param lod LOD policy
+ * @param inst instance state
+ * @param anim animation to update
+ * @param skel skeleton the animation is attached to
+ * @param deltaTime time since the last frame
+ * @param distance distance to the camera
+ * @param screenSize size on screen, 0 to ignore
+ */
+static inline void t3d_anim_lod_update(
+  T3DAnimLod *lod, T3DAnimLodInst *inst, T3DAnim *anim, T3DSkeleton *skel,
+  float deltaTime, float distance, float screenSize
+) {
+  bool doUpdate = t3d_anim_lod_should_update(lod, inst, &deltaTime, distance, screenSize);
+  if(doUpdate)t3d_anim_update(anim, deltaTime);
+  t3d_anim_lod_update_skeleton(lod, inst, skel, doUpdate);
+}
+
+/**
+ * Frees data allocated by the instance state.
+ * @param inst instance state
+ */
+void t3d_anim_lod_inst_destroy(T3DAnimLodInst *inst);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //TINY3D_T3DANIMLOD_H
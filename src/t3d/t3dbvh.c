@@ -0,0 +1,118 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+
+#include "t3dmodel.h"
+
+#define BVH_STACK_SIZE 64
+#define BVH_PLANES_ALL 0b111111
+#define BVH_OUTSIDE 0xFFFFFFFF
+
+typedef struct {
+  uint16_t nodeIdx;
+  uint8_t planeMask; // planes the node is not known to be fully inside of
+} T3DBvhStackEntry;
+
+// Per plane, the AABB corners furthest along (and against) its normal, as indices into [min, max]
+typedef struct {
+  uint8_t idxFar[3];
+  uint8_t idxNear[3];
+} T3DBvhPlaneCorners;
+
+static void get_plane_corners(const T3DFrustum *frustum, T3DBvhPlaneCorners corners[6])
+{
+  for(int i=0; i<6; ++i) {
+    for(int a=0; a<3; ++a) {
+      bool positive = frustum->planes[i].v[a] >= 0.0f;
+      corners[i].idxFar[a] = positive ? (a + 3) : a;
+      corners[i].idxNear[a] = positive ? a : (a + 3);
+    }
+  }
+}
+
+/**
+ * Checks an AABB ('minMax' points to 'aabbMin', directly followed by 'aabbMax') against all planes set in 'planeMask'.
+ * Returns the subset of planes the AABB intersects, or BVH_OUTSIDE if it is fully outside of any.
+ * This has the same result as 't3d_frustum_vs_aabb_s16', but only needs the two extreme corners per plane.
+ */
+static inline uint32_t aabb_vs_planes(
+  const T3DFrustum *frustum, const T3DBvhPlaneCorners corners[6], const int16_t *minMax, uint32_t planeMask
+) {
+  uint32_t resMask = 0;
+  for(int i=0; i<6; ++i) {
+    if(!(planeMask & (1 << i)))continue;
+
+    const T3DVec4 *plane = &frustum->planes[i];
+    const T3DBvhPlaneCorners *c = &corners[i];
+    float distFar = plane->v[3] + plane->v[0] * minMax[c->idxFar[0]]
+      + plane->v[1] * minMax[c->idxFar[1]] + plane->v[2] * minMax[c->idxFar[2]];
+    if(distFar <= 0.0f)return BVH_OUTSIDE;
+
+    float distNear = plane->v[3] + plane->v[0] * minMax[c->idxNear[0]]
+      + plane->v[1] * minMax[c->idxNear[1]] + plane->v[2] * minMax[c->idxNear[2]];
+    if(distNear <= 0.0f)resMask |= 1 << i;
+  }
+  return resMask;
+}
+
+static uint32_t bvh_query(
+  const T3DBvh *bvh, const T3DFrustum *frustum, T3DObject **outObjects, uint32_t maxObjects, bool setVisible
+) {
+  const T3DBvhData *data = (const T3DBvhData*)&bvh->nodes[bvh->nodeCount]; // data starts right after nodes
+  const char *basePtr = (const char*)bvh;
+
+  T3DBvhPlaneCorners corners[6];
+  get_plane_corners(frustum, corners);
+
+  T3DBvhStackEntry stack[BVH_STACK_SIZE];
+  uint32_t stackSize = 0;
+  uint32_t count = 0;
+  stack[stackSize++] = (T3DBvhStackEntry){0, BVH_PLANES_ALL};
+
+  while(stackSize != 0)
+  {
+    T3DBvhStackEntry entry = stack[--stackSize];
+    const T3DBvhNode *node = &bvh->nodes[entry.nodeIdx];
+
+    // once fully inside all planes, no more checks are needed for the whole sub-tree
+    uint32_t planeMask = entry.planeMask;
+    if(planeMask) {
+      planeMask = aabb_vs_planes(frustum, corners, node->aabbMin, planeMask);
+      if(planeMask == BVH_OUTSIDE)continue;
+    }
+
+    int dataCount = node->value & 0b1111;
+    int offset = (int16_t)node->value >> 4;
+
+    if(dataCount == 0) {
+      assertf(stackSize + 2 <= BVH_STACK_SIZE, "BVH too deep, max. depth: %d", BVH_STACK_SIZE / 2);
+      // pushed in reverse, so objects come out in the same order as the tree
+      stack[stackSize++] = (T3DBvhStackEntry){entry.nodeIdx + offset + 1, planeMask};
+      stack[stackSize++] = (T3DBvhStackEntry){entry.nodeIdx + offset, planeMask};
+      continue;
+    }
+
+    int offsetEnd = offset + dataCount;
+    while(offset < offsetEnd) {
+      T3DObject* obj = (T3DObject*)(basePtr - (data[offset++].objectPtr << 2));
+      if(planeMask && aabb_vs_planes(frustum, corners, obj->aabbMin, planeMask) == BVH_OUTSIDE) {
+        continue;
+      }
+
+      if(setVisible)obj->isVisible = true;
+      if(count < maxObjects)outObjects[count++] = obj;
+    }
+  }
+  return count;
+}
+
+void t3d_model_bvh_query_frustum(const T3DBvh *bvh, const T3DFrustum *frustum) {
+  bvh_query(bvh, frustum, NULL, 0, true);
+}
+
+uint32_t t3d_model_bvh_query_frustum_list(
+  const T3DBvh *bvh, const T3DFrustum *frustum, T3DObject **outObjects, uint32_t maxObjects
+) {
+  return bvh_query(bvh, frustum, outObjects, maxObjects, false);
+}
@@ -382,6 +382,24 @@ inline static void t3d_mat4fp_set_pos(T3DMat4FP *mat, const float pos[3]) {
   t3d_mat4fp_set_float(mat, 3, 2, pos[2]);
 }
 
+/**
+ * Fast path for matrices with only a uniform scale and translation (no rotation).
+ * Compared to 't3d_mat4fp_from_srt_euler' this skips the rotation and float matrix entirely,
+ * and only writes the diagonal and translation words.
+ * Note: all other values must already be zero, e.g. from 't3d_mat4fp_identity' or a previous call to this function.
+ * @param mat matrix to be changed
+ * @param scale uniform scale
+ * @param translate position as a float[3]
+ */
+inline static void t3d_mat4fp_from_scale_translate(T3DMat4FP *mat, float scale, const float translate[3]) {
+  int32_t fixed = T3D_F32_TO_FIXED(scale);
+  for(uint32_t i=0; i<3; ++i) {
+    mat->m[i].i[i] = (int16_t)(fixed >> 16);
+    mat->m[i].f[i] = fixed & 0xFFFF;
+  }
+  t3d_mat4fp_set_pos(mat, translate);
+}
+
 /**
  * @brief Gets a value from a fixed-point matrix
  * @param mat matrix to be read
@@ -511,6 +529,28 @@ inline static void t3d_mat4_mul(T3DMat4 *matRes, const T3DMat4 *matA, const T3DM
   }
 }
 
+/**
+ * Multiplies two affine matrices, same as 't3d_mat4_mul' but faster.
+ * The last column of both matrices is assumed to be {0,0,0,1}, which is the case for any matrix
+ * built from scale, rotation and translation (e.g. 't3d_mat4_from_srt').
+ * @param matRes result, must not be one of the inputs
+ * @param matA left matrix
+ * @param matB right matrix
+ */
+inline static void t3d_mat4_mul_3x4(T3DMat4 *matRes, const T3DMat4 *matA, const T3DMat4 *matB)
+{
+  for(uint32_t j=0; j<4; j++) {
+    for(uint32_t i=0; i<3; i++) {
+      matRes->m[j][i] = matA->m[0][i] * matB->m[j][0] +
+                        matA->m[1][i] * matB->m[j][1] +
+                        matA->m[2][i] * matB->m[j][2];
+    }
+    matRes->m[j][3] = 0.0f;
+  }
+  for(uint32_t i=0; i<3; i++)matRes->m[3][i] += matA->m[3][i];
+  matRes->m[3][3] = 1.0f;
+}
+
 /**
  * Multiplies a 3x3 matrix with a 3D vector
  * @param vecOut result
@@ -584,6 +624,7 @@ inline static void t3d_mat4_mul_vec3(T3DVec4* vecOut, const T3DMat4 *mat, const
   inline void t3d_mat4fp_from_srt_euler(T3DMat4FP *mat, const T3DVec3 &scale, const T3DVec3 &rot, const T3DVec3 &translate) { t3d_mat4fp_from_srt_euler(mat, scale.v, rot.v, translate.v); }
   inline void t3d_mat4fp_from_srt(T3DMat4FP *mat, const T3DVec3 &scale, const T3DQuat &rot, const T3DVec3 &translate) { t3d_mat4fp_from_srt(mat, scale.v, rot.v, translate.v); }
   inline void t3d_mat4fp_set_pos(T3DMat4FP *mat, const T3DVec3 &pos) { t3d_mat4fp_set_pos(mat, pos.v); }
+  inline void t3d_mat4fp_from_scale_translate(T3DMat4FP *mat, float scale, const T3DVec3 &translate) { t3d_mat4fp_from_scale_translate(mat, scale, translate.v); }
   inline float t3d_mat4fp_get_float(const T3DMat4FP &mat, uint32_t y, uint32_t x) { return t3d_mat4fp_get_float(&mat, y, x); }
 
   inline void t3d_mat4_perspective(T3DMat4 &mat, float fov, float aspect, float near, float far) { t3d_mat4_perspective(&mat, fov, aspect, near, far); }
@@ -594,6 +635,7 @@ inline static void t3d_mat4_mul_vec3(T3DVec4* vecOut, const T3DMat4 *mat, const
   inline bool t3d_frustum_vs_aabb(const T3DFrustum &frustum, const T3DVec3 &min, const T3DVec3 &max) { return t3d_frustum_vs_aabb(&frustum, &min, &max); }
   inline bool t3d_frustum_vs_aabb_s16(const T3DFrustum &frustum, const int16_t min[3], const int16_t max[3]) { return t3d_frustum_vs_aabb_s16(&frustum, min, max); }
   inline void t3d_mat4_mul(T3DMat4 &matRes, const T3DMat4 &matA, const T3DMat4 &matB) { t3d_mat4_mul(&matRes, &matA, &matB); }
+  inline void t3d_mat4_mul_3x4(T3DMat4 &matRes, const T3DMat4 &matA, const T3DMat4 &matB) { t3d_mat4_mul_3x4(&matRes, &matA, &matB); }
   inline void t3d_mat3_mul_vec3(T3DVec3 &vecOut, const T3DMat4 &mat, const T3DVec3 &vec) { t3d_mat3_mul_vec3(&vecOut, &mat, &vec); }
   inline void t3d_mat4_mul_vec3(T3DVec4 &vecOut, const T3DMat4 &mat, const T3DVec3 &vec) { t3d_mat4_mul_vec3(&vecOut, &mat, &vec); }
 
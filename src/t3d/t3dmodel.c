@@ -4,6 +4,7 @@
 */
 
 #include "t3dmodel.h"
+#include <malloc.h>
 
 #define T3DM_VERSION 0x04
 
@@ -19,18 +20,24 @@ static inline bool is_power_of_two(uint16_t x) {
   return (x & (x - 1)) == 0;
 }
 
-typedef struct {
-  uint16_t objectPtr;
-} T3DBvhData;
-
 typedef struct {
   uint32_t hash;
   sprite_t *texture;
   uint32_t count;
 } T3DTextureEntry;
 
+typedef struct {
+  const T3DModel *model; // NULL if unused
+  T3DModelDrawConf conf; // settings the blocks were recorded with, 'filterCb' is ignored
+  uint32_t objCount;
+  rspq_block_t *block; // whole model, used without a filter
+  rspq_block_t **objBlocks; // per object: [material of the run it starts (or NULL), mesh]
+} T3DDrawCacheEntry;
+
 static uint32_t textureCacheSize = 0;
 static T3DTextureEntry *textureCache = NULL;
+static uint32_t drawCacheSize = 0;
+static T3DDrawCacheEntry *drawCache = NULL;
 static T3DModelState dummyState;
 
 static sprite_t* texture_cache_get(uint32_t hash) {
@@ -182,11 +189,7 @@ static bool handle_bone_matrix(const T3DObjectPart *part, const T3DMat4FP* matSt
   return hadMatrixPush;
 }
 
-T3DModel *t3d_model_load(const char *path) {
-  int size = 0;
-  T3DModel* model = asset_load(path, &size);
-  int32_t ptrOffset = (int32_t)(void*)model;
-
+static void model_check_header(const T3DModel *model, const char *path) {
   if(memcmp(model->magic, "T3M", 3) != 0) {
     assertf(false, "Invalid T3D model file: %s", path);
   }
@@ -194,83 +197,139 @@ T3DModel *t3d_model_load(const char *path) {
     "Invalid T3D model version: %d != %d\n"
     "Please make a clean build of t3d and your project",
     T3DM_VERSION, model->magic[3]);
+}
 
+// Patches all pointers & data of a chunk, the string-table pointer must already be patched
+static void model_patch_chunk(T3DModel *model, uint32_t i) {
   void* basePtrVertices = (char*)model + (model->chunkOffsets[model->chunkIdxVertices].offset & 0xFFFFFF);
   void* basePtrIndices = (char*)model + (model->chunkOffsets[model->chunkIdxIndices].offset & 0xFFFFFF);
-  model->stringTablePtr = patch_pointer(model->stringTablePtr, ptrOffset);
 
-  for(uint32_t i = 0; i < model->chunkCount; i++)
-  {
-    char chunkType = model->chunkOffsets[i].type;
-    uint32_t offset = model->chunkOffsets[i].offset & 0x00FFFFFF;
-    //debugf("Chunk[%lu] '%c': %lx\n", i, chunkType, (uint32_t)offset);
+  char chunkType = model->chunkOffsets[i].type;
+  uint32_t offset = model->chunkOffsets[i].offset & 0x00FFFFFF;
+  //debugf("Chunk[%lu] '%c': %lx\n", i, chunkType, (uint32_t)offset);
 
-    if(chunkType == T3D_CHUNK_TYPE_OBJECT) {
-      T3DObject *obj = (T3DObject*)((char*)model + offset);
-      if(obj->name != NULL) {
-        obj->name = patch_pointer(obj->name, (uint32_t)model->stringTablePtr);
-      }
+  if(chunkType == T3D_CHUNK_TYPE_OBJECT) {
+    T3DObject *obj = (T3DObject*)((char*)model + offset);
+    if(obj->name != NULL) {
+      obj->name = patch_pointer(obj->name, (uint32_t)model->stringTablePtr);
+    }
 
-      uint32_t matIdx = model->chunkIdxMaterials + (uint32_t)obj->material;
-      obj->material = (T3DMaterial*)((char*)model + (model->chunkOffsets[matIdx].offset & 0xFFFFFF));
+    uint32_t matIdx = model->chunkIdxMaterials + (uint32_t)obj->material;
+    obj->material = (T3DMaterial*)((char*)model + (model->chunkOffsets[matIdx].offset & 0xFFFFFF));
 
-      for(uint32_t j = 0; j < obj->numParts; j++) {
-        T3DObjectPart *part = &obj->parts[j];
-        part->indices = patch_pointer(part->indices, (uint32_t)basePtrIndices);
-        part->vert = patch_pointer(part->vert, (uint32_t)basePtrVertices);
+    for(uint32_t j = 0; j < obj->numParts; j++) {
+      T3DObjectPart *part = &obj->parts[j];
+      part->indices = patch_pointer(part->indices, (uint32_t)basePtrIndices);
+      part->vert = patch_pointer(part->vert, (uint32_t)basePtrVertices);
 
-        uint8_t *stripPtr = align_pointer(part->indices + part->numIndices, 8);
-        for(int s=0; s<4; ++s) {
-          if(part->numStripIndices[s] == 0)break;
-          t3d_indexbuffer_convert((int16_t*)stripPtr, part->numStripIndices[s]);
-          stripPtr = (uint8_t*)align_pointer(stripPtr + part->numStripIndices[s]*2, 8);
-        }
+      uint8_t *stripPtr = align_pointer(part->indices + part->numIndices, 8);
+      for(int s=0; s<4; ++s) {
+        if(part->numStripIndices[s] == 0)break;
+        t3d_indexbuffer_convert((int16_t*)stripPtr, part->numStripIndices[s]);
+        stripPtr = (uint8_t*)align_pointer(stripPtr + part->numStripIndices[s]*2, 8);
       }
     }
+  }
 
-    if(chunkType == T3D_CHUNK_TYPE_MATERIAL) {
-      T3DMaterial *mat = (T3DMaterial*)((char*)model + offset);
+  if(chunkType == T3D_CHUNK_TYPE_MATERIAL) {
+    T3DMaterial *mat = (T3DMaterial*)((char*)model + offset);
 
-      if(mat->name)mat->name += (uint32_t)model->stringTablePtr;
-      if(mat->textureA.texPath)mat->textureA.texPath += (uint32_t)model->stringTablePtr;
-      if(mat->textureB.texPath)mat->textureB.texPath += (uint32_t)model->stringTablePtr;
-    }
+    if(mat->name)mat->name += (uint32_t)model->stringTablePtr;
+    if(mat->textureA.texPath)mat->textureA.texPath += (uint32_t)model->stringTablePtr;
+    if(mat->textureB.texPath)mat->textureB.texPath += (uint32_t)model->stringTablePtr;
+  }
 
-    if(chunkType == T3D_CHUNK_TYPE_SKELETON) {
-      T3DChunkSkeleton *skel = (T3DChunkSkeleton*)((char*)model + offset);
-      for(int j = 0; j < skel->boneCount; j++) {
-        T3DChunkBone *bone = &skel->bones[j];
-        bone->name = patch_pointer(bone->name, (uint32_t)model->stringTablePtr);
-      }
+  if(chunkType == T3D_CHUNK_TYPE_SKELETON) {
+    T3DChunkSkeleton *skel = (T3DChunkSkeleton*)((char*)model + offset);
+    for(int j = 0; j < skel->boneCount; j++) {
+      T3DChunkBone *bone = &skel->bones[j];
+      bone->name = patch_pointer(bone->name, (uint32_t)model->stringTablePtr);
     }
+  }
 
-    if(chunkType == T3D_CHUNK_TYPE_ANIM) {
-      T3DChunkAnim *anim = (T3DChunkAnim*)((char*)model + offset);
-      anim->name = patch_pointer(anim->name, (uint32_t)model->stringTablePtr);
-      anim->filePath = patch_pointer(anim->filePath, (uint32_t)model->stringTablePtr);
-    }
-
-    if(chunkType == T3D_CHUNK_TYPE_BVH) {
-      // node leafs are stored as indices to the objects, we convert that to an relative address
-      // to the actual object, shifted by 2 since it's 4 byte aligned (and nodes use 16bit indices)
-      T3DBvh *bvh = (T3DBvh*)((char*)model + offset);
-      T3DBvhData *data = (T3DBvhData*)&bvh->nodes[bvh->nodeCount]; // data is right after nodes
-
-      for(int d=0; d<bvh->dataCount; ++d) {
-        T3DObject *obj = t3d_model_get_object_by_index(model, data[d].objectPtr);
-        uint32_t addr = (uint32_t)bvh  - (uint32_t)obj;
-        assert((addr & 0b11) == 0);
-        addr >>= 2;
-        assert(addr < 0x10000);
-        data[d].objectPtr = addr;
-      }
+  if(chunkType == T3D_CHUNK_TYPE_ANIM) {
+    T3DChunkAnim *anim = (T3DChunkAnim*)((char*)model + offset);
+    anim->name = patch_pointer(anim->name, (uint32_t)model->stringTablePtr);
+    anim->filePath = patch_pointer(anim->filePath, (uint32_t)model->stringTablePtr);
+  }
+
+  if(chunkType == T3D_CHUNK_TYPE_BVH) {
+    // node leafs are stored as indices to the objects, we convert that to an relative address
+    // to the actual object, shifted by 2 since it's 4 byte aligned (and nodes use 16bit indices)
+    T3DBvh *bvh = (T3DBvh*)((char*)model + offset);
+    T3DBvhData *data = (T3DBvhData*)&bvh->nodes[bvh->nodeCount]; // data is right after nodes
+
+    for(int d=0; d<bvh->dataCount; ++d) {
+      T3DObject *obj = t3d_model_get_object_by_index(model, data[d].objectPtr);
+      uint32_t addr = (uint32_t)bvh  - (uint32_t)obj;
+      assert((addr & 0b11) == 0);
+      addr >>= 2;
+      assert(addr < 0x10000);
+      data[d].objectPtr = addr;
     }
   }
+}
+
+T3DModel *t3d_model_load(const char *path) {
+  int size = 0;
+  T3DModel* model = asset_load(path, &size);
+  model_check_header(model, path);
+
+  model->stringTablePtr = patch_pointer(model->stringTablePtr, (uint32_t)model);
+  for(uint32_t i = 0; i < model->chunkCount; i++) {
+    model_patch_chunk(model, i);
+  }
 
   data_cache_hit_writeback_invalidate(model, size);
   return model;
 }
 
+void t3d_model_load_async_begin(T3DModelLoader *loader, const char *path) {
+  int size = 0;
+  *loader = (T3DModelLoader){0};
+  loader->file = asset_fopen(path, &size);
+  assertf(loader->file, "Failed to open T3D model file: %s", path);
+
+  loader->path = path;
+  loader->size = size;
+  loader->model = memalign(16, size);
+}
+
+T3DModel* t3d_model_load_async_step(T3DModelLoader *loader, uint32_t maxBytes, uint32_t maxChunks) {
+  T3DModel *model = loader->model;
+  if(loader->bytesRead < loader->size) {
+    uint32_t readSize = loader->size - loader->bytesRead;
+    if(readSize > maxBytes)readSize = maxBytes;
+
+    fread((char*)model + loader->bytesRead, 1, readSize, loader->file);
+    loader->bytesRead += readSize;
+    if(loader->bytesRead < loader->size)return NULL;
+
+    fclose(loader->file);
+    loader->file = NULL;
+    model_check_header(model, loader->path);
+    model->stringTablePtr = patch_pointer(model->stringTablePtr, (uint32_t)model);
+    return NULL;
+  }
+
+  uint32_t chunkEnd = loader->chunkIdx + maxChunks;
+  if(chunkEnd > model->chunkCount)chunkEnd = model->chunkCount;
+  for(; loader->chunkIdx < chunkEnd; ++loader->chunkIdx) {
+    model_patch_chunk(model, loader->chunkIdx);
+  }
+  if(loader->chunkIdx < model->chunkCount)return NULL;
+
+  data_cache_hit_writeback_invalidate(model, loader->size);
+  loader->model = NULL;
+  return model;
+}
+
+void t3d_model_load_async_cancel(T3DModelLoader *loader) {
+  if(loader->file)fclose(loader->file);
+  free(loader->model);
+  *loader = (T3DModelLoader){0};
+}
+
 void t3d_model_draw_custom(const T3DModel* model, T3DModelDrawConf conf)
 {
   T3DModelState state = t3d_model_state_create();
@@ -283,7 +342,7 @@ void t3d_model_draw_custom(const T3DModel* model, T3DModelDrawConf conf)
       continue;
     }
 
-    if(it.object->material) {
+    if(it.object->material && !conf.skipMaterials) {
       t3d_model_draw_material(it.object->material, &state);
     }
     t3d_model_draw_object(it.object, conf.matrices);
@@ -465,10 +524,180 @@ void t3d_model_free(T3DModel *model) {
       if(obj->userBlock)rspq_block_free(obj->userBlock);
     }
   }
+  t3d_model_cache_invalidate(model);
   free(model);
   if(txtErased) texture_cache_free_mem();
 }
 
+static void draw_cache_entry_free(T3DDrawCacheEntry *entry) {
+  if(entry->block)rspq_block_free(entry->block);
+  if(entry->objBlocks) {
+    for(uint32_t i = 0; i < entry->objCount*2; i++) {
+      if(entry->objBlocks[i])rspq_block_free(entry->objBlocks[i]);
+    }
+    free(entry->objBlocks);
+  }
+  *entry = (T3DDrawCacheEntry){0};
+}
+
+static T3DDrawCacheEntry* draw_cache_get(const T3DModel *model, const T3DModelDrawConf *conf) {
+  T3DDrawCacheEntry *freeEntry = NULL;
+  for(uint32_t i = 0; i < drawCacheSize; i++) {
+    T3DDrawCacheEntry *entry = &drawCache[i];
+    if(entry->model == NULL) {
+      if(!freeEntry)freeEntry = entry;
+      continue;
+    }
+    if(entry->model == model
+      && entry->conf.userData == conf->userData
+      && entry->conf.tileCb == conf->tileCb
+      && entry->conf.dynTextureCb == conf->dynTextureCb
+      && entry->conf.matrices == conf->matrices
+      && entry->conf.skipMaterials == conf->skipMaterials
+    ) {
+      return entry;
+    }
+  }
+
+  if(freeEntry == NULL) {
+    drawCacheSize++;
+    drawCache = realloc(drawCache, sizeof(T3DDrawCacheEntry) * drawCacheSize);
+    freeEntry = &drawCache[drawCacheSize-1];
+  }
+
+  *freeEntry = (T3DDrawCacheEntry){0};
+  freeEntry->model = model;
+  freeEntry->conf = *conf;
+  freeEntry->conf.filterCb = NULL;
+  return freeEntry;
+}
+
+// Records a material so that every setting is applied, independent of what was drawn before
+static rspq_block_t* draw_cache_record_material(T3DMaterial *mat, T3DModelDrawConf *conf) {
+  T3DModelState state = t3d_model_state_create();
+  state.drawConf = conf;
+  state.lastVertFXFunc = 0xFF;
+  state.lastRenderFlags = ~mat->renderFlags;
+  state.lastPrimColor = color_from_packed32(~color_to_packed32(mat->primColor));
+  state.lastEnvColor = color_from_packed32(~color_to_packed32(mat->envColor));
+  state.lastBlendColor = color_from_packed32(~color_to_packed32(mat->blendColor));
+
+  rspq_block_begin();
+    t3d_model_draw_material(mat, &state);
+  return rspq_block_end();
+}
+
+static rspq_block_t* draw_cache_record_model(const T3DModel *model, const T3DModelDrawConf *conf) {
+  rspq_block_begin();
+    t3d_model_draw_custom(model, *conf);
+  return rspq_block_end();
+}
+
+static rspq_block_t* draw_cache_record_object(const T3DObject *object, const T3DModelDrawConf *conf) {
+  rspq_block_begin();
+    t3d_model_draw_object(object, conf->matrices);
+  return rspq_block_end();
+}
+
+static void draw_cache_alloc_objects(const T3DModel *model, T3DDrawCacheEntry *entry) {
+  if(entry->objBlocks)return;
+  T3DModelIter it = t3d_model_iter_create(model, T3D_CHUNK_TYPE_OBJECT);
+  while(t3d_model_iter_next(&it))entry->objCount++;
+  entry->objBlocks = calloc(entry->objCount * 2, sizeof(rspq_block_t*));
+}
+
+void t3d_model_draw_cached(const T3DModel* model, T3DModelDrawConf conf)
+{
+  T3DDrawCacheEntry *entry = draw_cache_get(model, &conf);
+
+  if(!conf.filterCb) {
+    if(!entry->block)entry->block = draw_cache_record_model(model, &entry->conf);
+    rspq_block_run(entry->block);
+    return;
+  }
+
+  draw_cache_alloc_objects(model, entry);
+
+  // objects are grouped into runs with the same material, only the first visible one applies it
+  const T3DMaterial *runMat = NULL;
+  uint32_t runIdx = 0;
+  bool runApplied = false;
+  uint8_t lastVertFXFunc = T3D_VERTEX_FX_NONE;
+
+  uint32_t objIdx = 0;
+  T3DModelIter it = t3d_model_iter_create(model, T3D_CHUNK_TYPE_OBJECT);
+  for(; t3d_model_iter_next(&it); ++objIdx)
+  {
+    if(objIdx == 0 || it.object->material != runMat) {
+      runMat = it.object->material;
+      runIdx = objIdx;
+      runApplied = false;
+    }
+
+    if(!conf.filterCb(conf.userData, it.object))continue;
+
+    if(!runApplied && it.object->material && !conf.skipMaterials) {
+      rspq_block_t **matBlock = &entry->objBlocks[runIdx*2];
+      if(!*matBlock)*matBlock = draw_cache_record_material(it.object->material, &entry->conf);
+      rspq_block_run(*matBlock);
+      lastVertFXFunc = it.object->material->vertexFxFunc;
+      runApplied = true;
+    }
+
+    rspq_block_t **meshBlock = &entry->objBlocks[objIdx*2 + 1];
+    if(!*meshBlock)*meshBlock = draw_cache_record_object(it.object, &entry->conf);
+    rspq_block_run(*meshBlock);
+  }
+
+  if(lastVertFXFunc != T3D_VERTEX_FX_NONE)t3d_state_set_vertex_fx(T3D_VERTEX_FX_NONE, 0, 0);
+}
+
+void t3d_model_cache_record(const T3DModel* model, T3DModelDrawConf conf)
+{
+  T3DDrawCacheEntry *entry = draw_cache_get(model, &conf);
+
+  if(!conf.filterCb) {
+    if(!entry->block)entry->block = draw_cache_record_model(model, &entry->conf);
+    return;
+  }
+
+  // same layout as in 't3d_model_draw_cached'
+  draw_cache_alloc_objects(model, entry);
+  const T3DMaterial *runMat = NULL;
+  uint32_t runIdx = 0;
+  uint32_t objIdx = 0;
+  T3DModelIter it = t3d_model_iter_create(model, T3D_CHUNK_TYPE_OBJECT);
+  for(; t3d_model_iter_next(&it); ++objIdx)
+  {
+    if(objIdx == 0 || it.object->material != runMat) {
+      runMat = it.object->material;
+      runIdx = objIdx;
+    }
+
+    if(!conf.filterCb(conf.userData, it.object))continue;
+
+    rspq_block_t **matBlock = &entry->objBlocks[runIdx*2];
+    if(runMat && !conf.skipMaterials && !*matBlock)*matBlock = draw_cache_record_material(it.object->material, &entry->conf);
+
+    rspq_block_t **meshBlock = &entry->objBlocks[objIdx*2 + 1];
+    if(!*meshBlock)*meshBlock = draw_cache_record_object(it.object, &entry->conf);
+  }
+}
+
+void t3d_model_cache_invalidate(const T3DModel* model) {
+  bool isEmpty = true;
+  for(uint32_t i = 0; i < drawCacheSize; i++) {
+    if(drawCache[i].model == model)draw_cache_entry_free(&drawCache[i]);
+    if(drawCache[i].model)isEmpty = false;
+  }
+
+  if(drawCache && isEmpty) {
+    free(drawCache);
+    drawCache = NULL;
+    drawCacheSize = 0;
+  }
+}
+
 T3DChunkAnim *t3d_model_get_animation(const T3DModel *model, const char *name) {
   for(uint32_t i = 0; i < model->chunkCount; i++) {
     if(model->chunkOffsets[i].type == T3D_CHUNK_TYPE_ANIM) {
@@ -524,37 +753,3 @@ bool t3d_model_iter_next(T3DModelIter *iter) {
   iter->chunk = NULL;
   return false;
 }
-
-// context for functions below, this avoids blowing up the stack-sie
-static const T3DFrustum *ctxFrustum;
-static const T3DBvhData *ctxData;
-static uint32_t ctxBasePtr;
-
-static void bvh_query_node(const T3DBvhNode *node) {
-  int dataCount = node->value & 0b1111;
-  int offset = (int16_t)node->value >> 4;
-
-  if(dataCount == 0) {
-    if(t3d_frustum_vs_aabb_s16(ctxFrustum, node->aabbMin, node->aabbMax)) {
-      bvh_query_node(&node[offset]);
-      bvh_query_node(&node[offset + 1]);
-    }
-    return;
-  }
-
-  int offsetEnd = offset + dataCount;
-  while(offset < offsetEnd) {
-    T3DObject* obj = (T3DObject*)(ctxBasePtr - (ctxData[offset++].objectPtr << 2));
-    if(t3d_frustum_vs_aabb_s16(ctxFrustum, obj->aabbMin, obj->aabbMax)) {
-      obj->isVisible = true;
-    }
-  }
-}
-
-void t3d_model_bvh_query_frustum(const T3DBvh *bvh, const T3DFrustum *frustum) {
-  const T3DBvhData *data = (T3DBvhData*)&bvh->nodes[bvh->nodeCount]; // data starts right after nodes
-  ctxFrustum = frustum;
-  ctxData = data;
-  ctxBasePtr = (uint32_t)(char*)bvh;
-  bvh_query_node(bvh->nodes);
-}
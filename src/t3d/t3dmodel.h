@@ -105,9 +105,40 @@ typedef struct {
   uint16_t nodeCount;
   uint16_t dataCount;
   T3DBvhNode nodes[];
-  // uint16_t data[]; // T3DObject pointer, shifted by 3, relative to 'objectBasePtr'
+  // T3DBvhData data[]; // follows the nodes
 } T3DBvh;
 
+typedef struct {
+  uint16_t objectPtr; // T3DObject pointer, shifted by 2, relative to (and before) the BVH
+} T3DBvhData;
+
+#define T3D_PORTAL_MAX_POINTS 4
+
+typedef struct {
+  int16_t aabbMin[3];
+  int16_t aabbMax[3];
+  uint16_t portalIdx; // first portal leading out of this cell
+  uint16_t portalCount;
+  uint16_t objIdx; // first entry in the object index list
+  uint16_t objCount;
+} T3DCell;
+
+typedef struct {
+  uint16_t targetCell;
+  uint16_t pointCount;
+  int16_t points[T3D_PORTAL_MAX_POINTS][3]; // convex polygon, in model space
+} T3DPortal;
+
+typedef struct {
+  uint16_t cellCount;
+  uint16_t portalCount;
+  uint16_t globalObjIdx; // objects outside of all cells, always visible
+  uint16_t globalObjCount;
+  T3DCell cells[];
+  // T3DPortal portals[]; // follows the cells
+  // uint16_t objects[]; // object indices, follows the portals
+} T3DPortalData;
+
 typedef struct {
   char* name;
   uint16_t parentIdx;
@@ -142,7 +173,11 @@ typedef struct {
 } T3DChunkAnim;
 
 typedef union {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  struct { char _padding[3]; char type; }; // only for host builds (tests/tools), the type is the top byte
+#else
   char type;
+#endif
   uint32_t offset;
 } T3DChunkOffset;
 
@@ -189,7 +224,8 @@ enum T3DModelChunkType {
   T3D_CHUNK_TYPE_OBJECT   = 'O',
   T3D_CHUNK_TYPE_SKELETON = 'S',
   T3D_CHUNK_TYPE_ANIM     = 'A',
-  T3D_CHUNK_TYPE_BVH      = 'B'
+  T3D_CHUNK_TYPE_BVH      = 'B',
+  T3D_CHUNK_TYPE_PORTAL   = 'P'
 };
 
 /**
@@ -201,6 +237,52 @@ enum T3DModelChunkType {
  */
 T3DModel* t3d_model_load(const char *path);
 
+// State of a model that is loaded over multiple calls, see 't3d_model_load_async_begin'
+typedef struct {
+  FILE *file;
+  T3DModel *model;
+  uint32_t size;
+  uint32_t bytesRead;
+  uint32_t chunkIdx; // next chunk to patch after the file was read
+  const char *path;
+} T3DModelLoader;
+
+/**
+ * Starts loading a model in small steps, to spread out the work over multiple frames.
+ * Only the file is opened here, call 't3d_model_load_async_step' until it returns the model.
+ *
+ * @param loader state to initialize, must be kept alive until loading is done
+ * @param path FS path, must be kept alive until loading is done
+ */
+void t3d_model_load_async_begin(T3DModelLoader *loader, const char *path);
+
+/**
+ * Continues loading a model, each call either reads up to 'maxBytes' of the file,
+ * or patches up to 'maxChunks' chunks once all data is in memory.
+ * The result is the same as with 't3d_model_load'.
+ *
+ * @param loader state from 't3d_model_load_async_begin'
+ * @param maxBytes max. bytes to read in this step
+ * @param maxChunks max. chunks to patch in this step
+ * @return pointer to the model (that you now own) once done, NULL otherwise
+ */
+T3DModel* t3d_model_load_async_step(T3DModelLoader *loader, uint32_t maxBytes, uint32_t maxChunks);
+
+/**
+ * Returns true once all data of an async. model load was read, and only patching is left.
+ * @param loader state from 't3d_model_load_async_begin'
+ */
+static inline bool t3d_model_load_async_read_done(const T3DModelLoader *loader) {
+  return loader->bytesRead == loader->size;
+}
+
+/**
+ * Stops an async. model load, freeing the file handle and the partially loaded model.
+ * Safe to call on a finished (or zero-initialized) loader.
+ * @param loader state from 't3d_model_load_async_begin'
+ */
+void t3d_model_load_async_cancel(T3DModelLoader *loader);
+
 // callback for custom drawing, this hooks into the tile-setting section
 typedef void (*T3DModelTileCb)(void* userData, rdpq_texparms_t *tileParams, rdpq_tile_t tile);
 typedef bool (*T3DModelFilterCb)(void* userData, const T3DObject *obj);
@@ -215,6 +297,7 @@ typedef struct {
   T3DModelFilterCb filterCb; // callback to filter parts
   T3DModelDynTextureCb dynTextureCb; // callback to set dynamic textures, aka "Texture Reference" in fast64
   const T3DMat4FP *matrices;
+  bool skipMaterials; // only draw meshes, materials are applied by the caller (e.g. ones with a scrolling texture)
 } T3DModelDrawConf;
 
 /**
@@ -278,6 +361,40 @@ static inline void t3d_model_draw(const T3DModel* model) {
   });
 }
 
+/**
+ * Draws a model like 't3d_model_draw_custom', but records the commands into blocks on first use,
+ * or upfront via 't3d_model_cache_record'.\n
+ * Blocks are kept per model and config ('filterCb' is evaluated each call and not part of it),
+ * Without a filter the whole model is a single block, otherwise each material-run and object gets one.\n
+ * Materials are recorded as they are on first use, after changing one call 't3d_model_cache_invalidate'.
+ * Materials that change every frame should be applied by hand instead, together with 'skipMaterials'.\n
+ * All blocks are freed in 't3d_model_free'.\n
+ * NOTE: this can't be called while recording a block itself, use 't3d_model_draw_custom' there.
+ *
+ * @param model model to draw
+ * @param conf custom configuration
+ */
+void t3d_model_draw_cached(const T3DModel* model, T3DModelDrawConf conf);
+
+/**
+ * Records all blocks 't3d_model_draw_cached' would use with this config, without drawing anything.\n
+ * Use this after loading a model to keep the recording (and its allocations) out of the frame loop.\n
+ * With a filter, only the objects it accepts now are recorded, others are recorded once they are drawn.\n
+ * A filter that culls objects should therefore let all of them through while recording.
+ *
+ * @param model model to record
+ * @param conf same configuration as later passed to 't3d_model_draw_cached'
+ */
+void t3d_model_cache_record(const T3DModel* model, T3DModelDrawConf conf);
+
+/**
+ * Frees all blocks recorded by 't3d_model_draw_cached' for a model, they are recorded again on the next draw.\n
+ * Call this after changing a material of the model, or if the callbacks in the config
+ * now behave differently (e.g. a tile callback reading a changed value).
+ * @param model model to invalidate
+ */
+void t3d_model_cache_invalidate(const T3DModel* model);
+
 /**
  * Draws an object in a model directly.\n
  * This will only handle the mesh part, and not any material or texture settings.\n
@@ -462,6 +579,7 @@ static inline const T3DBvh* t3d_model_bvh_get(const T3DModel *model) {
  * Note that the BVH is in model space, so the frustum may need to be transformed before.
  * This will mark all objects in the BVH as visible via the 'isVisible' flag.
  * Note that you need to first set all to false before calling this.
+ * To not depend on the per-object flag, use 't3d_model_bvh_query_frustum_list' instead.
  *
  * @param bvh BVH to check
  * @param frustum frustum to check against
@@ -469,6 +587,55 @@ static inline const T3DBvh* t3d_model_bvh_get(const T3DModel *model) {
  */
 void t3d_model_bvh_query_frustum(const T3DBvh *bvh, const T3DFrustum *frustum);
 
+/**
+ * Queries the BVH of a model with a frustum, writing all visible objects into 'outObjects'.
+ * Objects are not modified, so multiple queries (e.g. one per camera) can run independently.
+ * Once a node is fully inside a plane, the plane is no longer checked for anything below it.
+ * Note that the BVH is in model space, so the frustum may need to be transformed before.
+ *
+ * @param bvh BVH to check
+ * @param frustum frustum to check against
+ * @param outObjects array for visible objects, in BVH order
+ * @param maxObjects size of 'outObjects', further objects are skipped
+ * @return number of objects written to 'outObjects'
+ */
+uint32_t t3d_model_bvh_query_frustum_list(
+  const T3DBvh *bvh, const T3DFrustum *frustum, T3DObject **outObjects, uint32_t maxObjects
+);
+
+/**
+ * Returns the portal/cell data of a model.
+ * Note that this is optional and may return NULL.
+ * To create it, add 'CELL_' and 'PORTAL_' objects in blender (see '--help' of the gltf importer).
+ * @param model model
+ * @return pointer to the portal data or NULL if not found
+ */
+static inline const T3DPortalData* t3d_model_portal_get(const T3DModel *model) {
+  for(uint32_t i = 0; i < model->chunkCount; i++) {
+    if(model->chunkOffsets[i].type == T3D_CHUNK_TYPE_PORTAL) {
+      uint32_t offset = model->chunkOffsets[i].offset & 0x00FFFFFF;
+      return (T3DPortalData*)((char*)model + offset);
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Marks objects seen through the portals of the cell the camera is in.
+ * Starting with the camera cell, each portal is clipped against the current frustum,
+ * the remaining polygon then narrows the frustum for the cell behind it.
+ * Objects of each reached cell are marked via the 'isVisible' flag if they pass the narrowed frustum.
+ * Objects outside of all cells are checked against the full frustum.
+ * Note that you need to first set all to false before calling this.
+ * Like the BVH, all data is in model space, so the frustum and camera may need to be transformed before.
+ *
+ * @param model model with portal data
+ * @param frustum view frustum, the far-plane is kept for every cell
+ * @param camPos camera position
+ * @return index of the camera cell, or -1 if the camera is outside all cells (nothing is marked then)
+ */
+int t3d_model_portal_query(const T3DModel *model, const T3DFrustum *frustum, const T3DVec3 *camPos);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,190 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+
+#include "t3dmodel.h"
+
+#define PORTAL_MAX_DEPTH 8
+#define PORTAL_MAX_PLANES 9 // edges of a clipped portal + far-plane
+#define PORTAL_MAX_CLIP_POINTS (T3D_PORTAL_MAX_POINTS + PORTAL_MAX_PLANES) // each clip adds at most one point
+#define PORTAL_PLANE_EPSILON 1.0f
+#define PORTAL_FAR_PLANE 5
+
+typedef struct {
+  const T3DModel *model;
+  const T3DPortalData *data;
+  const T3DPortal *portals;
+  const uint16_t *objects;
+  const T3DVec3 *camPos;
+  const T3DVec4 *farPlane;
+  uint16_t path[PORTAL_MAX_DEPTH];
+  T3DVec3 clipBuff[2][PORTAL_MAX_CLIP_POINTS]; // only used before recursing, so shared by all levels
+} T3DPortalCtx;
+
+static inline float plane_dist(const T3DVec4 *plane, const T3DVec3 *p) {
+  return plane->v[3] + plane->v[0] * p->v[0] + plane->v[1] * p->v[1] + plane->v[2] * p->v[2];
+}
+
+static bool aabb_vs_planes(const T3DVec4 *planes, uint32_t planeCount, const int16_t *aabbMin, const int16_t *aabbMax)
+{
+  for(uint32_t i=0; i<planeCount; ++i) {
+    const T3DVec4 *plane = &planes[i];
+    // corner furthest along the normal, if that one is outside, the whole box is
+    T3DVec3 corner = {{
+      plane->v[0] >= 0.0f ? aabbMax[0] : aabbMin[0],
+      plane->v[1] >= 0.0f ? aabbMax[1] : aabbMin[1],
+      plane->v[2] >= 0.0f ? aabbMax[2] : aabbMin[2],
+    }};
+    if(plane_dist(plane, &corner) <= 0.0f)return false;
+  }
+  return true;
+}
+
+static void mark_objects(
+  const T3DPortalCtx *ctx, uint32_t objIdx, uint32_t objCount, const T3DVec4 *planes, uint32_t planeCount
+) {
+  const uint16_t *objects = &ctx->objects[objIdx];
+  for(uint32_t i=0; i<objCount; ++i) {
+    T3DObject *obj = t3d_model_get_object_by_index(ctx->model, objects[i]);
+    if(!obj->isVisible && aabb_vs_planes(planes, planeCount, obj->aabbMin, obj->aabbMax)) {
+      obj->isVisible = true;
+    }
+  }
+}
+
+// Sutherland-Hodgman against a single plane, returns the new point count
+static uint32_t clip_polygon(const T3DVec3 *points, uint32_t count, const T3DVec4 *plane, T3DVec3 *out)
+{
+  uint32_t outCount = 0;
+  for(uint32_t i=0; i<count; ++i) {
+    const T3DVec3 *a = &points[i];
+    const T3DVec3 *b = &points[i+1 == count ? 0 : i+1];
+    float distA = plane_dist(plane, a);
+    float distB = plane_dist(plane, b);
+
+    if(distA >= 0.0f)out[outCount++] = *a;
+    if((distA >= 0.0f) != (distB >= 0.0f)) {
+      t3d_vec3_lerp(&out[outCount++], a, b, distA / (distA - distB));
+    }
+  }
+  return outCount;
+}
+
+/**
+ * Creates planes through the camera and each edge of 'points', facing inwards.
+ * Returns the plane count, degenerate edges (e.g. from clipping) are skipped.
+ */
+static uint32_t planes_from_polygon(const T3DVec3 *camPos, const T3DVec3 *points, uint32_t count, T3DVec4 *planes)
+{
+  T3DVec3 center = {{0, 0, 0}};
+  for(uint32_t i=0; i<count; ++i)t3d_vec3_add(&center, &center, &points[i]);
+  t3d_vec3_scale(&center, &center, 1.0f / count);
+
+  uint32_t planeCount = 0;
+  for(uint32_t i=0; i<count; ++i) {
+    T3DVec3 dirA, dirB, normal;
+    t3d_vec3_diff(&dirA, &points[i], camPos);
+    t3d_vec3_diff(&dirB, &points[i+1 == count ? 0 : i+1], camPos);
+    t3d_vec3_cross(&normal, &dirA, &dirB);
+    if(t3d_vec3_len2(&normal) < 0.0001f)continue;
+
+    T3DVec4 *plane = &planes[planeCount++];
+    *plane = (T3DVec4){{normal.v[0], normal.v[1], normal.v[2], -t3d_vec3_dot(&normal, camPos)}};
+    if(plane_dist(plane, &center) < 0.0f) {
+      for(int a=0; a<4; ++a)plane->v[a] = -plane->v[a];
+    }
+  }
+  return planeCount;
+}
+
+static void visit_cell(
+  T3DPortalCtx *ctx, uint32_t cellIdx, const T3DVec4 *planes, uint32_t planeCount, uint32_t depth
+) {
+  const T3DCell *cell = &ctx->data->cells[cellIdx];
+  mark_objects(ctx, cell->objIdx, cell->objCount, planes, planeCount);
+
+  if(depth == PORTAL_MAX_DEPTH)return;
+  ctx->path[depth] = cellIdx;
+
+  for(uint32_t p=0; p<cell->portalCount; ++p) {
+    const T3DPortal *portal = &ctx->portals[cell->portalIdx + p];
+
+    // don't walk back into a cell we came through
+    bool onPath = false;
+    for(uint32_t d=0; d<=depth; ++d)onPath |= ctx->path[d] == portal->targetCell;
+    if(onPath)continue;
+
+    T3DVec3 *points = ctx->clipBuff[0];
+    uint32_t pointCount = portal->pointCount;
+    for(uint32_t i=0; i<pointCount; ++i) {
+      points[i] = (T3DVec3){{portal->points[i][0], portal->points[i][1], portal->points[i][2]}};
+    }
+
+    // standing in the opening, the portal can't narrow anything down
+    T3DVec3 edgeA, edgeB, normal, camDir;
+    t3d_vec3_diff(&edgeA, &points[1], &points[0]);
+    t3d_vec3_diff(&edgeB, &points[2], &points[0]);
+    t3d_vec3_cross(&normal, &edgeA, &edgeB);
+    t3d_vec3_diff(&camDir, ctx->camPos, &points[0]);
+    float camDist = t3d_vec3_dot(&normal, &camDir);
+    if(camDist * camDist < PORTAL_PLANE_EPSILON * PORTAL_PLANE_EPSILON * t3d_vec3_len2(&normal)) {
+      visit_cell(ctx, portal->targetCell, planes, planeCount, depth + 1);
+      continue;
+    }
+
+    for(uint32_t i=0; i<planeCount && pointCount >= 3; ++i) {
+      T3DVec3 *out = points == ctx->clipBuff[0] ? ctx->clipBuff[1] : ctx->clipBuff[0];
+      pointCount = clip_polygon(points, pointCount, &planes[i], out);
+      points = out;
+    }
+    if(pointCount < 3)continue;
+
+    // too many corners after clipping, use the (wider) unclipped portal instead
+    if(pointCount >= PORTAL_MAX_PLANES) {
+      points = ctx->clipBuff[0];
+      pointCount = portal->pointCount;
+      for(uint32_t i=0; i<pointCount; ++i) {
+        points[i] = (T3DVec3){{portal->points[i][0], portal->points[i][1], portal->points[i][2]}};
+      }
+    }
+
+    T3DVec4 portalPlanes[PORTAL_MAX_PLANES];
+    uint32_t portalPlaneCount = planes_from_polygon(ctx->camPos, points, pointCount, portalPlanes);
+    portalPlanes[portalPlaneCount++] = *ctx->farPlane;
+    visit_cell(ctx, portal->targetCell, portalPlanes, portalPlaneCount, depth + 1);
+  }
+}
+
+int t3d_model_portal_query(const T3DModel *model, const T3DFrustum *frustum, const T3DVec3 *camPos)
+{
+  const T3DPortalData *data = t3d_model_portal_get(model);
+  assertf(data, "Model has no portal data");
+
+  int camCell = -1;
+  for(uint32_t c=0; c<data->cellCount; ++c) {
+    const T3DCell *cell = &data->cells[c];
+    if(camPos->v[0] >= cell->aabbMin[0] && camPos->v[0] <= cell->aabbMax[0] &&
+       camPos->v[1] >= cell->aabbMin[1] && camPos->v[1] <= cell->aabbMax[1] &&
+       camPos->v[2] >= cell->aabbMin[2] && camPos->v[2] <= cell->aabbMax[2]
+    ) {
+      camCell = c;
+      break;
+    }
+  }
+  if(camCell < 0)return -1;
+
+  const T3DPortal *portals = (const T3DPortal*)&data->cells[data->cellCount];
+  T3DPortalCtx ctx = {
+    .model = model,
+    .data = data,
+    .portals = portals,
+    .objects = (const uint16_t*)&portals[data->portalCount],
+    .camPos = camPos,
+    .farPlane = &frustum->planes[PORTAL_FAR_PLANE],
+  };
+
+  mark_objects(&ctx, data->globalObjIdx, data->globalObjCount, frustum->planes, 6);
+  visit_cell(&ctx, camCell, frustum->planes, 6, 0);
+  return camCell;
+}
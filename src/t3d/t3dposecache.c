@@ -0,0 +1,140 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#include "t3dposecache.h"
+
+#define POSE_CACHE_DEF_MAX_POSES 16
+#define POSE_CACHE_DEF_TIME_STEP (1.0f / 30.0f)
+#define POSE_CACHE_DEF_BUFFERS 3
+
+T3DPoseCache t3d_pose_cache_create(const T3DModel *model, const T3DPoseCacheConf *conf) {
+  assertf(t3d_model_get_skeleton(model), "Pose cache needs a model with a skeleton");
+
+  T3DPoseCache cache = {
+    .model = model,
+    .conf = conf ? *conf : (T3DPoseCacheConf){},
+    .frame = 1, // unused poses are at frame 0
+  };
+  if(cache.conf.maxPoses == 0)cache.conf.maxPoses = POSE_CACHE_DEF_MAX_POSES;
+  if(cache.conf.timeStep <= 0.0f)cache.conf.timeStep = POSE_CACHE_DEF_TIME_STEP;
+  if(cache.conf.bufferCount <= 0)cache.conf.bufferCount = POSE_CACHE_DEF_BUFFERS;
+
+  cache.poses = calloc(cache.conf.maxPoses, sizeof(T3DPose));
+  return cache;
+}
+
+void t3d_pose_cache_begin_frame(T3DPoseCache *cache) {
+  ++cache->frame;
+  cache->evalCount = 0;
+  cache->hitCount = 0;
+}
+
+static inline const T3DMat4FP* pose_get_matrices(const T3DPose *pose) {
+  return pose->skel.boneMatricesFP + pose->skel.currentBufferIdx * pose->skel.skeletonRef->boneCount;
+}
+
+static void pose_init(const T3DPoseCache *cache, T3DPose *pose, const T3DChunkAnim *anim) {
+  if(pose->animRef) {
+    // bones not animated by the new clip would otherwise keep the old pose.
+    // The reset marks all bones as changed, so 't3d_skeleton_update' rewrites them into every buffer.
+    t3d_anim_destroy(&pose->anim);
+    t3d_skeleton_reset(&pose->skel);
+  } else {
+    pose->skel = t3d_skeleton_create_buffered(cache->model, cache->conf.bufferCount);
+  }
+
+  pose->anim = t3d_anim_create(cache->model, anim->name);
+  t3d_anim_attach(&pose->anim, &pose->skel);
+  pose->animRef = anim;
+  pose->timeIdx = 0;
+}
+
+const T3DMat4FP* t3d_pose_cache_get(T3DPoseCache *cache, const T3DChunkAnim *anim, float time) {
+  float step = cache->conf.timeStep;
+  uint32_t stepCount = (uint32_t)ceilf(anim->duration / step);
+  if(stepCount == 0)stepCount = 1;
+
+  time = fmodf(time, anim->duration);
+  if(time < 0.0f)time += anim->duration;
+  uint32_t timeIdx = (uint32_t)(time / step);
+  if(timeIdx >= stepCount)timeIdx = stepCount - 1;
+
+  T3DPose *best = NULL; // unused pose of this clip with the shortest way forward to 'timeIdx'
+  uint32_t bestDist = UINT32_MAX;
+  T3DPose *fallback = NULL; // pose of this clip already used this frame, closest in time
+  uint32_t fallbackDist = UINT32_MAX;
+  T3DPose *freePose = NULL;
+  T3DPose *oldestPose = NULL; // pose of another clip, least recently used
+
+  for(uint32_t i=0; i<cache->conf.maxPoses; ++i) {
+    T3DPose *pose = &cache->poses[i];
+    if(!pose->animRef) {
+      if(!freePose)freePose = pose;
+      continue;
+    }
+
+    if(pose->animRef != anim) {
+      if(pose->usedFrame != cache->frame && (!oldestPose || pose->usedFrame < oldestPose->usedFrame)) {
+        oldestPose = pose;
+      }
+      continue;
+    }
+
+    if(pose->timeIdx == timeIdx) {
+      if(pose->usedFrame == cache->frame)++cache->hitCount;
+      pose->usedFrame = cache->frame;
+      return pose_get_matrices(pose);
+    }
+
+    uint32_t dist = (timeIdx + stepCount - pose->timeIdx) % stepCount;
+    if(pose->usedFrame == cache->frame) {
+      uint32_t distAbs = dist < (stepCount - dist) ? dist : (stepCount - dist);
+      if(distAbs < fallbackDist) {
+        fallback = pose;
+        fallbackDist = distAbs;
+      }
+    } else if(dist < bestDist) {
+      best = pose;
+      bestDist = dist;
+    }
+  }
+
+  // a new pose has to read the clip from the start, so only use it if that's less work
+  if(freePose && (!best || timeIdx < bestDist)) {
+    pose_init(cache, freePose, anim);
+    best = freePose;
+  } else if(!best && oldestPose) {
+    pose_init(cache, oldestPose, anim);
+    best = oldestPose;
+  }
+
+  if(!best) {
+    assertf(fallback, "Pose cache is full, increase 'maxPoses' (%lu)", cache->conf.maxPoses);
+    ++cache->hitCount;
+    return pose_get_matrices(fallback);
+  }
+
+  // always forward, wrapping around at the end is handled by the animation itself
+  float timeDiff = (float)timeIdx * step - best->anim.time;
+  if(timeDiff < 0.0f)timeDiff += anim->duration;
+  t3d_anim_update(&best->anim, timeDiff);
+  t3d_skeleton_update(&best->skel);
+
+  best->timeIdx = timeIdx;
+  best->usedFrame = cache->frame;
+  ++cache->evalCount;
+  return pose_get_matrices(best);
+}
+
+void t3d_pose_cache_destroy(T3DPoseCache *cache) {
+  if(!cache->poses)return;
+  for(uint32_t i=0; i<cache->conf.maxPoses; ++i) {
+    T3DPose *pose = &cache->poses[i];
+    if(!pose->animRef)continue;
+    t3d_anim_destroy(&pose->anim);
+    t3d_skeleton_destroy(&pose->skel);
+  }
+  free(cache->poses);
+  cache->poses = NULL;
+}
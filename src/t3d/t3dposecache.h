@@ -0,0 +1,101 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#ifndef TINY3D_T3DPOSECACHE_H
+#define TINY3D_T3DPOSECACHE_H
+
+#include "t3danim.h"
+#include "t3dskeleton.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Evaluated pose of one animation at one (quantized) time.
+ * Each pose owns an animation instance and a skeleton, the skeleton's matrices are what gets shared.
+ */
+typedef struct {
+  const T3DChunkAnim *animRef; // NULL if unused
+  T3DAnim anim;
+  T3DSkeleton skel;
+  uint32_t timeIdx; // quantized time of the current pose, in steps
+  uint32_t usedFrame; // last frame the pose was requested in, it can't change anymore in that frame
+} T3DPose;
+
+typedef struct {
+  uint32_t maxPoses; // max. number of distinct poses per frame, default: 16
+  float timeStep; // quantization of the time in seconds, default: 1/30
+  int bufferCount; // matrix buffers per pose, should match the frame-buffer count, default: 3
+} T3DPoseCacheConf;
+
+/**
+ * Shares evaluated animation poses between skeletons of the same model.
+ * Models that play the same animation at the same (quantized) time will use the same bone matrices,
+ * so the cost of a crowd scales with the number of distinct clips/times instead of the number of instances.
+ * Poses only ever move forward in time (wrapping around at the end), so a pose of the last frame
+ * is usually just advanced by a few keyframes.
+ */
+typedef struct {
+  const T3DModel *model;
+  T3DPose *poses;
+  T3DPoseCacheConf conf;
+  uint32_t frame;
+  uint32_t evalCount; // poses evaluated in the current frame
+  uint32_t hitCount; // requests served by an already evaluated pose in the current frame
+} T3DPoseCache;
+
+/**
+ * Creates a pose cache for a skinned model.
+ * Poses are allocated lazily on the first request that needs them.
+ * @param model model with a skeleton and animations
+ * @param conf settings, zeroed fields use their defaults
+ * @return pose cache
+ */
+T3DPoseCache t3d_pose_cache_create(const T3DModel *model, const T3DPoseCacheConf *conf);
+
+/**
+ * Starts a new frame, call this once per frame before any 't3d_pose_cache_get'.
+ * Poses requested in the last frame stay valid for drawing, their matrices are buffered.
+ * @param cache pose cache
+ */
+void t3d_pose_cache_begin_frame(T3DPoseCache *cache);
+
+/**
+ * Returns the bone matrices of an animation at the given time.
+ * If another instance already requested the same animation and (quantized) time in this frame, no work is done.
+ * For a per-instance phase offset, simply add it to 'time'.
+ * The animation is always looped, 'time' may be larger than its duration.
+ * If all poses are already in use this frame, the closest one is returned instead.
+ *
+ * @param cache pose cache
+ * @param anim animation definition, see 't3d_model_get_animation'
+ * @param time time in seconds
+ * @return fixed-point bone matrices, valid until the same pose is re-evaluated 'bufferCount' frames later
+ */
+const T3DMat4FP* t3d_pose_cache_get(T3DPoseCache *cache, const T3DChunkAnim *anim, float time);
+
+/**
+ * Points the skeleton segment to a shared pose.
+ * This allows to re-use a block recorded with 't3d_model_draw_custom' and 'matrices'
+ * set to 't3d_segment_placeholder(T3D_SEGMENT_SKELETON)' for any instance.
+ * @param matrices bone matrices returned by 't3d_pose_cache_get'
+ */
+static inline void t3d_pose_cache_use(const T3DMat4FP *matrices) {
+  t3d_segment_set(T3D_SEGMENT_SKELETON, (void*)matrices);
+}
+
+/**
+ * Frees all poses and data allocated by the cache.
+ * Note: make sure that nothing is drawn with any of its poses anymore.
+ * @param cache pose cache
+ */
+void t3d_pose_cache_destroy(T3DPoseCache *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //TINY3D_T3DPOSECACHE_H
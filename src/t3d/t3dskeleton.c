@@ -4,6 +4,9 @@
 */
 #include "t3dskeleton.h"
 
+DEFINE_RSP_UCODE(rsp_tinyskel);
+uint32_t T3D_SKEL_RSP_ID = 0;
+
 T3DSkeleton t3d_skeleton_create_buffered(const T3DModel *model, int bufferCount) {
   const T3DChunkSkeleton *skelRef = t3d_model_get_skeleton(model);
   assert(skelRef != NULL);
@@ -25,6 +28,7 @@ T3DSkeleton t3d_skeleton_clone(const T3DSkeleton *skel, bool useMatrices) {
     .bones = malloc(sizeof(T3DBone) * skel->skeletonRef->boneCount),
     .boneMatricesFP = NULL,
     .skeletonRef = skel->skeletonRef,
+    .bonesSRT = NULL,
   };
   memcpy(result.bones, skel->bones, sizeof(T3DBone) * skel->skeletonRef->boneCount);
 
@@ -43,6 +47,7 @@ void t3d_skeleton_reset(T3DSkeleton *skeleton) {
       sizeof(T3DVec3) + sizeof(T3DQuat) + sizeof(T3DVec3) // copy all 3 vectors (SRT) at once
     );
     skeleton->bones[i].hasChanged = true;
+    skeleton->bones[i].pendingBuffers = 0;
   }
 }
 
@@ -58,6 +63,88 @@ void t3d_skeleton_blend(const T3DSkeleton *skelRes, const T3DSkeleton *skelA, co
   }
 }
 
+static inline float blend_input_weight(const T3DBlendInput *input, uint32_t boneIdx) {
+  if(!input->boneMask)return input->weight;
+  return input->weight * (float)input->boneMask[boneIdx] * (1.0f / 255.0f);
+}
+
+void t3d_skeleton_blend_tree(T3DSkeleton *skelRes, const T3DBlendInput *inputs, uint32_t inputCount) {
+  const uint32_t srtSize = sizeof(T3DVec3) + sizeof(T3DQuat) + sizeof(T3DVec3);
+
+  for(uint32_t i = 0; i < skelRes->skeletonRef->boneCount; i++) {
+    T3DBone *boneRes = &skelRes->bones[i];
+    const T3DChunkBone *boneDef = &skelRes->skeletonRef->bones[i];
+
+    // start from the rest pose, the result of the last call must not leak into this one
+    T3DBone res;
+    memcpy(res.scale.v, boneDef->scale.v, srtSize);
+
+    // regular inputs, weighted average
+    const T3DBone *firstBone = NULL;
+    uint32_t usedCount = 0;
+    float totalWeight = 0.0f;
+    T3DVec3 scale = {{0, 0, 0}};
+    T3DQuat rot = {{0, 0, 0, 0}};
+    T3DVec3 pos = {{0, 0, 0}};
+
+    for(uint32_t n = 0; n < inputCount; n++) {
+      if(inputs[n].isAdditive)continue;
+      float weight = blend_input_weight(&inputs[n], i);
+      if(weight == 0.0f)continue;
+
+      const T3DBone *bone = &inputs[n].skel->bones[i];
+      if(!firstBone)firstBone = bone;
+      ++usedCount;
+      totalWeight += weight;
+
+      // keep all rotations in the same hemisphere, otherwise they would cancel out
+      float weightRot = t3d_quat_dot(&firstBone->rotation, &bone->rotation) < 0.0f ? -weight : weight;
+      for(int a = 0; a < 3; a++) {
+        scale.v[a] += bone->scale.v[a] * weight;
+        pos.v[a] += bone->position.v[a] * weight;
+      }
+      for(int a = 0; a < 4; a++)rot.v[a] += bone->rotation.v[a] * weightRot;
+    }
+
+    if(usedCount == 1) {
+      memcpy(res.scale.v, firstBone->scale.v, srtSize); // a single input needs no math
+    } else if(usedCount > 1 && totalWeight != 0.0f) {
+      t3d_vec3_scale(&res.scale, &scale, 1.0f / totalWeight);
+      t3d_vec3_scale(&res.position, &pos, 1.0f / totalWeight);
+      res.rotation = rot;
+      t3d_quat_normalize(&res.rotation);
+    }
+
+    // additive inputs, applied on top as their difference to the rest pose
+    for(uint32_t n = 0; n < inputCount; n++) {
+      if(!inputs[n].isAdditive)continue;
+      float weight = blend_input_weight(&inputs[n], i);
+      if(weight == 0.0f)continue;
+
+      const T3DBone *bone = &inputs[n].skel->bones[i];
+      for(int a = 0; a < 3; a++) {
+        res.scale.v[a] += (bone->scale.v[a] - boneDef->scale.v[a]) * weight;
+        res.position.v[a] += (bone->position.v[a] - boneDef->position.v[a]) * weight;
+      }
+
+      T3DQuat restInv = {{-boneDef->rotation.v[0], -boneDef->rotation.v[1], -boneDef->rotation.v[2], boneDef->rotation.v[3]}};
+      T3DQuat srcRot = bone->rotation;
+      T3DQuat delta, deltaWeighted, rotOld = res.rotation;
+      T3DQuat identity;
+      t3d_quat_identity(&identity);
+      t3d_quat_mul(&delta, &restInv, &srcRot);
+      t3d_quat_nlerp(&deltaWeighted, &identity, &delta, weight);
+      t3d_quat_mul(&res.rotation, &rotOld, &deltaWeighted);
+    }
+
+    // only mark bones that changed, everything else can skip the matrix update
+    if(memcmp(res.scale.v, boneRes->scale.v, srtSize) != 0) {
+      memcpy(boneRes->scale.v, res.scale.v, srtSize);
+      boneRes->hasChanged = true;
+    }
+  }
+}
+
 void t3d_skeleton_update(T3DSkeleton *skeleton)
 {
   int updateLevel = -1;
@@ -86,17 +173,94 @@ void t3d_skeleton_update(T3DSkeleton *skeleton)
       if(boneDef->parentIdx != 0xFFFF) {
         T3DMat4 tmp;
         t3d_mat4_from_srt(&tmp, bone->scale.v, bone->rotation.v, bone->position.v);
-        t3d_mat4_mul(&bone->matrix, &skeleton->bones[boneDef->parentIdx].matrix, &tmp);
+        t3d_mat4_mul_3x4(&bone->matrix, &skeleton->bones[boneDef->parentIdx].matrix, &tmp);
       } else {
         t3d_mat4_from_srt(&bone->matrix, bone->scale.v, bone->rotation.v, bone->position.v);
       }
 
-      t3d_mat4_to_fixed(&matStackFP[i], &bone->matrix);
-      skeleton->bones[i].hasChanged = false;
+      bone->hasChanged = false;
+      bone->pendingBuffers = skeleton->bufferCount;
+    }
+
+    // the other buffers still hold the matrix from before the change, so keep writing it until all are up to date
+    if(bone->pendingBuffers) {
+      // bone matrices are always affine, so the last column can be skipped
+      t3d_mat4_to_fixed_3x4(&matStackFP[i], &bone->matrix);
+      --bone->pendingBuffers;
     }
   }
 }
 
+void t3d_skeleton_rsp_init() {
+  T3D_SKEL_RSP_ID = rspq_overlay_register(&rsp_tinyskel);
+}
+
+void t3d_skeleton_rsp_destroy() {
+  rspq_overlay_unregister(T3D_SKEL_RSP_ID);
+  T3D_SKEL_RSP_ID = 0;
+}
+
+static inline void split_fixed(float val, int16_t *valInt, uint16_t *valFrac) {
+  int32_t fixed = T3D_F32_TO_FIXED(val);
+  *valInt = (int16_t)(fixed >> 16);
+  *valFrac = (uint16_t)fixed;
+}
+
+static inline int16_t quat_to_s15(float val) {
+  int32_t res = (int32_t)(val * 32768.0f + (val < 0.0f ? -0.5f : 0.5f));
+  if(res > 0x7FFF)return 0x7FFF;
+  if(res < -0x7FFF)return -0x7FFF; // the ucode negates it, keep it in range
+  return (int16_t)res;
+}
+
+static void pack_bone_srt(T3DBoneSRTFP *res, const T3DBone *bone, uint16_t parentIdx) {
+  T3DBoneSRTFP srt; // build it in cached memory, 'res' is uncached
+  split_fixed(bone->scale.v[0], &srt.scaleIntXZ[0], &srt.scaleFracXZ[0]);
+  split_fixed(bone->scale.v[2], &srt.scaleIntXZ[1], &srt.scaleFracXZ[1]);
+  split_fixed(bone->scale.v[1], &srt.scaleIntY, &srt.scaleFracY);
+  srt.parentIdx = parentIdx;
+  srt.padding = 0;
+  for(int i = 0; i < 4; i++)srt.rotation[i] = quat_to_s15(bone->rotation.v[i]);
+  for(int i = 0; i < 3; i++)split_fixed(bone->position.v[i], &srt.positionInt[i], &srt.positionFrac[i]);
+  srt.positionInt[3] = 1;
+  srt.positionFrac[3] = 0;
+  *res = srt;
+}
+
+void t3d_skeleton_update_rsp(T3DSkeleton *skeleton)
+{
+  uint32_t boneCount = skeleton->skeletonRef->boneCount;
+  if(skeleton->bonesSRT == NULL) {
+    // one copy per matrix buffer, commands of earlier frames may not have run yet
+    skeleton->bonesSRT = malloc_uncached(sizeof(T3DBoneSRTFP) * boneCount * skeleton->bufferCount);
+    for(uint32_t i = 0; i < boneCount; i++)skeleton->bones[i].hasChanged = true;
+  }
+
+  skeleton->currentBufferIdx = (skeleton->currentBufferIdx + 1) % skeleton->bufferCount;
+  T3DBoneSRTFP *bonesSRT = &skeleton->bonesSRT[boneCount * skeleton->currentBufferIdx];
+
+  // the ucode recalculates all bones, only changed ones need to be uploaded
+  for(uint32_t i = 0; i < boneCount; i++) {
+    T3DBone *bone = &skeleton->bones[i];
+    if(bone->hasChanged) {
+      bone->hasChanged = false;
+      bone->pendingBuffers = skeleton->bufferCount;
+    }
+
+    // the other copies still hold the bone from before the change, keep writing it until all are up to date
+    if(bone->pendingBuffers) {
+      pack_bone_srt(&bonesSRT[i], bone, skeleton->skeletonRef->bones[i].parentIdx);
+      --bone->pendingBuffers;
+    }
+  }
+
+  rspq_write(T3D_SKEL_RSP_ID, T3D_SKEL_CMD_UPDATE,
+    PhysicalAddr(bonesSRT),
+    PhysicalAddr(&skeleton->boneMatricesFP[boneCount * skeleton->currentBufferIdx]),
+    boneCount
+  );
+}
+
 int t3d_skeleton_find_bone(T3DSkeleton *skeleton, const char *name) {
   for(int i = 0; i < skeleton->skeletonRef->boneCount; i++) {
     if(strcmp(skeleton->skeletonRef->bones[i].name, name) == 0) {
@@ -115,6 +279,10 @@ void t3d_skeleton_destroy(T3DSkeleton *skeleton) {
     free_uncached(skeleton->boneMatricesFP);
     skeleton->boneMatricesFP = NULL;
   }
+  if(skeleton->bonesSRT != NULL) {
+    free_uncached(skeleton->bonesSRT);
+    skeleton->bonesSRT = NULL;
+  }
   skeleton->skeletonRef = NULL;
 }
 
@@ -23,8 +23,28 @@ typedef struct {
   T3DQuat rotation;
   T3DVec3 position;
   int32_t hasChanged;
+  uint8_t pendingBuffers; // buffers that still hold an older matrix (or packed SRT) of this bone
 } T3DBone;
 
+/**
+ * Fixed-point SRT of a bone, input of the skeleton ucode (see 't3d_skeleton_update_rsp').
+ * Scale and position are 16.16 split into integer and fraction, the rotation is s1.15.
+ * The layout must match 'rsp/rsp_tinyskel.S'.
+ */
+typedef struct {
+  int16_t scaleIntXZ[2];
+  uint16_t scaleFracXZ[2];
+  int16_t scaleIntY;
+  uint16_t parentIdx; // 0xFFFF for the root
+  uint16_t scaleFracY;
+  uint16_t padding;
+  int16_t rotation[4];
+  int16_t positionInt[4]; // W is always 1
+  uint16_t positionFrac[4];
+} T3DBoneSRTFP;
+
+_Static_assert(sizeof(T3DBoneSRTFP) == 40, "T3DBoneSRTFP must match the ucode");
+
 /**
  * Skeleton instance, can be constructed from a model's skeleton definition.
  * This is used to draw skinned models.
@@ -35,8 +55,16 @@ typedef struct {
   uint8_t bufferCount; // number of matrices buffers
   uint8_t currentBufferIdx;
   const T3DChunkSkeleton* skeletonRef; // reference to the model, defines skeleton structure
+  T3DBoneSRTFP* bonesSRT; // packed bones for the RSP (one copy per buffer), only allocated by 't3d_skeleton_update_rsp'
 } T3DSkeleton;
 
+extern uint32_t T3D_SKEL_RSP_ID;
+
+// RSP commands, must match with the commands defined in `rsp/rsp_tinyskel.S`
+enum T3DSkelCmd {
+  T3D_SKEL_CMD_UPDATE = 0x0,
+};
+
 /**
  * Creates a skeleton instance from a model's skeleton definition.
  * It will internally reserve multiple matrix stacks to allow for buffering.
@@ -97,14 +125,69 @@ void t3d_skeleton_reset(T3DSkeleton *skeleton);
  */
 void t3d_skeleton_blend(const T3DSkeleton *skelRes, const T3DSkeleton *skelA, const T3DSkeleton *skelB, float factor);
 
+/**
+ * Input of 't3d_skeleton_blend_tree'.
+ * Only the bones of 'skel' are read, so skeletons cloned without matrices are enough.
+ */
+typedef struct {
+  const T3DSkeleton *skel; // pose to blend in
+  float weight;
+  const uint8_t *boneMask; // optional weight per bone (0-255), NULL to use all bones
+  bool isAdditive; // if true, the difference to the rest pose is added on top of the other inputs
+} T3DBlendInput;
+
+/**
+ * Blends any number of poses into a skeleton in a single pass, without intermediate skeletons.
+ * Regular inputs are averaged by their (masked) weights, additive inputs are then applied on top in order.
+ * E.g. idle/walk/run as regular inputs, plus an upper-body attack masked to the spine and arms.
+ *
+ * Bones without any regular input start from the rest pose, so additive layers never stack up over frames.
+ * Only bones whose result actually changed are marked for 't3d_skeleton_update'.
+ *
+ * Note: it is safe to use the resulting skeleton as an input too.
+ *
+ * @param skelRes resulting skeleton
+ * @param inputs inputs to blend
+ * @param inputCount number of inputs
+ */
+void t3d_skeleton_blend_tree(T3DSkeleton *skelRes, const T3DBlendInput *inputs, uint32_t inputCount);
+
 /**
  * Updates the skeleton's bone matrices if data has changed.
  * Call this after making changes to the bones individual properties (pos/rot/scale).
- * To make this work, the `hasChanged` flag in the bone must also be set
+ * To make this work, the `hasChanged` flag in the bone must also be set.
+ * For buffered skeletons, a changed bone is also written into the following buffers,
+ * so no buffer is left with an outdated matrix.
  * @param skeleton The skeleton to update
  */
 void t3d_skeleton_update(T3DSkeleton *skeleton);
 
+/**
+ * Registers the skeleton ucode, needed by 't3d_skeleton_update_rsp'.
+ * Call this once after 't3d_init'.
+ */
+void t3d_skeleton_rsp_init();
+
+/**
+ * Unregisters the skeleton ucode again.
+ */
+void t3d_skeleton_rsp_destroy();
+
+/**
+ * Same as 't3d_skeleton_update', but computes the matrices on the RSP.
+ * Only bones with 'hasChanged' set are converted and uploaded, the RSP then recalculates all
+ * bones of the skeleton into the next buffer.
+ * 't3d_skeleton_update' is the reference, the RSP uses s1.15 rotations and is less precise:
+ * expect errors of about 1/10000 per level of the hierarchy.
+ *
+ * Note: 'matrix' of the bones is not updated, so don't mix this with 't3d_skeleton_update' on the same skeleton.
+ * Each matrix buffer has its own copy of the packed bones, which is only written again when the buffer is reused.
+ * Like the matrices, a copy must not be overwritten before the RSP ran the command reading it,
+ * so use as many buffers as frames can be in flight.
+ * @param skeleton The skeleton to update
+ */
+void t3d_skeleton_update_rsp(T3DSkeleton *skeleton);
+
 /**
  * Frees data allocated in the skeleton struct.
  * Note: it's safe to call this multiple times, pointers are set to NULL.
@@ -73,6 +73,8 @@ int main(int argc, char* argv[])
     printf("Usage: %s <gltf-file> <t3dm-file> [--bvh] [--base-scale=64] [--ignore-materials] [--ignore-transforms] [--asset-path=assets] [--verbose]\n", argv[0]);
     printf("Params:\n");
     printf("  --bvh: Create a BVH for the model, this is used for culling and visibility checks\n");
+    printf("         Objects named 'CELL_<name>' (boxes) and 'PORTAL_<cellA>-<cellB>' (quads) are not drawn,\n");
+    printf("         if present, they are written as portal/cell data for 't3d_model_portal_query' instead\n");
     printf("  --base-scale=<scale>: Scale applied to blender units before conversion to integers, default is 64\n");
     printf("  --ignore-materials: Ignore F3D materials and write dummy data, useful for custom material systems\n");
     printf("  --ignore-transforms: Ignore all object transforms, can be used to force objects to be at (0,0,0)\n");
@@ -146,6 +148,7 @@ int main(int argc, char* argv[])
   uint32_t chunkIndex = 0;
   uint32_t chunkCount = 2; // vertices + indices
   if(config.createBVH)chunkCount += 1;
+  if(!t3dm.cells.empty())chunkCount += 1;
   chunkCount += usedMaterials.size();
   std::vector<ModelChunked> modelChunks{};
   modelChunks.reserve(t3dm.models.size());
@@ -234,6 +237,7 @@ int main(int argc, char* argv[])
   BinaryFile chunkVerts{};
   BinaryFile chunkIndices{};
   BinaryFile chunkBVH{};
+  BinaryFile chunkPortals{};
   std::vector<std::shared_ptr<BinaryFile>> chunkMaterials{};
   std::vector<BinaryFile> chunkSkeletons{};
 
@@ -263,6 +267,11 @@ int main(int argc, char* argv[])
     chunkBVH.writeArray(bvhData.data(), bvhData.size());
   }
 
+  if(!t3dm.cells.empty()) {
+    auto portalData = createPortalData(t3dm, modelChunks);
+    chunkPortals.writeArray(portalData.data(), portalData.size());
+  }
+
   // write used materials
   for(auto &material_ : usedMaterials) {
     auto &material = *material_;
@@ -485,6 +494,12 @@ int main(int argc, char* argv[])
     file.writeMemFile(chunkBVH);
   }
 
+  if(!t3dm.cells.empty()) {
+    file.align(8);
+    addToChunkTable('P');
+    file.writeMemFile(chunkPortals);
+  }
+
   file.align(16);
   addChunkTypeIndex();
   addToChunkTable('V');
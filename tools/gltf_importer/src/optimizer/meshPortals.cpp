@@ -0,0 +1,112 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#include "optimizer.h"
+
+#include <stdexcept>
+
+namespace {
+  constexpr int MAX_PORTAL_POINTS = 4;
+
+  bool aabbOverlaps(const s16 *minA, const s16 *maxA, const s16 *minB, const s16 *maxB) {
+    for(int a=0; a<3; ++a) {
+      if(maxA[a] < minB[a] || minA[a] > maxB[a])return false;
+    }
+    return true;
+  }
+}
+
+/**
+ * Layout (all 16-bit):
+ *   cellCount, portalCount, globalObjIdx, globalObjCount
+ *   cells[cellCount]: aabbMin[3], aabbMax[3], portalIdx, portalCount, objIdx, objCount
+ *   portals[portalCount]: targetCell, pointCount, points[4][3]
+ *   objects[]: object indices, referenced by the cells and the global range
+ *
+ * Each portal is stored once per side, so a cell owns a continuous range of portals leading out of it.
+ * Objects are assigned to every cell their AABB touches, objects outside all cells go into the global range.
+ */
+std::vector<int16_t> createPortalData(const T3DMData &t3dm, const std::vector<ModelChunked> &modelChunks)
+{
+  auto findCell = [&](const std::string &name) {
+    for(size_t c=0; c<t3dm.cells.size(); ++c) {
+      if(t3dm.cells[c].name == name)return (int16_t)c;
+    }
+    throw std::runtime_error("Portal references unknown cell: '" + name + "'");
+  };
+
+  std::vector<std::vector<const Portal*>> cellPortals(t3dm.cells.size());
+  std::vector<std::vector<int16_t>> cellTargets(t3dm.cells.size());
+  for(auto &portal : t3dm.portals) {
+    auto cellA = findCell(portal.cellA);
+    auto cellB = findCell(portal.cellB);
+    cellPortals[cellA].push_back(&portal);
+    cellTargets[cellA].push_back(cellB);
+    cellPortals[cellB].push_back(&portal);
+    cellTargets[cellB].push_back(cellA);
+  }
+
+  std::vector<std::vector<int16_t>> cellObjects(t3dm.cells.size());
+  std::vector<int16_t> globalObjects{};
+  for(size_t o=0; o<modelChunks.size(); ++o) {
+    auto &chunks = modelChunks[o];
+    bool inAnyCell = false;
+    for(size_t c=0; c<t3dm.cells.size(); ++c) {
+      auto &cell = t3dm.cells[c];
+      if(aabbOverlaps(chunks.aabbMin, chunks.aabbMax, cell.aabbMin, cell.aabbMax)) {
+        cellObjects[c].push_back((int16_t)o);
+        inAnyCell = true;
+      }
+    }
+    if(!inAnyCell)globalObjects.push_back((int16_t)o);
+  }
+
+  std::vector<int16_t> objects{};
+  std::vector<int16_t> data{};
+  data.push_back((int16_t)t3dm.cells.size());
+  data.push_back((int16_t)(t3dm.portals.size() * 2));
+  data.push_back((int16_t)objects.size());
+  data.push_back((int16_t)globalObjects.size());
+  objects.insert(objects.end(), globalObjects.begin(), globalObjects.end());
+
+  int16_t portalIdx = 0;
+  for(size_t c=0; c<t3dm.cells.size(); ++c) {
+    auto &cell = t3dm.cells[c];
+    data.insert(data.end(), cell.aabbMin, cell.aabbMin + 3);
+    data.insert(data.end(), cell.aabbMax, cell.aabbMax + 3);
+    data.push_back(portalIdx);
+    data.push_back((int16_t)cellPortals[c].size());
+    data.push_back((int16_t)objects.size());
+    data.push_back((int16_t)cellObjects[c].size());
+
+    portalIdx += cellPortals[c].size();
+    objects.insert(objects.end(), cellObjects[c].begin(), cellObjects[c].end());
+
+    if(config.verbose) {
+      printf("[Cell] %s: %d portals, %d objects\n", cell.name.c_str(),
+        (int)cellPortals[c].size(), (int)cellObjects[c].size());
+    }
+  }
+
+  for(size_t c=0; c<t3dm.cells.size(); ++c) {
+    for(size_t p=0; p<cellPortals[c].size(); ++p) {
+      auto &points = cellPortals[c][p]->points;
+      data.push_back(cellTargets[c][p]);
+      data.push_back((int16_t)points.size());
+      for(int i=0; i<MAX_PORTAL_POINTS; ++i) {
+        auto pos = points[i < points.size() ? i : 0].round();
+        data.push_back((int16_t)pos.x());
+        data.push_back((int16_t)pos.y());
+        data.push_back((int16_t)pos.z());
+      }
+    }
+  }
+
+  if(config.verbose) {
+    printf("[Cell] Global objects: %d\n", (int)globalObjects.size());
+  }
+
+  data.insert(data.end(), objects.begin(), objects.end());
+  return data;
+}
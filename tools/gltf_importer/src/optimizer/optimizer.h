@@ -7,4 +7,5 @@
 #include "../structs.h"
 
 void optimizeModelChunk(ModelChunked &model);
-std::vector<int16_t> createMeshBVH(const std::vector<ModelChunked> &modelChunks);
\ No newline at end of file
+std::vector<int16_t> createMeshBVH(const std::vector<ModelChunked> &modelChunks);
+std::vector<int16_t> createPortalData(const T3DMData &t3dm, const std::vector<ModelChunked> &modelChunks);
@@ -136,6 +136,9 @@ T3DMData parseGLTF(const char *gltfPath, float modelScale)
     auto mesh = node->mesh;
     if(!mesh)continue;
 
+    // visibility markers (cells & portals), these are not rendered
+    if(parseCellNode(node, modelScale, t3dm))continue;
+
     // printf(" - Mesh %d: %s\n", i, mesh->name);
 
     bool hasMat = false;
@@ -0,0 +1,133 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+
+#include "parser.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+  constexpr float POINT_MERGE_DIST = 0.01f;
+  constexpr int MAX_PORTAL_POINTS = 4;
+
+  // Blender appends '.001' etc. to duplicated names, which would break the cell lookup
+  std::string stripNameSuffix(const std::string &name) {
+    auto dotPos = name.rfind('.');
+    if(dotPos == std::string::npos || dotPos + 1 == name.size())return name;
+    for(auto i = dotPos + 1; i < name.size(); ++i) {
+      if(!isdigit(name[i]))return name;
+    }
+    return name.substr(0, dotPos);
+  }
+
+  // World-space positions of all primitives, scaled like regular vertices
+  std::vector<Vec3> readNodePoints(const cgltf_node *node, float modelScale) {
+    Mat4 mat = config.ignoreTransforms ? Mat4{} : parseNodeMatrix(node, true);
+    std::vector<Vec3> points{};
+
+    for(int j = 0; j < node->mesh->primitives_count; j++) {
+      auto prim = &node->mesh->primitives[j];
+      for(int k = 0; k < prim->attributes_count; k++) {
+        auto attr = &prim->attributes[k];
+        if(attr->type != cgltf_attribute_type_position)continue;
+
+        for(int l = 0; l < attr->data->count; l++) {
+          Vec3 pos{};
+          cgltf_accessor_read_float(attr->data, l, pos.data, 3);
+          pos = mat * pos * modelScale;
+
+          // meshes with split normals/UVs contain the same corner multiple times
+          bool isDuplicate = std::any_of(points.begin(), points.end(), [&](const Vec3 &p) {
+            return (p - pos).length() < POINT_MERGE_DIST;
+          });
+          if(!isDuplicate)points.push_back(pos);
+        }
+      }
+    }
+    return points;
+  }
+
+  // Sorts points of a planar, convex polygon by their angle around the center
+  void sortPolygonPoints(std::vector<Vec3> &points, const std::string &name) {
+    Vec3 center{};
+    for(auto &p : points)center += p;
+    center /= (float)points.size();
+
+    Vec3 normal = (points[1] - points[0]).cross(points[2] - points[0]);
+    if(normal.length() < 0.0001f) {
+      throw std::runtime_error("Portal '" + name + "' is degenerate (collinear points)");
+    }
+    normal = normal.normalize();
+
+    Vec3 axisX = (points[0] - center).normalize();
+    Vec3 axisY = normal.cross(axisX);
+    std::sort(points.begin(), points.end(), [&](const Vec3 &a, const Vec3 &b) {
+      return atan2f((a - center).dot(axisY), (a - center).dot(axisX))
+           < atan2f((b - center).dot(axisY), (b - center).dot(axisX));
+    });
+  }
+}
+
+bool parseCellNode(const cgltf_node *node, float modelScale, T3DMData &t3dm)
+{
+  if(!node->name || !node->mesh)return false;
+  std::string name = stripNameSuffix(node->name);
+
+  if(name.starts_with("CELL_")) {
+    auto points = readNodePoints(node, modelScale);
+    if(points.empty()) {
+      throw std::runtime_error("Cell '" + name + "' has no vertices");
+    }
+
+    auto &cell = t3dm.cells.emplace_back();
+    cell.name = name.substr(5);
+
+    Vec3 aabbMin{INFINITY}, aabbMax{-INFINITY};
+    for(auto &p : points) {
+      for(int a=0; a<3; ++a) {
+        aabbMin[a] = std::min(aabbMin[a], p[a]);
+        aabbMax[a] = std::max(aabbMax[a], p[a]);
+      }
+    }
+    for(int a=0; a<3; ++a) {
+      cell.aabbMin[a] = (int16_t)floorf(aabbMin[a]);
+      cell.aabbMax[a] = (int16_t)ceilf(aabbMax[a]);
+    }
+
+    if(config.verbose) {
+      printf("[Cell] %s: (%d %d %d) - (%d %d %d)\n", cell.name.c_str(),
+        cell.aabbMin[0], cell.aabbMin[1], cell.aabbMin[2],
+        cell.aabbMax[0], cell.aabbMax[1], cell.aabbMax[2]
+      );
+    }
+    return true;
+  }
+
+  if(name.starts_with("PORTAL_")) {
+    auto cellNames = name.substr(7);
+    auto sepPos = cellNames.find('-');
+    if(sepPos == std::string::npos) {
+      throw std::runtime_error("Portal '" + name + "' must be named 'PORTAL_<cellA>-<cellB>'");
+    }
+
+    auto &portal = t3dm.portals.emplace_back();
+    portal.cellA = cellNames.substr(0, sepPos);
+    portal.cellB = cellNames.substr(sepPos + 1);
+    portal.points = readNodePoints(node, modelScale);
+
+    if(portal.points.size() < 3 || portal.points.size() > MAX_PORTAL_POINTS) {
+      throw std::runtime_error("Portal '" + name + "' must be a triangle or quad, found "
+        + std::to_string(portal.points.size()) + " points");
+    }
+    sortPolygonPoints(portal.points, name);
+
+    if(config.verbose) {
+      printf("[Portal] %s <-> %s: %d points\n", portal.cellA.c_str(), portal.cellB.c_str(), (int)portal.points.size());
+    }
+    return true;
+  }
+
+  return false;
+}
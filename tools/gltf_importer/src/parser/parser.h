@@ -18,5 +18,6 @@ namespace fs = std::filesystem;
 
 void parseMaterial(const fs::path &gltfBasePath, int i, int j, Model &model, cgltf_primitive *prim);
 Mat4 parseNodeMatrix(const cgltf_node *node, bool recursive);
+bool parseCellNode(const cgltf_node *node, float modelScale, T3DMData &t3dm);
 Bone parseBoneTree(const cgltf_node *rootBone, Bone *parentBone, int &count);
 Anim parseAnimation(const cgltf_animation &anim, const std::unordered_map<std::string, const Bone*> &nodeMap, uint32_t sampleRate);
\ No newline at end of file
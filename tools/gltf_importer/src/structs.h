@@ -242,10 +242,26 @@ struct Anim {
   std::vector<AnimChannelMapping> channelMap{};
 };
 
+// Convex volume of a level, marked by a box mesh named 'CELL_<name>'
+struct Cell {
+  std::string name{};
+  s16 aabbMin[3]{};
+  s16 aabbMax[3]{};
+};
+
+// Opening between two cells, marked by a planar quad/triangle named 'PORTAL_<cellA>-<cellB>'
+struct Portal {
+  std::string cellA{};
+  std::string cellB{};
+  std::vector<Vec3> points{}; // convex, ordered around the center
+};
+
 struct T3DMData {
   std::vector<Model> models{};
   std::vector<Bone> skeletons{};
   std::vector<Anim> animations{};
+  std::vector<Cell> cells{};
+  std::vector<Portal> portals{};
 };
 
 struct Config {